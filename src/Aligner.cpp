@@ -28,15 +28,20 @@
  * being processed by other threads as well.
  */
 template<class V>
-Aligner<V>::Aligner(IdentityCalculator<V> &c, Block *a, string dlmIn,
-		bool filter, double cutoff, bool canRelax) :
+Aligner<V>::Aligner(IdentityCalculator<V> &c, Block *a, OutputWriter *out,
+		string dlmIn, bool filter, double cutoff, bool canRelax,
+		PairWriter::Format format, int topK, int threadNumIn) :
 		identity(c) {
 	blockA = a;
 	dlm = dlmIn;
 	threshold = cutoff;
+	threadNum = threadNumIn;
 
 	canReportAll = filter;
-	ssPtr = new stringstream();
+	writer = new PairWriter(out, format, dlm, 4);
+	if (topK > 0) {
+		hits = new TopHits(topK, blockA->size());
+	}
 
 	if (canRelax) {
 		error = identity.getError();
@@ -47,7 +52,8 @@ Aligner<V>::Aligner(IdentityCalculator<V> &c, Block *a, string dlmIn,
 
 template<class V>
 Aligner<V>::~Aligner() {
-	delete ssPtr;
+	delete writer;
+	delete hits;
 
 	if (buffer.size() > 0) {
 		std::cerr << "Aligner error: Queue must be empty. " << std::endl;
@@ -56,7 +62,7 @@ Aligner<V>::~Aligner() {
 }
 
 template<class V>
-pair<bool, stringstream*> Aligner<V>::start() {
+void Aligner<V>::start() {
 	// Keep processing blocks as they are enqueued.
 	while (true) {
 		if (buffer.size() > 0) {
@@ -66,13 +72,7 @@ pair<bool, stringstream*> Aligner<V>::start() {
 		}
 	}
 
-	return std::make_pair(canWrite, ssPtr);
-}
-
-template<class V>
-pair<bool, stringstream*> Aligner<V>::getResults() {
-	// Keep processing blocks as they are enqueued.
-	return std::make_pair(canWrite, ssPtr);
+	writer->flush();
 }
 
 /**
@@ -97,45 +97,59 @@ void Aligner<V>::processBlock() {
 	int sizeA = blockA->size();
 	int sizeB = blockB->size();
 
-	static KmerHistogram<uint64_t, V> kTable(k);
 	static KmerHistogram<uint64_t, uint64_t> monoTable(1);
 
+	// Pairs are scored one after another; large ones by all threads
+	int pairThreadNum = ThreadTuner::findInnerThreadNum(1,
+			identity.getKHistSize(), ThreadTuner::SPLIT_BIN_NUM, threadNum);
+
 	for (int j = 0; j < sizeA; j++) {
 		int init = 0;
 		// If the two blocks have the same contents.
 		if (buffer.front().second) {
 			init = j + 1;
 		}
-		auto p1 = blockA->at(j);
+		auto &p1 = blockA->at(j);
 
 		string *info1 = p1.first;
 		string *seq1 = p1.second;
 
-		V *h1 = kTable.build(seq1);
-		uint64_t *mono1 = monoTable.build(seq1);
+		int seqThreadNum = ThreadTuner::findInnerThreadNum(1, seq1->size(),
+				ThreadTuner::SPLIT_LENGTH, threadNum);
+		V *h1 = identity.buildKHist(seq1, p1.segmentList, seqThreadNum);
+		uint64_t *mono1 = monoTable.build(seq1, p1.segmentList, seqThreadNum);
 
 		double l1 = seq1->size();
 		int sizeB = blockB->size();
 
 		for (int hani = init; hani < sizeB; hani++) {
-			auto p2 = blockB->at(hani);
+			auto &p2 = blockB->at(hani);
 			string *seq2 = p2.second;
 			int l2 = seq2->size();
 
+			// A hit must beat the K-th best hit found so far
+			double bound = hits != nullptr ? hits->getBound(j) : 0.0;
+
 			double ratio = l1 < l2 ? l1 / l2 : l2 / l1;
-			if (!canReportAll && ratio < threshold) {
+			if ((!canReportAll && ratio < threshold) || ratio < bound) {
 				continue;
 			}
 
-			V *h2 = kTable.build(seq2);
-			uint64_t *mono2 = monoTable.build(seq2);
+			seqThreadNum = ThreadTuner::findInnerThreadNum(1, l2,
+					ThreadTuner::SPLIT_LENGTH, threadNum);
+			V *h2 = identity.buildKHist(seq2, p2.segmentList, seqThreadNum);
+			uint64_t *mono2 = monoTable.build(seq2, p2.segmentList,
+					seqThreadNum);
 
-			double res = identity.score(h1, h2, mono1, mono2, ratio, l1, l2);
+			double res = identity.score(h1, h2, mono1, mono2, ratio, l1, l2,
+					bound, pairThreadNum);
 
 			if (canReportAll || res > 0.0) {
-				canWrite = true;
-				(*ssPtr) << *info1 << dlm << *p2.first << dlm
-						<< std::setprecision(4) << res << std::endl;
+				if (hits != nullptr) {
+					hits->add(j, res, p2.id, *p2.first);
+				} else {
+					writer->write(*info1, p1.id, *p2.first, p2.id, res);
+				}
 			}
 
 			delete[] h2;
@@ -151,6 +165,11 @@ void Aligner<V>::processBlock() {
 	buffer.pop();
 }
 
+template<class V>
+TopHits* Aligner<V>::getHits() {
+	return hits;
+}
+
 template<class V>
 int Aligner<V>::getQueueSize() {
 	return buffer.size();
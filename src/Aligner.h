@@ -24,13 +24,15 @@
 #define ALIGNER_H_
 
 #include <iostream>
-#include <sstream>
 #include <vector>
 #include "Util.h"
 #include "FastaReader.h"
 #include "KmerHistogram.h"
 #include "LockFreeQueue.h"
 #include "IdentityCalculator.h"
+#include "PairWriter.h"
+#include "OutputWriter.h"
+#include "TopHits.h"
 
 template<class V>
 class Aligner {
@@ -46,10 +48,13 @@ private:
 	double threshold;
 	// Used for relaxing the final filter as threshold - error
 	double error = 0.0;
-	// Collect all results here
-	stringstream *ssPtr;
-	// If true write out the content of ssPtr
-	bool canWrite = false;
+	// Results are buffered here and handed over to the shared output writer
+	PairWriter *writer;
+	// If only the best hits of each sequence of block A are reported
+	TopHits *hits = nullptr;
+	// Threads building the histograms of a large sequence or scoring a
+	// pair of large histograms
+	int threadNum;
 
 	int k;
 
@@ -61,14 +66,19 @@ private:
 //			KmerHistogram<uint64_t, V> &kTable,
 //			KmerHistogram<uint64_t, uint64_t> &monoTable, int init);
 public:
-	Aligner(IdentityCalculator<V>&, Block*, string, bool, double, bool);
+	Aligner(IdentityCalculator<V>&, Block*, OutputWriter*, string, bool,
+			double, bool, PairWriter::Format format = PairWriter::TEXT,
+			int topK = 0, int threadNum = 1);
 	virtual ~Aligner();
 	void enqueueBlock(pair<Block*, bool>);
-	pair<bool, stringstream*> start();
+	void start();
 	void stop();
 	int getQueueSize();
 	void processBlock();
-	pair<bool, stringstream*> getResults();
+	/**
+	 * The best hits if topK is positive, otherwise nullptr
+	 */
+	TopHits* getHits();
 };
 
 #include "Aligner.cpp"
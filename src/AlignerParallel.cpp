@@ -23,7 +23,8 @@
 
 template<class V>
 AlignerParallel<V>::AlignerParallel(Serializer &serializer, double t, bool f,
-		std::string d, int tNum, std::string oFile) {
+		std::string d, int tNum, std::string oFile, bool canPrefilter,
+		bool canCascade) {
 	k = serializer.getK();
 	histSize = serializer.getHistSize();
 	threshold = t;
@@ -41,19 +42,11 @@ AlignerParallel<V>::AlignerParallel(Serializer &serializer, double t, bool f,
 	dlm = d;
 	threadNum = tNum;
 
-	out = std::ofstream(oFile.c_str(), std::ios::out);
-	kTable = new KmerHistogram<uint64_t, V>(k);
+	out = new OutputWriter(oFile, std::max(1, threadNum / 4));
+	isBinary = false;
+	makeWriterList(std::max(threadNum, omp_get_max_threads()));
+	kTable = new KmerHistogram<uint64_t, V>(k, histSize);
 	monoTable = new KmerHistogram<uint64_t, uint64_t>(1);
-	keyList = Util::makeKeyList(histSize, k);
-
-//	keyList = new uint8_t[histSize * k];
-//	int alphaSize = Parameters::getAlphabetSize();
-//	for (int c = k - 1; c >= 0; c--) {
-//		for (int r = 0; r < histSize; r++) {
-//			keyList[(r * k) + k - 1 - c] = (r / ((uint64_t) pow(alphaSize, c)))
-//					% alphaSize;
-//		}
-//	}
 
 	auto featList = serializer.getFeatList();
 
@@ -68,6 +61,22 @@ AlignerParallel<V>::AlignerParallel(Serializer &serializer, double t, bool f,
 
 	// This predictor removes the bias from the feature list
 	predictor = GLMPredictor(*featList, false);
+
+	// A prefilter trained at a lower threshold is still safe to use
+	auto preList = serializer.getPrefilterList();
+	if (canPrefilter && !canReportAll && preList != nullptr
+			&& relaxThreshold >= serializer.getPrefilterThreshold()) {
+		prefilter = new Prefilter(*preList,
+				serializer.getPrefilterThreshold(),
+				serializer.getPrefilterCutoff());
+	}
+	auto coarseList = serializer.getCoarseList();
+	if (canCascade && !canReportAll && coarseList != nullptr
+			&& relaxThreshold >= serializer.getCoarseThreshold()) {
+		coarse = new CoarseScorer(*coarseList, serializer.getCoarseK(),
+				histSize, serializer.getFoldNum(),
+				serializer.getCoarseThreshold(), serializer.getCoarseCutoff());
+	}
 	isInitialized = false;
 }
 
@@ -75,7 +84,8 @@ template<class V>
 AlignerParallel<V>::AlignerParallel(int kmer, int hSize, double t,
 		double e, // @suppress("Class members should be properly initialized")
 		bool f, double *compList, ITransformer *transformer, std::string d,
-		int tNum, int64_t maxLength, std::string oFile, std::string mFile) {
+		int tNum, int64_t maxLength, std::string oFile, std::string mFile,
+		Prefilter *p, CoarseScorer *c) {
 	k = kmer;
 	histSize = hSize;
 	threshold = t;
@@ -83,6 +93,8 @@ AlignerParallel<V>::AlignerParallel(int kmer, int hSize, double t,
 	relaxThreshold = t - e;
 	modelFile = mFile;
 	canReportAll = f;
+	prefilter = p;
+	coarse = c;
 
 	dlm = d;
 	threadNum = tNum;
@@ -93,19 +105,19 @@ AlignerParallel<V>::AlignerParallel(int kmer, int hSize, double t,
 		compositionList[i] = compList[i];
 	}
 
-	out = std::ofstream(oFile.c_str(), std::ios::out);
+	out = new OutputWriter(oFile, std::max(1, threadNum / 4));
+	isBinary = false;
+	makeWriterList(std::max(threadNum, omp_get_max_threads()));
 
-	kTable = new KmerHistogram<uint64_t, V>(k);
+	kTable = new KmerHistogram<uint64_t, V>(k, histSize);
 	monoTable = new KmerHistogram<uint64_t, uint64_t>(1);
 
-	keyList = Util::makeKeyList(histSize, k);
-
 	auto featList = transformer->getFeatureList();
 
 	// Save model if desired
 	if (!modelFile.empty()) {
 		Serializer serializer(&featList, compositionList, k, histSize, e,
-				maxLength, modelFile);
+				maxLength, modelFile, prefilter, coarse);
 	}
 
 	featNum = featList.size() - 1; // The bias has not been removed yet.
@@ -131,15 +143,20 @@ AlignerParallel<V>::AlignerParallel(int kmer, int hSize, double t,
 
 template<class V>
 AlignerParallel<V>::~AlignerParallel() {
-	out.close();
+	for (auto w : writerList) {
+		delete w;
+	}
+	out->close();
+	delete out;
 	if (isInitialized) {
-		clearAMemory(kHistList, monoHistList, infoList, lenList, sizeA);
+		clearAMemory(kHistList, monoHistList, infoList, lenList, idList, sizeA);
 	}
 
 	delete[] compositionList;
 	delete kTable;
 	delete monoTable;
-	delete[] keyList;
+	delete prefilter;
+	delete coarse;
 }
 
 /**
@@ -147,7 +164,7 @@ AlignerParallel<V>::~AlignerParallel() {
  */
 template<class V>
 void AlignerParallel<V>::clearAMemory(V **kHistList, uint64_t **monoHistList,
-		std::string **infoList, int *lenList, int size) {
+		std::string **infoList, int *lenList, uint32_t *idList, int size) {
 #pragma omp parallel for schedule(static) num_threads(threadNum)
 	for (int i = 0; i < size; i++) {
 		delete[] kHistList[i];
@@ -158,6 +175,7 @@ void AlignerParallel<V>::clearAMemory(V **kHistList, uint64_t **monoHistList,
 	delete[] monoHistList;
 	delete[] infoList;
 	delete[] lenList;
+	delete[] idList;
 }
 
 /**
@@ -167,25 +185,27 @@ void AlignerParallel<V>::clearAMemory(V **kHistList, uint64_t **monoHistList,
 template<class V>
 void AlignerParallel<V>::setBlockA(Block *block, bool isAllVsAll) {
 	if (isInitialized) {
-		clearAMemory(kHistList, monoHistList, infoList, lenList, sizeA);
+		clearAMemory(kHistList, monoHistList, infoList, lenList, idList, sizeA);
 	} else {
 		isInitialized = true;
 	}
 
 	sizeA = block->size();
+	isSameFile = isAllVsAll;
 	auto tup = unpackBlock(block);
 	kHistList = std::get < 0 > (tup);
 	monoHistList = std::get < 1 > (tup);
 	infoList = std::get < 2 > (tup);
 	lenList = std::get < 3 > (tup);
+	idList = std::get < 4 > (tup);
 
 	if (isAllVsAll) {
-		std::future<void> printTask;
 		for (int i = 0; i < sizeA; i++) {
-			auto printList = makeEmptyResult(threadNum,
-					((sizeA - i - 1) / threadNum) + 1);
-
-#pragma omp parallel for schedule(static) num_threads(threadNum)
+			// A few pairs of large histograms are scored one after another,
+			// each by all threads
+			int pairThreadNum = ThreadTuner::findInnerThreadNum(sizeA - i - 1,
+					histSize, ThreadTuner::SPLIT_BIN_NUM, threadNum);
+#pragma omp parallel for schedule(static) num_threads(threadNum / pairThreadNum)
 			for (int j = i + 1; j < sizeA; j++) {
 
 				if (!canReportAll) {
@@ -199,44 +219,42 @@ void AlignerParallel<V>::setBlockA(Block *block, bool isAllVsAll) {
 						continue;
 					}
 				}
+				if (isFarBelow(kHistList[i], kHistList[j], monoHistList[i],
+						monoHistList[j])) {
+					continue;
+				}
 
 				Statistician < V
 						> s(histSize, k, kHistList[i], kHistList[j],
 								monoHistList[i], monoHistList[j],
-								compositionList, keyList);
+								compositionList, pairThreadNum);
+				if (isRejected(s)) {
+					continue;
+				}
+				// Stop once the score cannot reach the threshold
 				double data[featNum];
-				s.calculate(funIndexArray, singleFeatNum, data);
+				if (!predictor.calculateBounded(s, funIndexArray,
+						canReportAll ? 0.0 : relaxThreshold, data)) {
+					continue;
+				}
 				double res = predictor.calculateIdentity(data);
 
 				if (canReportAll || res >= relaxThreshold) {
-					printList->at(omp_get_thread_num())->push_back(
-							std::make_pair(infoList[j], res));
-				}
-			}
-
-			// Wait for the previous print task to finish
-			if (printTask.valid()) {
-				printTask.get();
-				threadNum++;
-			}
-
-			// Do not run a writing task if there is nothing to be written
-			for (auto ptr : *printList) {
-				if (ptr->size() > 0) {
-					threadNum--;
-					printTask = std::async([this, printList, i]() {
-						output(printList, infoList[i]);
-					});
-					break;
+					if (res > 1.0) {
+						res = 1.0;
+					} else if (res < 0.0) {
+						res = 0.0;
+					}
+					if (matrix != nullptr) {
+						matrix->set(idList[i], idList[j], res);
+					} else {
+						writerList[omp_get_thread_num()]->write(*infoList[i],
+								idList[i], *infoList[j], idList[j], res);
+					}
 				}
 			}
 		}
-
-		// Wait for the last print case
-		if (printTask.valid()) {
-			printTask.get();
-			threadNum++;
-		}
+		flush();
 	}
 }
 
@@ -246,65 +264,84 @@ void AlignerParallel<V>::setBlockA(Block *block, bool isAllVsAll) {
  * stored in the block.
  */
 template<class V>
-std::tuple<V**, uint64_t**, std::string**, int*> AlignerParallel<V>::unpackBlock(
+std::tuple<V**, uint64_t**, std::string**, int*, uint32_t*> AlignerParallel<V>::unpackBlock(
 		Block *block) {
 	int size = block->size();
 	V **kHistList = new V*[size];
 	uint64_t **monoHistList = new uint64_t*[size];
 	std::string **infoList = new std::string*[size];
 	int *lenList = new int[size];
+	uint32_t *idList = new uint32_t[size];
 
-#pragma omp parallel for schedule(static) num_threads(threadNum)
+	// A few long sequences are counted one after another, each by all
+	// threads
+	int64_t longest = 0;
+	for (int i = 0; i < size; i++) {
+		longest = std::max<int64_t>(longest, block->at(i).second->length());
+	}
+	int seqThreadNum = ThreadTuner::findInnerThreadNum(size, longest,
+			ThreadTuner::SPLIT_LENGTH, threadNum);
+
+#pragma omp parallel for schedule(static) num_threads(threadNum / seqThreadNum)
 	for (int i = 0; i < size; i++) {
-		auto p = block->at(i);
+		auto &p = block->at(i);
 		infoList[i] = p.first;
 		std::string *seq = p.second;
-		kHistList[i] = kTable->build(seq);
-		monoHistList[i] = monoTable->build(seq);
+		kHistList[i] =
+				coarse == nullptr ?
+						kTable->build(seq, p.segmentList, seqThreadNum) :
+						coarse->build(*kTable, seq, p.segmentList,
+								seqThreadNum);
+		monoHistList[i] = monoTable->build(seq, p.segmentList, seqThreadNum);
 		lenList[i] = seq->length();
+		idList[i] = p.id;
 		delete seq;
 	}
 	delete block;
 
-	return std::make_tuple(kHistList, monoHistList, infoList, lenList);
+	return std::make_tuple(kHistList, monoHistList, infoList, lenList, idList);
 }
 
+/**
+ * One writer per thread; a thread number is used as an index
+ */
 template<class V>
-Result* AlignerParallel<V>::makeEmptyResult(int outerSize, int innerSize) {
-	auto *printList = new Result();
-	printList->reserve(outerSize);
-	for (int e = 0; e < outerSize; e++) {
-		auto v = new std::vector<pair<std::string*, double> >();
-		v->reserve(innerSize);
-		printList->push_back(v);
+void AlignerParallel<V>::makeWriterList(int size) {
+	while ((int) writerList.size() < size) {
+		if (shards != nullptr) {
+			writerList.push_back(
+					new PairWriter(shards->getShard(writerList.size()),
+							PairWriter::SHARD, dlm, 8));
+		} else {
+			writerList.push_back(
+					new PairWriter(out,
+							isBinary ? PairWriter::BINARY : PairWriter::TEXT,
+							dlm, 8));
+		}
 	}
-	return printList;
 }
 
 /**
- * Print some results to a file
- * Memory: This method frees the memory used by the print list.
+ * After the output format has changed
  */
 template<class V>
-void AlignerParallel<V>::output(
-		std::vector<std::vector<pair<std::string*, double> >*> *printList,
-		string *info1) {
-	for (auto v : *printList) {
-		for (auto p : *v) {
-			double res = p.second;
-
-			if (res > 1.0) {
-				res = 1.0;
-			} else if (res < 0.0) {
-				res = 0.0;
-			}
+void AlignerParallel<V>::remakeWriterList() {
+	int size = writerList.size();
+	for (auto w : writerList) {
+		delete w;
+	}
+	writerList.clear();
+	makeWriterList(size);
+}
 
-			out << *info1 << dlm << *p.first << dlm << std::setprecision(8)
-					<< res << std::endl;
-		}
-		delete v;
+/**
+ * Hand the partial buffers of all threads over to the output writer
+ */
+template<class V>
+void AlignerParallel<V>::flush() {
+	for (auto w : writerList) {
+		w->flush();
 	}
-	delete printList;
 }
 
 /**
@@ -318,12 +355,14 @@ void AlignerParallel<V>::processBlockB(Block *block) {
 	auto monoHistListB = std::get < 1 > (tup);
 	auto infoListB = std::get < 2 > (tup);
 	auto lenListB = std::get < 3 > (tup);
+	auto idListB = std::get < 4 > (tup);
 
-	std::future<void> printTask;
+	// A few pairs of large histograms are scored one after another, each by
+	// all threads
+	int pairThreadNum = ThreadTuner::findInnerThreadNum(sizeB, histSize,
+			ThreadTuner::SPLIT_BIN_NUM, threadNum);
 	for (int i = 0; i < sizeA; i++) {
-		auto printList = makeEmptyResult(threadNum, (sizeB / threadNum) + 1);
-
-#pragma omp parallel for schedule(static) num_threads(threadNum)
+#pragma omp parallel for schedule(static) num_threads(threadNum / pairThreadNum)
 		for (int h = 0; h < sizeB; h++) {
 
 			if (!canReportAll) {
@@ -338,45 +377,83 @@ void AlignerParallel<V>::processBlockB(Block *block) {
 				}
 			}
 
+			V *kHist1 = kHistList[i];
+			V *kHist2 = kHistListB[h];
+			uint64_t *monoHist1 = monoHistList[i];
+			uint64_t *monoHist2 = monoHistListB[h];
+			std::string *info1 = infoList[i];
+			std::string *info2 = infoListB[h];
+			uint32_t id1 = idList[i];
+			uint32_t id2 = idListB[h];
+			if (isSameFile && id2 < id1) {
+				std::swap(kHist1, kHist2);
+				std::swap(monoHist1, monoHist2);
+				std::swap(info1, info2);
+				std::swap(id1, id2);
+			}
+
+			if (isFarBelow(kHist1, kHist2, monoHist1, monoHist2)) {
+				continue;
+			}
+
 			Statistician < V
-					> s(histSize, k, kHistList[i], kHistListB[h],
-							monoHistList[i], monoHistListB[h], compositionList,
-							keyList);
+					> s(histSize, k, kHist1, kHist2, monoHist1, monoHist2,
+							compositionList, pairThreadNum);
+			if (isRejected(s)) {
+				continue;
+			}
+			// Stop once the score cannot reach the threshold
 			double data[featNum];
-			s.calculate(funIndexArray, singleFeatNum, data);
+			if (!predictor.calculateBounded(s, funIndexArray,
+					canReportAll ? 0.0 : relaxThreshold, data)) {
+				continue;
+			}
 			double res = predictor.calculateIdentity(data);
 
 			if (canReportAll || res >= relaxThreshold) {
-				printList->at(omp_get_thread_num())->push_back(
-						std::make_pair(infoListB[h], res));
+				if (res > 1.0) {
+					res = 1.0;
+				} else if (res < 0.0) {
+					res = 0.0;
+				}
+				if (matrix != nullptr) {
+					matrix->set(id1, id2, res);
+				} else {
+					writerList[omp_get_thread_num()]->write(*info1, id1,
+							*info2, id2, res);
+				}
 			}
 		}
+	}
+	flush();
 
-		// Wait for the previous print task to finish
-		if (printTask.valid()) {
-			printTask.get();
-			threadNum++;
-		}
+	clearAMemory(kHistListB, monoHistListB, infoListB, lenListB, idListB,
+			sizeB);
+}
 
-		// Do not run a writing task if there is nothing to be written
-		for (auto ptr : *printList) {
-			if (ptr->size() > 0) {
-				threadNum--;
-				printTask = std::async([this, printList, i]() {
-					output(printList, infoList[i]);
-				});
-				break;
-			}
-		}
-	}
+template<class V>
+void AlignerParallel<V>::setBinaryOutput(std::string firstFile,
+		std::string secondFile) {
+	PairWriter::writeTables(out, firstFile, secondFile, threadNum);
+	isBinary = true;
+	remakeWriterList();
+}
 
-// Wait for the last print case
-	if (printTask.valid()) {
-		printTask.get();
-		threadNum++;
-	}
+template<class V>
+void AlignerParallel<V>::setMatrixOutput(ScoreMatrix *m) {
+	matrix = m;
+}
+
+template<class V>
+void AlignerParallel<V>::setShardedOutput(OutputShards *s) {
+	shards = s;
+	remakeWriterList();
+}
 
-	clearAMemory(kHistListB, monoHistListB, infoListB, lenListB, sizeB);
+template<class V>
+void AlignerParallel<V>::closeOutput() {
+	flush();
+	out->close();
 }
 
 template<class V>
@@ -387,4 +464,10 @@ int AlignerParallel<V>::getThreadNum() const {
 template<class V>
 void AlignerParallel<V>::setThreadNum(int threadNum) {
 	this->threadNum = threadNum;
+	makeWriterList(threadNum);
+}
+
+template<class V>
+int AlignerParallel<V>::getSizeA() const {
+	return sizeA;
 }
@@ -30,8 +30,6 @@
 #include <iostream>
 #include <vector>
 #include <omp.h> // To get thread identifier
-#include <future>
-#include <atomic>
 #include <tuple>
 
 #include "KmerHistogram.h"
@@ -40,10 +38,15 @@
 #include "ITransformer.h"
 #include "GLMPredictor.h"
 #include "Serializer.h"
+#include "Prefilter.h"
+#include "CoarseScorer.h"
+#include "ThreadTuner.h"
 #include "Util.h"
-
-typedef std::vector<std::pair<std::string*, std::string*> > Block;
-typedef std::vector<std::vector<pair<std::string*, double> >*> Result;
+#include "FastaReader.h"
+#include "PairWriter.h"
+#include "OutputWriter.h"
+#include "ScoreMatrix.h"
+#include "OutputShards.h"
 
 template<class V>
 class AlignerParallel {
@@ -53,7 +56,12 @@ private:
 	uint64_t **monoHistList;
 	std::string **infoList;
 	int *lenList;
+	uint32_t *idList;
 	int sizeA = 0;
+	// Blocks B come from the file of block A (all vs. all). A pair is then
+	// scored in the order of its records, whatever the order of the blocks,
+	// as some statistics are not symmetric.
+	bool isSameFile = false;
 
 	// Number of threads to used for processing two blocks
 	int threadNum;
@@ -71,40 +79,105 @@ private:
 	double *compositionList;
 	int k;
 	int histSize;
-	uint8_t *keyList;
 
 	std::vector<int> funIndexList;
 	int *funIndexArray;
 	GLMPredictor predictor;
+	// Rejects most dissimilar pairs by the cheap statistics; may be nullptr
+	Prefilter *prefilter = nullptr;
+	// Scores the folded histograms first; may be nullptr. If it is set, a
+	// k-mer histogram is followed by its folded one.
+	CoarseScorer *coarse = nullptr;
 
 	std::string dlm;
 
 	bool isInitialized;
 
-	std::ofstream out;
+	// Each thread writes its pairs to its own buffer
+	OutputWriter *out;
+	std::vector<PairWriter*> writerList;
+	bool isBinary;
+	// If set, each thread writes to its own shard instead
+	OutputShards *shards = nullptr;
+	// If set, scores are stored here instead of being written as pairs
+	ScoreMatrix *matrix = nullptr;
 
 	std::string modelFile;
 
-	void clearAMemory(V**, uint64_t**, std::string**, int*, int);
-	void output(std::vector<std::vector<pair<std::string*, double> >*>*,
-			std::string*);
-
-	Result* makeEmptyResult(int, int);
+	void clearAMemory(V**, uint64_t**, std::string**, int*, uint32_t*, int);
+	void makeWriterList(int);
+	void remakeWriterList();
+	void flush();
+
+	/**
+	 * True if the coarse stage shows the pair is not similar
+	 */
+	inline bool isFarBelow(V *kHist1, V *kHist2, uint64_t *monoHist1,
+			uint64_t *monoHist2) {
+		return !canReportAll && coarse != nullptr
+				&& coarse->isRejected(kHist1 + histSize, kHist2 + histSize,
+						monoHist1, monoHist2, compositionList);
+	}
+
+	/**
+	 * True if the prefilter rejects the pair
+	 */
+	inline bool isRejected(Statistician<V> &s) {
+		if (canReportAll || prefilter == nullptr) {
+			return false;
+		}
+		double data[prefilter->getFeatNum()];
+		s.calculate(prefilter->getFunIndexArray(),
+				prefilter->getSingleFeatNum(), data);
+		return prefilter->isRejected(data);
+	}
 
 public:
+	/**
+	 * The aligner takes over the prefilter and the coarse scorer
+	 */
 	AlignerParallel(int, int, double, double, bool, double*, ITransformer*,
-			std::string, int, int64_t, std::string, std::string modelFile = "");
+			std::string, int, int64_t, std::string, std::string modelFile = "",
+			Prefilter *prefilter = nullptr, CoarseScorer *coarse = nullptr);
 
+	/**
+	 * A saved prefilter is used only if canPrefilter is true, and a saved
+	 * coarse model only if canCascade is true
+	 */
 	AlignerParallel(Serializer &serializer, double, bool, std::string, int,
-			std::string);
+			std::string, bool canPrefilter = false, bool canCascade = false);
 
 	virtual ~AlignerParallel();
 	int getThreadNum() const;
 	void setThreadNum(int threadNum);
-	std::tuple<V**, uint64_t**, std::string**, int*> unpackBlock(Block*);
+	int getSizeA() const;
+	std::tuple<V**, uint64_t**, std::string**, int*, uint32_t*> unpackBlock(
+			Block*);
 	void setBlockA(Block*, bool);
 	void processBlockB(Block*);
 	bool isDone();
+
+	/**
+	 * Write the pairs in the binary format. The first file provides the
+	 * sequences of block A; the second one provides those of block B.
+	 */
+	void setBinaryOutput(std::string, std::string);
+
+	/**
+	 * Store the scores in a matrix indexed by the sequence ids (all vs. all)
+	 */
+	void setMatrixOutput(ScoreMatrix*);
+
+	/**
+	 * Write the pairs of each thread to its own shard. The shards are
+	 * flushed and released if nullptr is passed.
+	 */
+	void setShardedOutput(OutputShards*);
+
+	/**
+	 * Write the remaining pairs and close the output file
+	 */
+	void closeOutput();
 };
 
 #include "AlignerParallel.cpp"
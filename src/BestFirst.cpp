@@ -21,17 +21,24 @@
  *
  */
 
+#include "BestFirst.h"
+
+#include <cmath>
+#include <algorithm>
+
+// A pivot smaller than this fraction of its diagonal means the subset is
+// (nearly) linearly dependent; as in Matrix::solveCholesky
+static const double SINGULAR = 1e-10;
+
 /**
  * isHigher: true for classification (accuracy) and false for regression (mse or mae)
  */
-template<class T>
-BestFirst<T>::BestFirst(const Matrix &f, const Matrix &l,
-		std::vector<Feature*> &h, MakeTransformer f1, Evaluate f2,
-		IsNewBetter f3, bool isHigher, int threadNum, int minFeatIn,
-		double lowest, int k) {
-	fList = copy(h);
+BestFirst::BestFirst(ExpandedTable &f, const Matrix &l, Output f1,
+		Evaluate f2, IsNewBetter f3, bool isHigher, int threadNum,
+		int minFeatIn, double lowest, int k) {
+	fList = f.getFeatureList();
 	fNum = f.getNumCol();
-	makeTransformer = f1;
+	output = f1;
 	evaluate = f2;
 	isNewBetter = f3;
 	limit = lowest;
@@ -39,10 +46,18 @@ BestFirst<T>::BestFirst(const Matrix &f, const Matrix &l,
 
 	isHigherBetter = isHigher;
 
+	// The normal equations of all features. Index 0 is the column of ones;
+	// feature c is at c + 1.
+	int rowNum = f.getNumRow();
+	Matrix gram;
+	std::vector<double> labelList;
+	f.normalEquations(l, gram, labelList);
+
 	Node empty;
 	best = empty;
 	maximum = lowest; // This is ok for the current evaluation measures
-	open[empty] = lowest;
+	open = decltype(open)(IsWorse { isHigherBetter });
+	addToOpen(empty, lowest);
 
 	/**
 	 * The search algorithm
@@ -54,12 +69,10 @@ BestFirst<T>::BestFirst(const Matrix &f, const Matrix &l,
 	/**/
 	while ((best.getSize() < minFeat || eCount < k) && best.getSize() <= maxFeat
 			&& !open.empty()) {
-		// Step 2
+		// Step 2 and 3: The node is removed from the open list; it stays
+		// in the seen set, i.e. it is closed
 		std::pair<Node, double> v = findOptimum();
 
-		// Step 3
-		open.erase(v.first);
-		closed[v.first] = v.second;
 		// Step 4
 		if (isNewBetter(v.second, maximum)
 				|| (best.getSize() < minFeat && eCount >= k)) {
@@ -69,38 +82,105 @@ BestFirst<T>::BestFirst(const Matrix &f, const Matrix &l,
 
 			// Print new features
 			std::cout << "Better performance of: " << maximum << std::endl;
-			const int *list = best.getList();
-			int s = best.getSize();
-			for (int a = 0; a < s; a++) {
-				std::cout << "\t" << fList.at(list[a])->getName() << std::endl;
+			for (int a : best.getList()) {
+				std::cout << "\t" << fList.at(a)->getName() << std::endl;
 			}
 		}
 		// Step 5
 		std::vector < Node > eList = v.first.expand(fNum);
 		eCount++;
 
+		// Factorize the parent once; children adding a feature extend it
+		const Node &parent = v.first;
+		int parentSize = parent.getSize();
+		std::vector<int> parentOrder(1, 0);
+		for (int a : parent.getList()) {
+			parentOrder.push_back(a + 1);
+		}
+		std::vector<double> parentLower;
+		bool hasParentLower = factorize(gram, parentOrder, parentLower);
+		f.cache(parent.getList());
+
 		// Step 6
 		int childNum = eList.size();
 		// double resultList[childNum] { 0.0 };
 		std::vector<double> resultList(childNum, 0.0);
 #pragma omp parallel for schedule(static) num_threads(threadNum)
 		for (int i = 0; i < childNum; i++) {
-			Node child = eList[i];
+			const Node &child = eList[i];
 
-			if (open.find(child) == open.end()
-					&& closed.find(child) == closed.end()) {
-				Matrix t =
-						f.subMatrixByCol(child.getList(), child.getSize()).appendOnesColumn();
+			if (!seen.contains(child)) {
+				std::vector<int> childList = child.getList();
+				const int *list = childList.data();
+				int childSize = child.getSize();
 				try {
-					T predictor = makeTransformer(t, l);
-					double e = evaluate(l, predictor.transform(t));
+					// The order of the child's system
+					std::vector<int> order;
+					std::vector<double> lower;
+					bool isSolved;
+					if (childSize == parentSize + 1 && hasParentLower) {
+						order = parentOrder;
+						int a = 0;
+						while (parent.has(list[a])) {
+							a++;
+						}
+						order.push_back(list[a] + 1);
+						isSolved = border(gram, order, parentLower, lower);
+					} else {
+						order.push_back(0);
+						for (int a = 0; a < childSize; a++) {
+							order.push_back(list[a] + 1);
+						}
+						isSolved = factorize(gram, order, lower);
+					}
+
+					int p = order.size();
+					std::vector<double> weightList(p);
+					if (isSolved) {
+						for (int a = 0; a < p; a++) {
+							weightList[a] = labelList[order[a]];
+						}
+						solve(lower, p, weightList);
+					} else {
+						// The features are (nearly) dependent; fit by QR
+						Matrix t = f.subMatrixByCol(list, childSize).appendOnesColumn();
+						Matrix w = t.solveLeastSquares(l);
+						weightList[0] = w(0, 0);
+						for (int a = 1; a < p; a++) {
+							int c = order[a] - 1;
+							weightList[a] = w(std::lower_bound(list,
+									list + childSize, c) - list + 1, 0);
+						}
+					}
+
+					// Predict the labels column by column
+					std::vector<double> yList(rowNum, weightList[0]);
+					for (int a = 1; a < p; a++) {
+						int c = order[a] - 1;
+						double w = weightList[a];
+						const double *column = f.getColumn(c);
+						if (column != nullptr) {
+#pragma omp simd
+							for (int r = 0; r < rowNum; r++) {
+								yList[r] += w * column[r];
+							}
+						} else {
+							for (int r = 0; r < rowNum; r++) {
+								yList[r] += w * f.at(r, c);
+							}
+						}
+					}
+					Matrix predicted(rowNum, 1);
+					for (int r = 0; r < rowNum; r++) {
+						predicted(r, 0) = output(yList[r]);
+					}
+					double e = evaluate(l, predicted);
 					resultList[i] = e;
 				} catch (const std::exception &e) {
 #pragma omp critical
 					{
 						std::cerr << "A feature set was ignored:" << std::endl;
-						const int *list = child.getList();
-						for (int a = 0; a < child.getSize(); a++) {
+						for (int a = 0; a < childSize; a++) {
 							std::cout << "\t" << list[a] << ": ";
 							std::cout << fList.at(list[a])->getName()
 									<< std::endl;
@@ -109,7 +189,8 @@ BestFirst<T>::BestFirst(const Matrix &f, const Matrix &l,
 						std::cerr
 								<< "The problematic matrix is written to exception.txt";
 						std::cerr << std::endl;
-						t.printToFile("exception.txt");
+						f.subMatrixByCol(list, childSize).appendOnesColumn().printToFile(
+								"exception.txt");
 
 						throw std::exception();
 					}
@@ -118,10 +199,8 @@ BestFirst<T>::BestFirst(const Matrix &f, const Matrix &l,
 		}
 
 		for (int i = 0; i < childNum; i++) {
-			Node child = eList[i];
-			if (open.find(child) == open.end()
-					&& closed.find(child) == closed.end()) {
-				open[child] = resultList[i];
+			if (!seen.contains(eList[i])) {
+				addToOpen(eList[i], resultList[i]);
 			}
 		}
 
@@ -129,22 +208,21 @@ BestFirst<T>::BestFirst(const Matrix &f, const Matrix &l,
 
 	std::cout << "Selected statistics:" << std::endl;
 	// Print new features
-	const int *list = best.getList();
-	int s = best.getSize();
-	for (int a = 0; a < s; a++) {
-		std::cout << "\t" << fList.at(list[a])->getName() << std::endl;
+	for (int a : best.getList()) {
+		std::cout << "\t" << fList.at(a)->getName() << std::endl;
 	}
 
 	// Empty open and closed
-	open.clear();
-	closed.clear();
+	open = decltype(open)(IsWorse { isHigherBetter });
+	nodeList.clear();
+	seen.clear();
+	f.clearCache();
 }
 
 /**
  * Constructor of optimized features
  */
-template<class T>
-BestFirst<T>::BestFirst(std::vector<Feature*> &h) {
+BestFirst::BestFirst(std::vector<Feature*> &h) {
 	fList = copy(h);
 
 	// Count selected features
@@ -156,58 +234,61 @@ BestFirst<T>::BestFirst(std::vector<Feature*> &h) {
 	}
 
 	// Construct best node
-	int *l = new int[s];
-	int i = 0;
+	std::vector<int> l;
+	l.reserve(s);
 	for (auto f : fList) {
 		if (f->getIsSelected()) {
-			l[i] = f->getTableIndex();
-			i++;
+			l.push_back(f->getTableIndex());
 		}
 	}
 
-	best = Node(l, s);
+	best = Node(l.data(), s);
 }
 
-template<class T>
-BestFirst<T>::~BestFirst() {
+BestFirst::~BestFirst() {
 	for (auto ptr : fList) {
 		delete ptr;
 	}
 	fList.clear();
 }
 
-template<class T>
-std::pair<Node, double> BestFirst<T>::findOptimum() {
+std::pair<Node, double> BestFirst::findOptimum() {
 	if (open.empty()) {
 		std::cerr << "BestFirst error: " << std::endl;
 		std::cerr << "Cannot find optimum on empty Open set." << std::endl;
 		throw std::exception();
 	}
 
-	auto it = open.begin();
-	Node k;
-	double v = limit;
-	while (it != open.end()) {
-		if ((isHigherBetter && it->second > v)
-				|| (!isHigherBetter && it->second < v)) {
-			k = it->first;
-			v = it->second;
-		}
-		it++;
+	OpenItem top = open.top();
+	open.pop();
+	// A node that is not better than the limit counts as the empty one
+	if ((isHigherBetter && top.value > limit)
+			|| (!isHigherBetter && top.value < limit)) {
+		return std::make_pair(nodeList[top.index], top.value);
 	}
-	return std::make_pair(k, v);
+	return std::make_pair(Node(), limit);
+}
+
+void BestFirst::addToOpen(const Node &n, double value) {
+	seen.insert(n);
+	nodeList.push_back(n);
+	open.push( { value, (int) nodeList.size() - 1 });
+}
+
+Matrix BestFirst::transform(const Matrix &m) {
+	std::vector<int> l = best.getList();
+	int s = best.getSize();
+	return m.subMatrixByCol(l.data(), s).appendOnesColumn();
 }
 
-template<class T>
-Matrix BestFirst<T>::transform(const Matrix &m) {
-	const int *l = best.getList();
+Matrix BestFirst::transform(const ExpandedTable &m) {
+	std::vector<int> l = best.getList();
 	int s = best.getSize();
-	return m.subMatrixByCol(l, s).appendOnesColumn();
+	return m.subMatrixByCol(l.data(), s).appendOnesColumn();
 }
 
-template<class T>
-std::vector<Feature*> BestFirst<T>::getFeatureList() {
-	const int *l = best.getList();
+std::vector<Feature*> BestFirst::getFeatureList() {
+	std::vector<int> l = best.getList();
 	int s = best.getSize();
 	std::vector<Feature*> temp = copy(fList);
 	// Mark selected (and automatically needed) features
@@ -228,7 +309,87 @@ std::vector<Feature*> BestFirst<T>::getFeatureList() {
 	return r;
 }
 
-template<class T>
-const Node& BestFirst<T>::getBest() const {
+const Node& BestFirst::getBest() const {
 	return best;
 }
+
+bool BestFirst::factorize(const Matrix &gram, const std::vector<int> &order,
+		std::vector<double> &lower) {
+	int p = order.size();
+	lower.assign(p * p, 0.0);
+	for (int j = 0; j < p; j++) {
+		double diagonal = gram(order[j], order[j]);
+		double d = diagonal;
+		for (int k = 0; k < j; k++) {
+			d -= lower[j * p + k] * lower[j * p + k];
+		}
+		if (!(d > SINGULAR * diagonal)) {
+			return false;
+		}
+		double pivot = std::sqrt(d);
+		lower[j * p + j] = pivot;
+		for (int i = j + 1; i < p; i++) {
+			double v = gram(order[i], order[j]);
+			for (int k = 0; k < j; k++) {
+				v -= lower[i * p + k] * lower[j * p + k];
+			}
+			lower[i * p + j] = v / pivot;
+		}
+	}
+	return true;
+}
+
+/**
+ * parentLower: the factor of all indexes of the order but the last one
+ */
+bool BestFirst::border(const Matrix &gram, const std::vector<int> &order,
+		const std::vector<double> &parentLower, std::vector<double> &lower) {
+	int p = order.size();
+	int q = p - 1;
+	int last = order[q];
+	lower.assign(p * p, 0.0);
+	for (int i = 0; i < q; i++) {
+		for (int k = 0; k <= i; k++) {
+			lower[i * p + k] = parentLower[i * q + k];
+		}
+	}
+
+	// The new row solves L z = the new column of the Gram matrix
+	double diagonal = gram(last, last);
+	double d = diagonal;
+	for (int i = 0; i < q; i++) {
+		double v = gram(last, order[i]);
+		for (int k = 0; k < i; k++) {
+			v -= lower[i * p + k] * lower[q * p + k];
+		}
+		v /= lower[i * p + i];
+		lower[q * p + i] = v;
+		d -= v * v;
+	}
+	if (!(d > SINGULAR * diagonal)) {
+		return false;
+	}
+	lower[q * p + q] = std::sqrt(d);
+	return true;
+}
+
+/**
+ * Solve L (the transpose of L) x = b in place
+ */
+void BestFirst::solve(const std::vector<double> &lower, int p,
+		std::vector<double> &x) {
+	for (int i = 0; i < p; i++) {
+		double v = x[i];
+		for (int k = 0; k < i; k++) {
+			v -= lower[i * p + k] * x[k];
+		}
+		x[i] = v / lower[i * p + i];
+	}
+	for (int i = p - 1; i >= 0; i--) {
+		double v = x[i];
+		for (int k = i + 1; k < p; k++) {
+			v -= lower[k * p + i] * x[k];
+		}
+		x[i] = v / lower[i * p + i];
+	}
+}
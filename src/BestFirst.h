@@ -18,34 +18,61 @@
  *
  *  Created on: Apr 28, 2020
  *      Author: Dr. Hani Zakaria Girgis
+ *
+ *  Feature subsets are evaluated by GLMs fitted from the normal equations.
+ *  The Gram matrix of all features (and of the column of ones) is computed
+ *  once; the system of a subset is made of its rows and columns. A child
+ *  that adds a feature to its parent extends the parent's Cholesky factor
+ *  by one row. The columns of an expanded node are cached in the table;
+ *  the column a child adds is computed while its labels are predicted.
  */
 
 #ifndef BESTFIRST_H_
 #define BESTFIRST_H_
 
-#include <unordered_map>
+#include <queue>
 #include <vector>
 
 #include "Node.h"
 #include "Matrix.h"
+#include "ExpandedTable.h"
 #include "ITransformer.h"
 #include "Feature.h"
 #include "Parameters.h"
 
-template<class T>
 class BestFirst: public ITransformer {
 
-	// A function for make a classifier or a regression model
-	typedef T (*MakeTransformer)(const Matrix&, const Matrix&);
+	// The output function of a GLM, e.g. a threshold for a classifier
+	typedef double (*Output)(double);
 	// A function to measure performance, e.g. accuracy or squared mean error
 	typedef double (*Evaluate)(const Matrix&, const Matrix&);
 	// A function to determine if performance is improving
 	// !! The order of these two parameters is very important
 	typedef bool (*IsNewBetter)(double newV, double oldV);
 
+	// An item of the open list: the value and the index of a node
+	struct OpenItem {
+		double value;
+		int index;
+	};
+
+	// Orders the open list; ties go to the node found first
+	struct IsWorse {
+		bool isHigherBetter;
+		bool operator()(const OpenItem &a, const OpenItem &b) const {
+			if (a.value != b.value) {
+				return isHigherBetter ? a.value < b.value : a.value > b.value;
+			}
+			return a.index > b.index;
+		}
+	};
+
 private:
-	std::unordered_map<Node, double, NodeHasher> open;
-	std::unordered_map<Node, double, NodeHasher> closed;
+	// The best node on the open list is on top
+	std::priority_queue<OpenItem, std::vector<OpenItem>, IsWorse> open;
+	// The nodes on the open list and closed ones
+	std::vector<Node> nodeList;
+	NodeSet seen;
 
 	Node best;
 
@@ -54,7 +81,7 @@ private:
 	std::vector<Feature*> fList;
 	double limit;
 
-	MakeTransformer makeTransformer;
+	Output output;
 	Evaluate evaluate;
 	IsNewBetter isNewBetter;
 
@@ -62,24 +89,38 @@ private:
 	int minFeat = 0;
 
 	/**
-	 * Return the best node in the open set depending on the
+	 * Remove the best node from the open list depending on the
 	 * evaluation measure used and whether it is a maximization
 	 * or a minimization process
 	 * It return the value associated by this node
 	 */
 	std::pair<Node, double> findOptimum();
+	void addToOpen(const Node&, double);
+
+	/**
+	 * Cholesky factor of the rows and columns of the Gram matrix in order
+	 */
+	static bool factorize(const Matrix&, const std::vector<int>&,
+			std::vector<double>&);
+	/**
+	 * Extend the factor of the first p indexes by the last one
+	 */
+	static bool border(const Matrix&, const std::vector<int>&,
+			const std::vector<double>&, std::vector<double>&);
+	static void solve(const std::vector<double>&, int, std::vector<double>&);
 
 public:
-	BestFirst(const Matrix&, const Matrix&, std::vector<Feature*>&,
-			MakeTransformer, Evaluate, IsNewBetter, bool, int, int, double lowest = 0.0,
-			int stop = 3);
+	BestFirst(ExpandedTable&, const Matrix&, Output, Evaluate, IsNewBetter,
+			bool, int, int, double lowest = 0.0, int stop = 3);
 	BestFirst(std::vector<Feature*> &h);
 	virtual ~BestFirst();
 	virtual Matrix transform(const Matrix&);
+	/**
+	 * The selected columns of the table and a column of ones
+	 */
+	Matrix transform(const ExpandedTable&);
 	virtual std::vector<Feature*> getFeatureList();
 	const Node& getBest() const;
 };
 
-#include "BestFirst.cpp"
-
 #endif /* BESTFIRST_H_ */
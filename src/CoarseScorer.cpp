@@ -0,0 +1,126 @@
+/*
+ Identity 2.0 calculates DNA sequence identity scores rapidly without alignment.
+
+ Copyright (C) 2020-2022 Hani Z. Girgis, PhD
+
+ Academic use: Affero General Public License version 1.
+
+ Any restrictions to use for-profit or non-academics: Alternative commercial license is needed.
+
+ This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+ Please contact Dr. Hani Z. Girgis (hzgirgis@buffalo.edu) if you need more information.
+ */
+
+
+/*
+ * CoarseScorer.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Hani Z. Girgis, PhD
+ */
+
+#include "CoarseScorer.h"
+
+#include <algorithm>
+#include <iostream>
+#include <cmath>
+
+#include "GLMRegressor.h"
+#include "CutoffTuner.h"
+
+CoarseScorer::CoarseScorer(std::vector<Feature*> &list, int kIn,
+		int fullSize, int foldIn, double t, double c) {
+	k = kIn;
+	foldNum = foldIn;
+	histSize = fullSize / std::pow(Parameters::getAlphabetSize(), foldNum);
+	threshold = t;
+	cutoff = c;
+	makePredictor(list);
+}
+
+CoarseScorer::~CoarseScorer() {
+	for (auto f : featList) {
+		delete f;
+	}
+	featList.clear();
+}
+
+void CoarseScorer::makePredictor(std::vector<Feature*> &list) {
+	featNum = list.size() - 1; // The bias has not been removed yet.
+	for (auto f : list) {
+		if (f->getNumOfComp() == 0 && f->getName().compare("constant") != 0) {
+			funIndexList.push_back(f->getFunIndex());
+		}
+	}
+	// This predictor removes the bias from the feature list
+	predictor = GLMPredictor(list, false);
+}
+
+int CoarseScorer::findFoldNum(int histSize) {
+	int keyLength = 0;
+	for (int s = histSize; s > 1; s /= Parameters::getAlphabetSize()) {
+		keyLength++;
+	}
+	return std::max(0, std::min(MAX_FOLD, keyLength - MIN_K));
+}
+
+CoarseScorer* CoarseScorer::train(const Matrix *f, const Matrix *l, int k,
+		int fullSize, int foldNum, double t, int threadNum,
+		const std::vector<int> &statList) {
+	int foldSize = fullSize;
+	for (int i = 0; i < foldNum; i++) {
+		foldSize /= Parameters::getAlphabetSize();
+	}
+	std::cout << "Training the coarse model on histograms of " << foldSize
+			<< " bins ..." << std::endl;
+
+	if (!CutoffTuner::hasBothClasses(l, t)) {
+		std::cout << "\tNot enough similar and dissimilar pairs. ";
+		std::cout << "The coarse model is not used." << std::endl;
+		return nullptr;
+	}
+
+	GLMRegressor regressor(f, l, 0.0, threadNum, CutoffTuner::MIN_FEAT,
+			statList);
+	regressor.start();
+
+	std::vector<Feature*> list = regressor.getFeatureList();
+	CoarseScorer *c = new CoarseScorer(list, k, fullSize, foldNum, t, 0.0);
+	for (auto feat : list) {
+		delete feat;
+	}
+	c->featList = regressor.getFeatureList();
+
+	// The margin is widened until almost all similar pairs pass
+	c->cutoff = CutoffTuner::tune(f, l, t, c->predictor, c->funIndexList,
+			c->featNum);
+	std::cout << "\tMargin: " << t - c->cutoff << std::endl;
+
+	return c;
+}
+
+bool CoarseScorer::canApply(double t) const {
+	return t >= threshold;
+}
+
+int CoarseScorer::getFoldNum() const {
+	return foldNum;
+}
+
+int CoarseScorer::getHistSize() const {
+	return histSize;
+}
+
+double CoarseScorer::getThreshold() const {
+	return threshold;
+}
+
+double CoarseScorer::getCutoff() const {
+	return cutoff;
+}
+
+std::vector<Feature*>* CoarseScorer::getFeatureList() {
+	return &featList;
+}
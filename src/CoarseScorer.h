@@ -0,0 +1,141 @@
+/*
+ Identity 2.0 calculates DNA sequence identity scores rapidly without alignment.
+
+ Copyright (C) 2020-2022 Hani Z. Girgis, PhD
+
+ Academic use: Affero General Public License version 1.
+
+ Any restrictions to use for-profit or non-academics: Alternative commercial license is needed.
+
+ This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+ Please contact Dr. Hani Z. Girgis (hzgirgis@buffalo.edu) if you need more information.
+ */
+
+
+/*
+ * CoarseScorer.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Hani Z. Girgis, PhD
+ *     Purpose: The first stage of a multi-resolution cascade. A k-mer
+ *     histogram is folded into a (k - f)-mer histogram, which is 4^f times
+ *     smaller, once per sequence. A small regression model trained on the
+ *     folded histograms of the synthetic pairs scores a pair first. Only
+ *     the pairs whose coarse score is within a safety margin of the
+ *     threshold are scored on the full histograms.
+ *
+ *     A histogram built by this class holds the full histogram followed by
+ *     the folded one.
+ */
+
+#ifndef SRC_COARSESCORER_H_
+#define SRC_COARSESCORER_H_
+
+#include <vector>
+#include <string>
+
+#include "Matrix.h"
+#include "Feature.h"
+#include "GLMPredictor.h"
+#include "KmerHistogram.h"
+#include "Statistician.h"
+#include "Util.h"
+
+class CoarseScorer {
+private:
+	// Number of characters folded away
+	int foldNum;
+	// The k and the size of the folded histograms
+	int k;
+	int histSize;
+
+	// The identity score the margin is tuned at
+	double threshold;
+	// A pair is rejected if its coarse score is below it
+	double cutoff;
+
+	int featNum;
+	std::vector<int> funIndexList;
+	GLMPredictor predictor;
+	// The features and the weights; kept for saving the model
+	std::vector<Feature*> featList;
+
+	void makePredictor(std::vector<Feature*>&);
+
+public:
+	// A folded histogram is made of k-mers of this length at least
+	static constexpr int MIN_K = 3;
+	static constexpr int MAX_FOLD = 2;
+
+	/**
+	 * k: of the folded histograms. The size of the full histograms is
+	 * given. The features of the coarse regressor (the bias first) are
+	 * taken over by the predictor.
+	 */
+	CoarseScorer(std::vector<Feature*>&, int, int, int, double, double);
+	CoarseScorer(const CoarseScorer&) = delete;
+	CoarseScorer& operator=(const CoarseScorer&) = delete;
+	virtual ~CoarseScorer();
+
+	/**
+	 * The number of characters to fold away from the keys of a histogram of
+	 * the given size; 0 if the histograms are too small to fold
+	 */
+	static int findFoldNum(int);
+
+	/**
+	 * Fit a regressor to the identity scores of the synthetic pairs on the
+	 * statistics of their folded histograms. statList: the candidate
+	 * statistics (see GLMClassifier). Returns nullptr if there are too few
+	 * similar or dissimilar pairs to tune the margin on.
+	 */
+	static CoarseScorer* train(const Matrix*, const Matrix*, int, int, int,
+			double, int, const std::vector<int> &statList =
+					std::vector<int>());
+
+	/**
+	 * The margin tuned at one threshold is at least as wide as needed at a
+	 * higher one
+	 */
+	bool canApply(double) const;
+
+	/**
+	 * Build the full histogram followed by the folded one
+	 */
+	template<class V>
+	inline V* build(KmerHistogram<uint64_t, V> &kTable,
+			const std::string *sequence, const SegmentList &segmentList,
+			int threadNum = 1) {
+		int fullSize = kTable.getMaxTableSize();
+		V *kHist = new V[fullSize + histSize];
+		kTable.build(sequence, segmentList, kHist, threadNum);
+		kTable.fold(kHist, foldNum, kHist + fullSize);
+		return kHist;
+	}
+
+	/**
+	 * The folded histograms are passed
+	 */
+	template<class V>
+	inline bool isRejected(V *kHist1, V *kHist2, uint64_t *monoHist1,
+			uint64_t *monoHist2, double *compositionList) {
+		Statistician<V> s(histSize, k, kHist1, kHist2, monoHist1, monoHist2,
+				compositionList);
+		double data[featNum];
+		s.calculate(funIndexList.data(), funIndexList.size(), data);
+		return predictor.calculateIdentity(data) < cutoff;
+	}
+
+	int getFoldNum() const;
+	int getHistSize() const;
+	double getThreshold() const;
+	double getCutoff() const;
+	/**
+	 * Empty if the scorer is loaded from a model
+	 */
+	std::vector<Feature*>* getFeatureList();
+};
+
+#endif /* SRC_COARSESCORER_H_ */
@@ -0,0 +1,83 @@
+/*
+ Identity 2.0 calculates DNA sequence identity scores rapidly without alignment.
+
+ Copyright (C) 2020-2022 Hani Z. Girgis, PhD
+
+ Academic use: Affero General Public License version 1.
+
+ Any restrictions to use for-profit or non-academics: Alternative commercial license is needed.
+
+ This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+ Please contact Dr. Hani Z. Girgis (hzgirgis@buffalo.edu) if you need more information.
+ */
+
+/*
+ * CutoffTuner.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Hani Z. Girgis, PhD
+ */
+
+#include "CutoffTuner.h"
+
+#include <algorithm>
+#include <iostream>
+
+#include "StatisticInfo.h"
+
+bool CutoffTuner::hasBothClasses(const Matrix *l, double t) {
+	int rowNum = l->getNumRow();
+	int pstvNum = 0;
+	for (int r = 0; r < rowNum; r++) {
+		if (l->item(r, 0) >= t) {
+			pstvNum++;
+		}
+	}
+	return pstvNum >= 2 && rowNum - pstvNum >= 2;
+}
+
+double CutoffTuner::tune(const Matrix *f, const Matrix *l, double t,
+		GLMPredictor &predictor, const std::vector<int> &funIndexList,
+		int featNum) {
+	// The column of each statistic of the predictor
+	auto info = StatisticInfo::getInstance();
+	std::vector<int> colList;
+	for (int funIndex : funIndexList) {
+		colList.push_back(info->findPosition(funIndex));
+	}
+
+	int rowNum = l->getNumRow();
+	int singleNum = colList.size();
+	std::vector<double> pstvList;
+	std::vector<double> ngtvList;
+	double data[featNum];
+	for (int r = 0; r < rowNum; r++) {
+		for (int i = 0; i < singleNum; i++) {
+			data[i] = f->item(r, colList[i]);
+		}
+		double y = predictor.calculateIdentity(data);
+		if (l->item(r, 0) >= t) {
+			pstvList.push_back(y);
+		} else {
+			ngtvList.push_back(y);
+		}
+	}
+
+	// The highest cutoff that lets almost all similar pairs pass
+	std::sort(pstvList.begin(), pstvList.end());
+	int missNum = (1.0 - SENSITIVITY) * pstvList.size();
+	double cutoff = pstvList[missNum];
+
+	int rejectNum = 0;
+	for (double y : ngtvList) {
+		if (y < cutoff) {
+			rejectNum++;
+		}
+	}
+	std::cout << "\tRejected dissimilar pairs: "
+			<< (100.0 * rejectNum) / ngtvList.size() << "%" << std::endl;
+
+	return cutoff;
+}
@@ -0,0 +1,57 @@
+/*
+ Identity 2.0 calculates DNA sequence identity scores rapidly without alignment.
+
+ Copyright (C) 2020-2022 Hani Z. Girgis, PhD
+
+ Academic use: Affero General Public License version 1.
+
+ Any restrictions to use for-profit or non-academics: Alternative commercial license is needed.
+
+ This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+ Please contact Dr. Hani Z. Girgis (hzgirgis@buffalo.edu) if you need more information.
+ */
+
+/*
+ * CutoffTuner.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Hani Z. Girgis, PhD
+ *     Purpose: The first stages of the model (Prefilter and CoarseScorer)
+ *     reject a pair if the output of a small predictor is below a cutoff.
+ *     The cutoff is tuned on the synthetic pairs, so almost all similar
+ *     pairs pass.
+ */
+
+#ifndef SRC_CUTOFFTUNER_H_
+#define SRC_CUTOFFTUNER_H_
+
+#include <vector>
+
+#include "Matrix.h"
+#include "GLMPredictor.h"
+
+class CutoffTuner {
+public:
+	// The fraction of similar training pairs that must pass
+	static constexpr double SENSITIVITY = 0.999;
+	// The minimum number of features a first stage selects
+	static const int MIN_FEAT = 3;
+
+	/**
+	 * True if the identity scores include two similar and two dissimilar
+	 * pairs at least
+	 */
+	static bool hasBothClasses(const Matrix*, double);
+
+	/**
+	 * Returns the cutoff and reports the fraction of dissimilar pairs it
+	 * rejects. The predictor is applied to the statistics (funIndexList)
+	 * of each pair; featNum is the number of its expanded features.
+	 */
+	static double tune(const Matrix*, const Matrix*, double, GLMPredictor&,
+			const std::vector<int>&, int);
+};
+
+#endif /* SRC_CUTOFFTUNER_H_ */
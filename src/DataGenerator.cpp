@@ -21,27 +21,22 @@
  */
 
 #include "DataGenerator.h"
+#include "StatisticInfo.h"
 
 /**
  * This constructor should be used for all vs. all
  */
-DataGenerator::DataGenerator(std::string fileName, int blockSize) {
+DataGenerator::DataGenerator(std::string fileName, int blockSize,
+		int threadNum) {
+	FastaIndex index(fileName, threadNum);
+
 	FastaReader reader(fileName, blockSize);
+	reader.setThreadNum(threadNum);
 	block = reader.read();
 
 	calculateK();
 	calculateHistSize();
-
-	// Find maximum length
-	int seqNum = block->size();
-	for (int h = 0; h < seqNum; h++) {
-		uint64_t len = block->at(h).second->size();
-		if (len > maxLength) {
-			maxLength = len;
-		}
-	}
-	// The length was estimated based on a subset not the entire set
-	maxLength = 2 * maxLength;
+	calculateMaxLength(index.getMaxLength());
 }
 
 /**
@@ -50,12 +45,17 @@ DataGenerator::DataGenerator(std::string fileName, int blockSize) {
  * in length to the query sequences.
  */
 DataGenerator::DataGenerator(std::string dbName, std::string qryFile,
-		double threshold) {
+		double threshold, int threadNum) {
+
+	FastaIndex qryIndex(qryFile, threadNum);
+	FastaIndex dbIndex(dbName, threadNum);
 
 	FastaReader qryReader(qryFile, Parameters::getBlockSize());
+	qryReader.setThreadNum(threadNum);
 	Block *qryBlock = qryReader.read();
 
 	FastaReader dbReader(dbName, Parameters::getBlockSize());
+	dbReader.setThreadNum(threadNum);
 	block = dbReader.read();
 
 	// Move query sequence(s) to the database block
@@ -101,23 +101,12 @@ DataGenerator::DataGenerator(std::string dbName, std::string qryFile,
 					<< std::endl;
 			throw std::exception();
 		}
-
-		maxLength = max;
-	} else {
-		// Find maximum length
-		int seqNum = block->size();
-		for (int h = 0; h < seqNum; h++) {
-			uint64_t len = block->at(h).second->size();
-			if (len > maxLength) {
-				maxLength = len;
-			}
-		}
-		// The length was estimated based on a subset not the entire set
-		maxLength = 2 * maxLength;
 	}
 
 	calculateK();
 	calculateHistSize();
+	calculateMaxLength(
+			std::max(qryIndex.getMaxLength(), dbIndex.getMaxLength()));
 
 	// Free up memory
 	delete qryBlock;
@@ -143,10 +132,25 @@ void DataGenerator::calculateK() {
 	std::cout << "K: " << k << std::endl;
 }
 
+/**
+ * The longest sequence is known from the index. A mutated copy of a
+ * sequence is longer by the mutation rate at most.
+ */
+void DataGenerator::calculateMaxLength(int64_t longest) {
+	maxLength = ceil(longest * (2.0 - Parameters::getMinId()));
+}
+
 void DataGenerator::calculateHistSize() {
 	// Calculate histogram size
 	histogramSize = pow(4, k);
-	std::cout << "Histogram size: " << histogramSize << std::endl;
+	int width = Parameters::getHistWidth();
+	if (width > 0 && width < histogramSize) {
+		histogramSize = width;
+		std::cout << "Histogram size: " << histogramSize << " (hashed)"
+				<< std::endl;
+	} else {
+		std::cout << "Histogram size: " << histogramSize << std::endl;
+	}
 }
 
 DataGenerator::~DataGenerator() {
@@ -176,3 +180,22 @@ int64_t DataGenerator::getMaxLength() const {
 const Matrix* DataGenerator::getLabels() const {
 	return lTable;
 }
+
+const Matrix* DataGenerator::getCoarseFeatures() const {
+	return cTable;
+}
+
+/**
+ * A bin of a hashed histogram holds many k-mers; so the statistics reading
+ * the characters of its key are left out
+ */
+std::vector<int> DataGenerator::getCandidateList() const {
+	if (histogramSize < pow(4, k)) {
+		return StatisticInfo::getInstance()->getKeyFreeIndexList();
+	}
+	return std::vector<int>();
+}
+
+int DataGenerator::getFoldNum() const {
+	return foldNum;
+}
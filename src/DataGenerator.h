@@ -25,6 +25,7 @@
 
 #include <string>
 #include "FastaReader.h"
+#include "FastaIndex.h"
 #include "KmerHistogram.h"
 #include "Matrix.h"
 #include "Parameters.h"
@@ -33,6 +34,7 @@ class DataGenerator {
 private:
 	void calculateK();
 	void calculateHistSize();
+	void calculateMaxLength(int64_t);
 
 protected:
 	Block *block;
@@ -49,10 +51,14 @@ protected:
 	Matrix *fTable = nullptr;
 	// Model of associated labels (identity scores)
 	Matrix *lTable = nullptr;
+	// Single statistics of the folded histograms (see CoarseScorer)
+	Matrix *cTable = nullptr;
+	int foldNum = 0;
 
 public:
-	DataGenerator(std::string, int blockSize = Parameters::getBlockSize());
-	DataGenerator(std::string, std::string, double);
+	DataGenerator(std::string, int blockSize = Parameters::getBlockSize(),
+			int threadNum = 1);
+	DataGenerator(std::string, std::string, double, int threadNum = 1);
 	virtual ~DataGenerator();
 
 	// Free memory used by the two tables before the object is destroyed
@@ -64,6 +70,16 @@ public:
 
 	const Matrix* getFeatures() const;
 	const Matrix* getLabels() const;
+	/**
+	 * nullptr unless the generator folds the histograms
+	 */
+	const Matrix* getCoarseFeatures() const;
+	int getFoldNum() const;
+	/**
+	 * The positions of the statistics a regressor may select; empty if all
+	 * of them may be selected
+	 */
+	std::vector<int> getCandidateList() const;
 	double* getCompositionList() const;
 	int getHistogramSize() const;
 	int getK() const;
@@ -0,0 +1,316 @@
+/*
+ Identity 2.0 calculates DNA sequence identity scores rapidly without alignment.
+
+ Copyright (C) 2020-2022 Hani Z. Girgis, PhD
+
+ Academic use: Affero General Public License version 1.
+
+ Any restrictions to use for-profit or non-academics: Alternative commercial license is needed.
+
+ This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+ Please contact Dr. Hani Z. Girgis (hzgirgis@buffalo.edu) if you need more information.
+ */
+
+
+/*
+ * ExpandedTable.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Hani Z. Girgis, PhD
+ */
+
+#include "ExpandedTable.h"
+
+#include <algorithm>
+
+#include "Normalizer.h"
+#include "SimConverter.h"
+#include "FeatureExpander.h"
+
+// Rows of a block of the Gram matrix; a block of the table fits in the cache
+static const int BLOCK = 64;
+
+static void clean(std::vector<Feature*> &list) {
+	for (auto f : list) {
+		delete f;
+	}
+	list.clear();
+}
+
+ExpandedTable::ExpandedTable(const Matrix &m, const std::vector<Feature*> &f,
+		int threadNumIn) :
+		rowNum(m.getNumRow()), singleNum(m.getNumCol()), threadNum(threadNumIn) {
+	// The first normalizer checks the table and the features
+	Normalizer normalizer(m, f);
+	std::vector<Feature*> f1 = normalizer.getFeatureList();
+	SimConverter sim(f1);
+	std::vector<Feature*> f2 = sim.getFeatureList();
+
+	for (int c = 0; c < singleNum; c++) {
+		auto p = f1[c];
+		double dist = p->getNormP2() - p->getNormP1();
+		bool isNormalize = !f[c]->getIsNormalized();
+		if (isNormalize && Util::isEqual(dist, 0.0)) {
+			dist = 0.0;
+			std::cerr << "Normalizer warning: ";
+			std::cerr << "Column " << c << " has the same value. ";
+			std::cerr << "Values are already set to zero." << std::endl;
+		}
+		singleMinList.push_back(p->getNormP1());
+		singleDistList.push_back(dist);
+		isNormalizeList.push_back(isNormalize);
+		isConvertList.push_back(p->getIsDistance() && !p->getIsConverted());
+	}
+	clean(f1);
+	singleTable = convertSingles(m);
+
+	// The expanded features; singles are normalized already
+	FeatureExpander expander(singleTable, f2);
+	fList = expander.getFeatureList();
+	clean(f2);
+	colNum = fList.size();
+	compNumList.resize(colNum, 0);
+	compOneList.resize(colNum, -1);
+	compTwoList.resize(colNum, -1);
+	for (int c = 0; c < colNum; c++) {
+		auto p = fList[c];
+		int n = p->getNumOfComp();
+		compNumList[c] = n;
+		if (n >= 1) {
+			compOneList[c] = p->getCompOneIndex();
+		}
+		if (n == 2) {
+			compTwoList[c] = p->getCompTwoIndex();
+		}
+	}
+
+	// The minimum and the maximum of each expanded column
+	std::vector<double> lowList(colNum, 0.0);
+	std::vector<double> highList(colNum, 0.0);
+	for (int c = singleNum; c < colNum; c++) {
+		lowList[c] = raw(singleTable.getArray(), c);
+		highList[c] = lowList[c];
+	}
+#pragma omp parallel num_threads(threadNum)
+	{
+		std::vector<double> low(lowList);
+		std::vector<double> high(highList);
+#pragma omp for schedule(static)
+		for (int r = 1; r < rowNum; r++) {
+			const double *row = singleTable.getArray() + (int64_t) r * singleNum;
+			for (int c = singleNum; c < colNum; c++) {
+				double i = raw(row, c);
+				if (i < low[c]) {
+					low[c] = i;
+				}
+				if (i > high[c]) {
+					high[c] = i;
+				}
+			}
+		}
+#pragma omp critical
+		{
+			for (int c = singleNum; c < colNum; c++) {
+				lowList[c] = std::min(lowList[c], low[c]);
+				highList[c] = std::max(highList[c], high[c]);
+			}
+		}
+	}
+
+	minList.resize(colNum, 0.0);
+	distList.resize(colNum, 1.0);
+	for (int c = 0; c < colNum; c++) {
+		auto p = fList[c];
+		if (!p->getIsNormalized()) {
+			p->setNormP1(lowList[c]);
+			p->setNormP2(highList[c]);
+			minList[c] = lowList[c];
+			distList[c] = highList[c] - lowList[c];
+			if (Util::isEqual(distList[c], 0.0)) {
+				distList[c] = 0.0;
+				std::cerr << "Normalizer warning: ";
+				std::cerr << "Column " << c << " has the same value. ";
+				std::cerr << "Values are already set to zero." << std::endl;
+			}
+		}
+		p->setIsNormalized(true);
+	}
+
+	columnList.resize(colNum);
+}
+
+ExpandedTable::~ExpandedTable() {
+	clean(fList);
+}
+
+Matrix ExpandedTable::convertSingles(const Matrix &m) const {
+	int n = m.getNumRow();
+	Matrix t(n, singleNum);
+#pragma omp parallel for schedule(static) num_threads(threadNum)
+	for (int r = 0; r < n; r++) {
+		for (int c = 0; c < singleNum; c++) {
+			double v = m(r, c);
+			if (isNormalizeList[c]) {
+				if (singleDistList[c] == 0.0) {
+					v = 0.0;
+				} else {
+					v = (v - singleMinList[c]) / singleDistList[c];
+					// Trim if below 0 or above 1
+					if (v < 0.0) {
+						v = 0.0;
+					}
+					if (v > 1.0) {
+						v = 1.0;
+					}
+				}
+			}
+			if (isConvertList[c]) {
+				v = 1 - v;
+			}
+			t(r, c) = v;
+		}
+	}
+	return t;
+}
+
+int ExpandedTable::getNumRow() const {
+	return rowNum;
+}
+
+int ExpandedTable::getNumCol() const {
+	return colNum;
+}
+
+void ExpandedTable::cache(const std::vector<int> &list) {
+	for (int c : list) {
+		std::vector<double> &column = columnList.at(c);
+		if (!column.empty()) {
+			continue;
+		}
+		column.resize(rowNum);
+		const double *array = singleTable.getArray();
+#pragma omp parallel for schedule(static) num_threads(threadNum)
+		for (int r = 0; r < rowNum; r++) {
+			column[r] = value(array + (int64_t) r * singleNum, c);
+		}
+	}
+}
+
+void ExpandedTable::clearCache() {
+	for (auto &column : columnList) {
+		std::vector<double>().swap(column);
+	}
+}
+
+const double* ExpandedTable::getColumn(int c) const {
+	return columnList[c].empty() ? nullptr : columnList[c].data();
+}
+
+void ExpandedTable::normalEquations(const Matrix &l, Matrix &gram,
+		std::vector<double> &labelList) const {
+	if (l.getNumRow() != rowNum) {
+		std::cerr << "ExpandedTable error: " << std::endl;
+		std::cerr << "Label number does not match row number." << std::endl;
+		throw std::exception();
+	}
+
+	int n = colNum + 1;
+	int blockNum = (rowNum + BLOCK - 1) / BLOCK;
+	gram = Matrix(n, n);
+	labelList.assign(n, 0.0);
+	double *g = gram.getArray();
+
+#pragma omp parallel num_threads(threadNum)
+	{
+		// Upper triangles of the products of the blocks of a thread
+		std::vector<double> localGram((int64_t) n * n, 0.0);
+		std::vector<double> localLabel(n, 0.0);
+		std::vector<double> block((int64_t) BLOCK * n);
+
+#pragma omp for schedule(static)
+		for (int b = 0; b < blockNum; b++) {
+			int start = b * BLOCK;
+			int size = std::min(BLOCK, rowNum - start);
+			for (int r = 0; r < size; r++) {
+				const double *row = singleTable.getArray()
+						+ (int64_t) (start + r) * singleNum;
+				double *x = block.data() + (int64_t) r * n;
+				x[0] = 1.0;
+				for (int c = 0; c < colNum; c++) {
+					x[c + 1] = value(row, c);
+				}
+				double y = l(start + r, 0);
+				for (int i = 0; i < n; i++) {
+					localLabel[i] += x[i] * y;
+				}
+			}
+
+			for (int i = 0; i < n; i++) {
+				double *out = localGram.data() + (int64_t) i * n;
+				for (int r = 0; r < size; r++) {
+					const double *x = block.data() + (int64_t) r * n;
+					double xi = x[i];
+#pragma omp simd
+					for (int j = i; j < n; j++) {
+						out[j] += xi * x[j];
+					}
+				}
+			}
+		}
+
+#pragma omp critical
+		{
+			for (int i = 0; i < n; i++) {
+				labelList[i] += localLabel[i];
+				for (int j = i; j < n; j++) {
+					g[(int64_t) i * n + j] += localGram[(int64_t) i * n + j];
+				}
+			}
+		}
+	}
+
+	for (int i = 0; i < n; i++) {
+		for (int j = 0; j < i; j++) {
+			g[(int64_t) i * n + j] = g[(int64_t) j * n + i];
+		}
+	}
+}
+
+Matrix ExpandedTable::subMatrixByCol(const int list[], int s) const {
+	Matrix t(rowNum, s);
+#pragma omp parallel for schedule(static) num_threads(threadNum)
+	for (int r = 0; r < rowNum; r++) {
+		for (int a = 0; a < s; a++) {
+			t(r, a) = at(r, list[a]);
+		}
+	}
+	return t;
+}
+
+Matrix ExpandedTable::transform(const Matrix &m) {
+	if (m.getNumCol() != singleNum) {
+		std::cerr << "ExpandedTable error: Column numbers do not match.";
+		std::cerr << "Expecting " << singleNum << " but received "
+				<< m.getNumCol();
+		std::cerr << std::endl;
+		throw std::exception();
+	}
+
+	int n = m.getNumRow();
+	Matrix s = convertSingles(m);
+	Matrix t(n, colNum);
+#pragma omp parallel for schedule(static) num_threads(threadNum)
+	for (int r = 0; r < n; r++) {
+		const double *row = s.getArray() + (int64_t) r * singleNum;
+		for (int c = 0; c < colNum; c++) {
+			t(r, c) = value(row, c);
+		}
+	}
+	return t;
+}
+
+std::vector<Feature*> ExpandedTable::getFeatureList() {
+	return copy(fList);
+}
@@ -0,0 +1,155 @@
+/*
+ Identity 2.0 calculates DNA sequence identity scores rapidly without alignment.
+
+ Copyright (C) 2020-2022 Hani Z. Girgis, PhD
+
+ Academic use: Affero General Public License version 1.
+
+ Any restrictions to use for-profit or non-academics: Alternative commercial license is needed.
+
+ This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+ Please contact Dr. Hani Z. Girgis (hzgirgis@buffalo.edu) if you need more information.
+ */
+
+
+/*
+ * ExpandedTable.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Hani Z. Girgis, PhD
+ *     Purpose: The training table as seen after Normalizer, SimConverter,
+ *     FeatureExpander, and a second Normalizer, without making it. Only the
+ *     normalized similarities of the single features are stored; they are
+ *     made in one pass. A squared or a paired column is computed from them
+ *     when needed, and it is stored only if it is cached. The values and the
+ *     feature list are the same as those of the four transformers.
+ */
+
+#ifndef SRC_EXPANDEDTABLE_H_
+#define SRC_EXPANDEDTABLE_H_
+
+#include <vector>
+
+#include "Matrix.h"
+#include "Feature.h"
+#include "ITransformer.h"
+
+class ExpandedTable: public ITransformer {
+private:
+	int rowNum;
+	int singleNum;
+	int colNum;
+	int threadNum;
+
+	// The minimum and the range of each single column, whether it is
+	// normalized, and whether it is converted from a distance to a similarity
+	std::vector<double> singleMinList;
+	std::vector<double> singleDistList;
+	std::vector<bool> isNormalizeList;
+	std::vector<bool> isConvertList;
+	// Normalized similarities of the single features
+	Matrix singleTable;
+	// The number of components and the components of each column
+	std::vector<int> compNumList;
+	std::vector<int> compOneList;
+	std::vector<int> compTwoList;
+	// The minimum and the range of each expanded column; a range of zero
+	// makes a column of zeros
+	std::vector<double> minList;
+	std::vector<double> distList;
+
+	std::vector<Feature*> fList;
+
+	// Cached columns; empty if not cached
+	std::vector<std::vector<double> > columnList;
+
+	/**
+	 * The value of a column before it is normalized
+	 */
+	inline double raw(const double *row, int c) const {
+		int n = compNumList[c];
+		if (n == 0) {
+			return row[c];
+		} else if (n == 1) {
+			double t = row[compOneList[c]];
+			return t * t;
+		}
+		return raw(row, compOneList[c]) * raw(row, compTwoList[c]);
+	}
+
+	inline double value(const double *row, int c) const {
+		if (compNumList[c] == 0) {
+			return row[c];
+		}
+		if (distList[c] == 0.0) {
+			return 0.0;
+		}
+		double res = (raw(row, c) - minList[c]) / distList[c];
+		if (res < 0.0) {
+			return 0.0;
+		}
+		if (res > 1.0) {
+			return 1.0;
+		}
+		return res;
+	}
+
+	/**
+	 * Normalize and convert the single columns in one pass
+	 */
+	Matrix convertSingles(const Matrix&) const;
+
+public:
+	/**
+	 * The table and the initial (single) features
+	 */
+	ExpandedTable(const Matrix&, const std::vector<Feature*>&, int);
+	ExpandedTable(const ExpandedTable&) = delete;
+	ExpandedTable& operator=(const ExpandedTable&) = delete;
+	virtual ~ExpandedTable();
+
+	int getNumRow() const;
+	int getNumCol() const;
+
+	/**
+	 * Not thread safe if the column is being cached
+	 */
+	inline double at(int r, int c) const {
+		if (!columnList[c].empty()) {
+			return columnList[c][r];
+		}
+		return value(singleTable.getArray() + (int64_t) r * singleNum, c);
+	}
+
+	/**
+	 * Store the columns that are used repeatedly
+	 */
+	void cache(const std::vector<int>&);
+	void clearCache();
+	/**
+	 * The cached column or nullptr
+	 */
+	const double* getColumn(int) const;
+
+	/**
+	 * Make the normal equations of all columns and a column of ones, which
+	 * is the first one: the Gram matrix and the products with the labels
+	 */
+	void normalEquations(const Matrix&, Matrix&, std::vector<double>&) const;
+
+	Matrix subMatrixByCol(const int[], int) const;
+
+	/**
+	 * Makes the whole table of another matrix, as the four transformers do
+	 */
+	virtual Matrix transform(const Matrix&);
+
+	/**
+	 * The features of the columns, normalized and converted
+	 */
+	virtual std::vector<Feature*> getFeatureList();
+};
+
+#endif /* SRC_EXPANDEDTABLE_H_ */
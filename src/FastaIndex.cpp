@@ -0,0 +1,185 @@
+/*
+ Identity 2.0 calculates DNA sequence identity scores rapidly without alignment.
+
+ Copyright (C) 2020-2022 Hani Z. Girgis, PhD
+
+ Academic use: Affero General Public License version 1.
+
+ Any restrictions to use for-profit or non-academics: Alternative commercial license is needed.
+
+ This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+ Please contact Dr. Hani Z. Girgis (hzgirgis@buffalo.edu) if you need more information.
+ */
+
+/*
+ * FastaIndex.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Hani Z. Girgis, PhD
+ *
+ *  The index file is tab-separated text. The first line holds a tag, the
+ *  format version, the size and the modification time of the input file.
+ *  Each following line describes a record: sequence length, position, and
+ *  header (the rest of the line).
+ */
+
+#include "FastaIndex.h"
+
+#include <fstream>
+#include <algorithm>
+#include <iostream>
+#include <cstdio>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static const std::string TAG = "#identity-index";
+static const int VERSION = 3;
+
+FastaIndex::FastaIndex(std::string fileNameIn, int threadNum) {
+	fileName = fileNameIn;
+	indexName = fileName + ".identity.fai";
+
+	struct stat info;
+	if (stat(fileName.c_str(), &info) != 0) {
+		std::cerr << "Cannot open file: " << fileName << std::endl;
+		throw std::exception();
+	}
+	fileSize = info.st_size;
+	fileTime = (int64_t) info.st_mtim.tv_sec * 1000000000
+			+ info.st_mtim.tv_nsec;
+
+	if (!load()) {
+		build(threadNum);
+		save();
+	}
+
+	maxLength = 0;
+	for (int64_t len : lengthList) {
+		if (len > maxLength) {
+			maxLength = len;
+		}
+	}
+}
+
+FastaIndex::~FastaIndex() {
+}
+
+/**
+ * Returns false if there is no index or if it is out of date
+ */
+bool FastaIndex::load() {
+	std::ifstream in(indexName);
+	if (!in.good()) {
+		return false;
+	}
+
+	std::string tag;
+	int version;
+	uint64_t size;
+	int64_t time;
+	if (!(in >> tag >> version >> size >> time) || tag != TAG
+			|| version != VERSION || size != fileSize || time != fileTime) {
+		return false;
+	}
+
+	int64_t length;
+	long int pos;
+	std::string header;
+	while (in >> length >> pos && in.get() == '\t'
+			&& std::getline(in, header)) {
+		lengthList.push_back(length);
+		posList.push_back(pos);
+		headerList.add(header);
+	}
+
+	if (!in.eof()) {
+		lengthList.clear();
+		posList.clear();
+		headerList.clear();
+		return false;
+	}
+
+	return true;
+}
+
+void FastaIndex::build(int threadNum) {
+	std::cout << "Indexing " << fileName << " ..." << std::endl;
+
+	FastaReader reader(fileName, 10 * Parameters::getBlockSize());
+	reader.setThreadNum(threadNum);
+	while (reader.isStillReading()) {
+		Block *block = reader.read(&posList);
+		for (auto &record : *block) {
+			lengthList.push_back(record.second->size());
+			headerList.add(*record.first);
+		}
+		FastaReader::deleteBlock(block);
+	}
+}
+
+/**
+ * The index is written to a temporary file first, so a concurrent run
+ * never sees a partial index. It is not an error if the directory is
+ * read-only; the index is rebuilt next time.
+ */
+void FastaIndex::save() const {
+	std::string tempName = indexName + "." + std::to_string(getpid());
+	std::ofstream out(tempName);
+	if (!out.good()) {
+		return;
+	}
+
+	out << TAG << "\t" << VERSION << "\t" << fileSize << "\t" << fileTime
+			<< "\n";
+	for (uint64_t i = 0; i < posList.size(); i++) {
+		out << lengthList[i] << "\t" << posList[i] << "\t" << headerList.get(i)
+				<< "\n";
+	}
+	out.close();
+
+	if (!out.good() || rename(tempName.c_str(), indexName.c_str()) != 0) {
+		remove(tempName.c_str());
+	}
+}
+
+uint64_t FastaIndex::getCount() const {
+	return posList.size();
+}
+
+int64_t FastaIndex::getMaxLength() const {
+	return maxLength;
+}
+
+long int FastaIndex::getPos(uint64_t i) const {
+	return posList.at(i);
+}
+
+int64_t FastaIndex::getLength(uint64_t i) const {
+	return lengthList.at(i);
+}
+
+std::string_view FastaIndex::getHeader(uint64_t i) const {
+	return headerList.get(i);
+}
+
+std::vector<uint32_t> FastaIndex::getLengthOrder() const {
+	std::vector<uint32_t> r(lengthList.size());
+	for (size_t i = 0; i < r.size(); i++) {
+		r[i] = i;
+	}
+	std::stable_sort(r.begin(), r.end(), [this](uint32_t a, uint32_t b) {
+		return lengthList[a] > lengthList[b];
+	});
+	return r;
+}
+
+Block* FastaIndex::fetch(FastaReader &reader,
+		const std::vector<uint32_t> &idList) const {
+	std::vector<long int> list(idList.size());
+	for (size_t i = 0; i < idList.size(); i++) {
+		list[i] = posList.at(idList[i]);
+	}
+	return reader.fetch(list, idList);
+}
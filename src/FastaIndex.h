@@ -0,0 +1,86 @@
+/*
+ Identity 2.0 calculates DNA sequence identity scores rapidly without alignment.
+
+ Copyright (C) 2020-2022 Hani Z. Girgis, PhD
+
+ Academic use: Affero General Public License version 1.
+
+ Any restrictions to use for-profit or non-academics: Alternative commercial license is needed.
+
+ This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+ Please contact Dr. Hani Z. Girgis (hzgirgis@buffalo.edu) if you need more information.
+ */
+
+/*
+ * FastaIndex.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Hani Z. Girgis, PhD
+ *     Purpose: A .fai-style index of the records of a FASTA/FASTQ file:
+ *     the position (as returned by FastaReader::getCurrentPos), the length,
+ *     and the header of each record. The index is built once and saved next
+ *     to the input file (<file>.identity.fai). It is rebuilt if the file
+ *     size or the modification time changes.
+ */
+
+#ifndef SRC_FASTAINDEX_H_
+#define SRC_FASTAINDEX_H_
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "FastaReader.h"
+#include "HeaderArena.h"
+
+class FastaIndex {
+private:
+	std::string fileName;
+	std::string indexName;
+	// Identify the version of the input file the index was built on
+	uint64_t fileSize;
+	int64_t fileTime;
+
+	std::vector<long int> posList;
+	std::vector<int64_t> lengthList;
+	HeaderArena headerList;
+	int64_t maxLength;
+
+	bool load();
+	void build(int);
+	void save() const;
+
+public:
+	FastaIndex(std::string, int threadNum = 1);
+	FastaIndex(const FastaIndex&) = delete;
+	FastaIndex& operator=(const FastaIndex&) = delete;
+	virtual ~FastaIndex();
+
+	/**
+	 * Number of records (all-unknown sequences are not counted)
+	 */
+	uint64_t getCount() const;
+	int64_t getMaxLength() const;
+
+	long int getPos(uint64_t) const;
+	int64_t getLength(uint64_t) const;
+	/**
+	 * The view is valid as long as the index is
+	 */
+	std::string_view getHeader(uint64_t) const;
+
+	/**
+	 * The record numbers from the longest sequence to the shortest one.
+	 * Records of the same length are in file order.
+	 */
+	std::vector<uint32_t> getLengthOrder() const;
+
+	/**
+	 * Read the records in the list by a reader of the indexed file
+	 */
+	Block* fetch(FastaReader&, const std::vector<uint32_t>&) const;
+};
+
+#endif /* SRC_FASTAINDEX_H_ */
@@ -23,33 +23,122 @@
  *  Notes:
  *  + A sequence of all unknown nucleotides or aa's is excluded.
  *  + A sequence is converted to upper case.
+ *  + The valid segments (free of unknown symbols) of a sequence are found
+ *    while normalizing it and stored with the sequence.
+ *  + The file may be plain, gzip-compressed or BGZF-compressed FASTA or
+ *    FASTQ. The quality lines of FASTQ records are skipped and the '@' of
+ *    a header is replaced by '>'.
  */
 
 #include "FastaReader.h"
 
+/**
+ * Read a little-endian unsigned integer
+ */
+static inline uint32_t readLittle(const char *p, int byteNum) {
+	uint32_t r = 0;
+	for (int i = byteNum - 1; i >= 0; i--) {
+		r = (r << 8) | (unsigned char) p[i];
+	}
+	return r;
+}
+
+/**
+ * The size of the BGZF block starting at p, or 0 if p is not a BGZF block
+ */
+static size_t findBgzfSize(const char *p, size_t available) {
+	if (available < 18 || (unsigned char) p[0] != 0x1f
+			|| (unsigned char) p[1] != 0x8b || !(p[3] & 4)) {
+		return 0;
+	}
+
+	size_t xLen = readLittle(p + 10, 2);
+	size_t i = 12;
+	while (i + 4 <= 12 + xLen && i + 4 <= available) {
+		size_t sLen = readLittle(p + i + 2, 2);
+		if (p[i] == 'B' && p[i + 1] == 'C' && sLen == 2
+				&& i + 6 <= available) {
+			return readLittle(p + i + 4, 2) + 1;
+		}
+		i += 4 + sLen;
+	}
+	return 0;
+}
+
 FastaReader::FastaReader(std::string fileNameIn, int blockSizeIn,
-		long int currentPosIn, int maxLenIn) {
+		long int currentPosIn, int maxLenIn, uint64_t recordNumIn) {
 	fileName = fileNameIn;
 	blockSize = blockSizeIn;
 
 	unknown = Parameters::getUnknown();
 
-	isDone = false;
-	currentPos = currentPosIn;
-	in = std::ifstream(fileName.c_str());
-	if (!in.good()) {
+	fd = open(fileName.c_str(), O_RDONLY);
+	if (fd < 0) {
 		std::cerr << "Cannot open file: " << fileName << std::endl;
 		throw std::exception();
 	}
 
-	in.seekg(currentPos);
-	if (in.rdstate() & (in.badbit | in.eofbit | in.failbit)) {
+	struct stat info;
+	if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode)) {
+		close(fd);
 		std::cerr << "FastaReader Error: " << std::endl;
-		std::cerr << "Cannot move to position: " << currentPos << std::endl;
+		std::cerr << "Not a regular file: " << fileName << std::endl;
 		throw std::exception();
 	}
 
+	mapSize = info.st_size;
+	map = nullptr;
+	if (mapSize > 0) {
+		void *m = mmap(nullptr, mapSize, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (m == MAP_FAILED) {
+			close(fd);
+			std::cerr << "FastaReader Error: " << std::endl;
+			std::cerr << "Cannot map file: " << fileName << std::endl;
+			throw std::exception();
+		}
+		madvise(m, mapSize, MADV_SEQUENTIAL);
+		map = (const char*) m;
+	}
+
+	// Detect the compression from the gzip magic bytes
+	zs = nullptr;
+	format = Format::PLAIN;
+	if (mapSize >= 2 && (unsigned char) map[0] == 0x1f
+			&& (unsigned char) map[1] == 0x8b) {
+		if (findBgzfSize(map, mapSize) > 0) {
+			format = Format::BGZF;
+		} else {
+			format = Format::GZIP;
+			zs = new z_stream();
+			if (inflateInit2(zs, 15 + 32) != Z_OK) {
+				std::cerr << "FastaReader Error: " << std::endl;
+				std::cerr << "Cannot initialize zlib." << std::endl;
+				throw std::exception();
+			}
+		}
+	}
+
 	maxLen = maxLenIn;
+	recordNum = recordNumIn;
+	threadNum = 1;
+	recordBytes = 1024;
+
+	seek(currentPosIn);
+
+	// A FASTQ record starts with '@'
+	size_t q = streamPos - bufferStart;
+	while (true) {
+		if (q >= dataSize) {
+			if (!fill()) {
+				break;
+			}
+		} else if (isspace((unsigned char) data[q])) {
+			q++;
+		} else {
+			break;
+		}
+	}
+	isFastq = q < dataSize && data[q] == '@';
 
 	for (int i = 0; i < 128; i++) {
 		codeMap[i] = NOT;
@@ -72,10 +161,267 @@ FastaReader::FastaReader(std::string fileNameIn, int blockSizeIn,
 	codeMap['D'] = 'T';
 	// Added on 11/19/2020 to enable reading multi-sequence alignments
 	codeMap['-'] = '-';
+
+	// Fold the case conversion into the code map
+	for (int i = 0; i < 256; i++) {
+		int o = i >= 97 ? i - 32 : i;
+		normalMap[i] = o < 128 ? codeMap[o] : NOT;
+	}
 }
 
 FastaReader::~FastaReader() {
-	in.close();
+	if (zs != nullptr) {
+		inflateEnd(zs);
+		delete zs;
+	}
+	if (map != nullptr) {
+		munmap((void*) map, mapSize);
+	}
+	close(fd);
+}
+
+/**
+ * Move to a position returned by getCurrentPos or to the start (0)
+ */
+void FastaReader::seek(long int pos) {
+	isDone = false;
+	currentPos = pos;
+
+	buffer.clear();
+	bufferStart = 0;
+	bgzfList.clear();
+	data = buffer.data();
+	dataSize = 0;
+
+	bool isValid = pos >= 0;
+	switch (format) {
+	case Format::PLAIN:
+		isValid = isValid && (size_t) pos <= mapSize;
+		data = map;
+		dataSize = mapSize;
+		isStreamDone = true;
+		streamPos = pos;
+		break;
+
+	case Format::GZIP:
+		// No random access; decompress from the start up to the position
+		inflateReset(zs);
+		zs->avail_in = 0;
+		zPos = 0;
+		isStreamDone = false;
+		while (isValid && bufferStart + dataSize < (size_t) pos) {
+			discard(dataSize);
+			if (!fill()) {
+				isValid = false;
+			}
+		}
+		if (isValid) {
+			discard(pos - bufferStart);
+		}
+		streamPos = pos;
+		break;
+
+	case Format::BGZF:
+		// A virtual offset: the block offset and the offset in the block
+		bgzfPos = pos >> 16;
+		isStreamDone = bgzfPos >= mapSize;
+		isValid = isValid && bgzfPos <= mapSize
+				&& (isStreamDone
+						|| findBgzfSize(map + bgzfPos, mapSize - bgzfPos) > 0);
+		if (isValid) {
+			fill();
+			isValid = (pos & 0xFFFF) <= dataSize;
+		}
+		streamPos = pos & 0xFFFF;
+		break;
+	}
+
+	if (!isValid) {
+		std::cerr << "FastaReader Error: " << std::endl;
+		std::cerr << "Cannot move to position: " << pos << std::endl;
+		throw std::exception();
+	}
+}
+
+/**
+ * Decompress more bytes into the window.
+ * Returns false if the input has ended.
+ */
+bool FastaReader::fill() {
+	if (isStreamDone) {
+		return false;
+	}
+
+	if (format == Format::GZIP) {
+		fillGzip();
+	} else if (format == Format::BGZF) {
+		fillBgzf();
+	}
+
+	data = buffer.data();
+	dataSize = buffer.size();
+	return true;
+}
+
+void FastaReader::fillGzip() {
+	const size_t chunk = 1 << 20;
+	size_t old = buffer.size();
+	buffer.resize(old + chunk);
+	zs->next_out = (Bytef*) &buffer[old];
+	zs->avail_out = chunk;
+
+	while (zs->avail_out > 0) {
+		if (zs->avail_in == 0) {
+			if (zPos >= mapSize) {
+				isStreamDone = true;
+				break;
+			}
+			size_t len = std::min(mapSize - zPos, (size_t) 1 << 30);
+			zs->next_in = (Bytef*) (map + zPos);
+			zs->avail_in = len;
+			zPos += len;
+		}
+
+		int ret = inflate(zs, Z_NO_FLUSH);
+		if (ret == Z_STREAM_END) {
+			if (zs->avail_in == 0 && zPos >= mapSize) {
+				isStreamDone = true;
+				break;
+			}
+			// Concatenated gzip members
+			inflateReset(zs);
+		} else if (ret != Z_OK) {
+			std::cerr << "FastaReader Error: " << std::endl;
+			std::cerr << "Cannot decompress: " << fileName << std::endl;
+			throw std::exception();
+		}
+	}
+
+	buffer.resize(old + chunk - zs->avail_out);
+}
+
+/**
+ * Decompress a batch of BGZF blocks in parallel
+ */
+void FastaReader::fillBgzf() {
+	const int workerNum = threadNum;
+	const size_t batch = 16 * workerNum;
+	std::vector<size_t> startList;
+	std::vector<size_t> sizeList;
+	size_t q = bgzfPos;
+	while (q < mapSize && startList.size() < batch) {
+		size_t size = findBgzfSize(map + q, mapSize - q);
+		if (size == 0 || q + size > mapSize) {
+			std::cerr << "FastaReader Error: " << std::endl;
+			std::cerr << "Invalid BGZF block at: " << q << std::endl;
+			throw std::exception();
+		}
+		startList.push_back(q);
+		sizeList.push_back(size);
+		q += size;
+	}
+
+	int n = startList.size();
+	std::vector<std::string> outList(n);
+	std::vector<char> isValidList(n, true);
+#pragma omp parallel for schedule(static) num_threads(workerNum)
+	for (int i = 0; i < n; i++) {
+		const char *block = map + startList[i];
+		size_t size = sizeList[i];
+		// The uncompressed size is stored in the last 4 bytes
+		size_t outSize = readLittle(block + size - 4, 4);
+		// One extra byte keeps the output pointer valid for empty blocks
+		outList[i].resize(outSize + 1);
+
+		z_stream s = z_stream();
+		inflateInit2(&s, 15 + 16);
+		s.next_in = (Bytef*) block;
+		s.avail_in = size;
+		s.next_out = (Bytef*) &outList[i][0];
+		s.avail_out = outSize + 1;
+		int ret = inflate(&s, Z_FINISH);
+		isValidList[i] = ret == Z_STREAM_END && s.total_out == outSize;
+		inflateEnd(&s);
+		outList[i].resize(outSize);
+	}
+
+	for (int i = 0; i < n; i++) {
+		if (!isValidList[i]) {
+			std::cerr << "FastaReader Error: " << std::endl;
+			std::cerr << "Cannot decompress the BGZF block at: "
+					<< startList[i] << std::endl;
+			throw std::exception();
+		}
+		bgzfList.push_back(
+				make_pair(startList[i], bufferStart + buffer.size()));
+		buffer.append(outList[i]);
+	}
+
+	bgzfPos = q;
+	if (bgzfPos >= mapSize) {
+		isStreamDone = true;
+	}
+}
+
+/**
+ * Decompress until the window holds n complete records after the offset p
+ * or the input ends
+ */
+void FastaReader::ensure(size_t p, int n) {
+	int count = 0;
+	size_t q = p;
+	while (!isStreamDone) {
+		while (count < n && q < dataSize) {
+			const char *next = skipRecord(data + q);
+			if (next >= data + dataSize) {
+				break;
+			}
+			count++;
+			q = next - data;
+		}
+		if (count >= n) {
+			break;
+		}
+		fill();
+	}
+}
+
+/**
+ * Drop the decompressed bytes before the offset p
+ */
+void FastaReader::discard(size_t p) {
+	if (format == Format::PLAIN || p == 0) {
+		return;
+	}
+
+	buffer.erase(0, p);
+	bufferStart += p;
+	data = buffer.data();
+	dataSize = buffer.size();
+
+	// Keep the block holding the first byte
+	size_t i = 0;
+	while (i + 1 < bgzfList.size() && bgzfList[i + 1].second <= bufferStart) {
+		i++;
+	}
+	bgzfList.erase(bgzfList.begin(), bgzfList.begin() + i);
+}
+
+long int FastaReader::toCurrentPos(uint64_t pos) const {
+	if (format != Format::BGZF) {
+		return pos;
+	}
+
+	// At the end of the decompressed blocks: the start of the next block
+	if (bgzfList.empty() || pos >= bufferStart + buffer.size()) {
+		return bgzfPos << 16;
+	}
+
+	size_t i = 0;
+	while (i + 1 < bgzfList.size() && bgzfList[i + 1].second <= pos) {
+		i++;
+	}
+	return (bgzfList[i].first << 16) | (pos - bgzfList[i].second);
 }
 
 /**
@@ -92,7 +438,7 @@ void FastaReader::deleteBlock(Block *block) {
 	delete block;
 }
 
-Block* FastaReader::read() {
+Block* FastaReader::read(vector<long int> *posList) {
 
 	if (!isStillReading()) {
 		std::cerr << "Cannot call read on a done FastaReader object.";
@@ -100,110 +446,417 @@ Block* FastaReader::read() {
 		throw std::exception();
 	}
 
-	bool isFirst = true;
-	string *base = new string("");
-	string *info;
 	Block *b = new Block();
 	b->reserve(blockSize);
 
+	const char recordSymbol = isFastq ? '@' : '>';
+	size_t p = streamPos - bufferStart;
+
+	// Skip anything before the first header
+	while (true) {
+		if (p >= dataSize) {
+			if (!fill()) {
+				break;
+			}
+		} else if (data[p] == recordSymbol) {
+			break;
+		} else {
+			const char *lineEnd = findLineEnd(data + p);
+			if (lineEnd == data + dataSize && fill()) {
+				continue;
+			}
+			p = lineEnd - data + 1;
+		}
+	}
+
 	int counter = 0;
-	while (in.good() && counter < blockSize) {
-		string line;
-		getline(in, line);
-		int len = line.length();
+	while (counter < blockSize) {
+		ensure(p, blockSize - counter);
+		if (p >= dataSize) {
+			break;
+		}
 
-		if (line[len - 1] == '\r') {
-			len--;
-			line.pop_back();
+		// Locate the records needed to fill the block. Sequences consisting
+		// of unknown symbols only are dropped; so more records may be needed.
+		std::vector<const char*> startList = findRecords(data + p,
+				blockSize - counter);
+		int n = startList.size() - 1;
+
+		// Parse and normalize the records in parallel
+		std::vector<Record> recordList(n);
+		std::vector<const char*> errorList(n, nullptr);
+		int workerNum = threadNum;
+#pragma omp parallel for schedule(dynamic, 16) num_threads(workerNum)
+		for (int i = 0; i < n; i++) {
+			errorList[i] = parseRecord(startList[i], startList[i + 1],
+					recordList[i]);
 		}
 
-		if (line[0] == '>') {
-			if (!isFirst) {
-				if (base->length() > maxLen) {
-					maxLen = base->length();
+		// Report the first invalid symbol in file order
+		for (int i = 0; i < n; i++) {
+			if (errorList[i] != nullptr) {
+				reportSymbol(startList[i], errorList[i], *recordList[i].first);
+				for (auto &r : recordList) {
+					delete r.first;
+					delete r.second;
 				}
+				delete b;
+				throw std::exception();
+			}
+		}
 
-				if (isAllInvalid(base)) {
-					delete info;
-					delete base;
-				} else {
-					base->shrink_to_fit();
-					b->push_back(make_pair(info, base));
-					counter++;
-				}
+		// Keep the original order
+		for (int i = 0; i < n; i++) {
+			string *info = recordList[i].first;
+			string *base = recordList[i].second;
+			if (base->length() > maxLen) {
+				maxLen = base->length();
+			}
 
-				if (counter < blockSize) {
-					info = new string(line);
-					base = new string("");
-					base->reserve(maxLen);
-				} else {
-					// Go back one line
-					in.seekg(-1 - len, in.cur);
-				}
+			if (recordList[i].segmentList.empty()) {
+				delete info;
+				delete base;
 			} else {
-				info = new string(line);
-				isFirst = false;
+				recordList[i].id = recordNum++;
+				b->push_back(std::move(recordList[i]));
+				counter++;
+				if (posList != nullptr) {
+					posList->push_back(
+							toCurrentPos(bufferStart + (startList[i] - data)));
+				}
 			}
-		} else {
-			// Convert non-traditional bases to traditional ones
-			for (int h = 0; h < len; h++) {
-				// Convert a char to upper case if needed
-				char &o = line[h];
-				if (o >= 97) {
-					line[h] = o - 32;
+		}
+
+		size_t next = startList[n] - data;
+		recordBytes = (next - p) / (double) n;
+		p = next;
+	}
+
+	// Record current position, i.e. the start of the next header
+	streamPos = bufferStart + p;
+	if (p >= dataSize && isStreamDone) {
+		isDone = true;
+		b->shrink_to_fit();
+	}
+	currentPos = toCurrentPos(streamPos);
+	discard(p);
+
+	return b;
+}
+
+/**
+ * Random access to the records is by seeking to each one. A plain file is
+ * mapped; so its records are parsed in parallel.
+ */
+Block* FastaReader::fetch(const vector<long int> &posList,
+		const vector<uint32_t> &idList) {
+	if (format == Format::GZIP) {
+		std::cerr << "FastaReader Error: " << std::endl;
+		std::cerr << "A gzip file has no random access: " << fileName;
+		std::cerr << std::endl;
+		throw std::exception();
+	}
+
+	int n = posList.size();
+	std::vector<Record> recordList(n);
+	auto clear = [&recordList]() {
+		for (auto &r : recordList) {
+			delete r.first;
+			delete r.second;
+		}
+	};
+
+	if (format == Format::PLAIN) {
+		for (int i = 0; i < n; i++) {
+			if (posList[i] < 0 || (size_t) posList[i] >= mapSize) {
+				std::cerr << "FastaReader Error: " << std::endl;
+				std::cerr << "Cannot move to position: " << posList[i];
+				std::cerr << std::endl;
+				throw std::exception();
+			}
+		}
+
+		std::vector<const char*> errorList(n, nullptr);
+		int workerNum = threadNum;
+#pragma omp parallel for schedule(dynamic, 16) num_threads(workerNum)
+		for (int i = 0; i < n; i++) {
+			const char *first = map + posList[i];
+			errorList[i] = parseRecord(first, skipRecord(first),
+					recordList[i]);
+		}
+
+		for (int i = 0; i < n; i++) {
+			if (errorList[i] != nullptr) {
+				reportSymbol(map + posList[i], errorList[i],
+						*recordList[i].first);
+				clear();
+				throw std::exception();
+			}
+		}
+	} else {
+		// The window is replaced by the next seek; so errors are reported
+		// right away
+		for (int i = 0; i < n; i++) {
+			seek(posList[i]);
+			size_t p = streamPos - bufferStart;
+			ensure(p, 1);
+			const char *error = parseRecord(data + p, skipRecord(data + p),
+					recordList[i]);
+			if (error != nullptr) {
+				reportSymbol(data + p, error, *recordList[i].first);
+				clear();
+				throw std::exception();
+			}
+		}
+	}
+
+	Block *b = new Block();
+	b->reserve(n);
+	for (int i = 0; i < n; i++) {
+		int len = recordList[i].second->length();
+		if (len > maxLen) {
+			maxLen = len;
+		}
+		recordList[i].id = idList[i];
+		b->push_back(std::move(recordList[i]));
+	}
+	return b;
+}
+
+bool FastaReader::canFetch() const {
+	return format != Format::GZIP;
+}
+
+void FastaReader::reportSymbol(const char *first, const char *c,
+		const string &header) const {
+	const char *lineStart = c;
+	while (lineStart > first && *(lineStart - 1) != '\n') {
+		lineStart--;
+	}
+	const char *lineEnd = findLineEnd(c);
+	std::cerr << "Something wrong with: " << header << std::endl;
+	std::cerr << "At this line: " << string(lineStart, lineEnd - lineStart)
+			<< std::endl;
+	std::cerr << "Invalid nucleotide symbol: (" << *c;
+	std::cerr << ")" << endl;
+}
+
+/**
+ * Find up to n records starting at the header p.
+ * The window is split into byte ranges, which are searched in parallel
+ * for headers at line starts. The returned list holds the start of each
+ * record followed by the end of the last one.
+ */
+std::vector<const char*> FastaReader::findRecords(const char *p, int n) {
+	const char *end = data + dataSize;
+	std::vector<const char*> r;
+	r.reserve(n + 1);
+	size_t recordNum = n;
+
+	// A quality line may start with '@'; so FASTQ records are walked in order
+	if (isFastq) {
+		const char *q = p;
+		while (q < end && r.size() < recordNum) {
+			r.push_back(q);
+			q = skipRecord(q);
+		}
+		r.push_back(q);
+		return r;
+	}
+
+	const char *first = p;
+	while (first < end && r.size() < recordNum) {
+		// A window of bytes expected to hold the needed records
+		size_t window = (recordNum - r.size()) * recordBytes * 1.25 + 65536;
+		const char *last =
+				(size_t) (end - first) > window ? first + window : end;
+
+		int chunkNum = threadNum;
+		size_t chunkSize = (last - first) / chunkNum + 1;
+		std::vector<std::vector<const char*> > chunkList(chunkNum);
+#pragma omp parallel for schedule(static) num_threads(chunkNum)
+		for (int c = 0; c < chunkNum; c++) {
+			const char *q = first + c * chunkSize;
+			const char *stop = q + chunkSize < last ? q + chunkSize : last;
+			// Move to the first line start in the chunk
+			if (q > data && q < stop && *(q - 1) != '\n') {
+				q = findLineEnd(q) + 1;
+			}
+			while (q < stop) {
+				if (*q == '>') {
+					chunkList[c].push_back(q);
 				}
+				q = findLineEnd(q) + 1;
+			}
+		}
 
-				char c = codeMap[o];
-				if (c != NOT) {
-					line[h] = c;
-				} else {
-					std::cerr << "Something wrong with: " << *info << std::endl;
-					std::cerr << "At this line: " << line << std::endl;
-					std::cerr << "Invalid nucleotide symbol: ("
-							<< (char) line[h];
-					std::cerr << ")" << endl;
-					throw std::exception();
+		for (auto &chunk : chunkList) {
+			for (const char *h : chunk) {
+				if (r.size() < recordNum) {
+					r.push_back(h);
 				}
 			}
+		}
+		first = last;
+	}
+
+	// The last record ends at the next header or at the end of the window
+	r.push_back(skipRecord(r.back()));
+
+	return r;
+}
+
+/**
+ * Returns the start of the record following the one starting at p,
+ * or the end of the window
+ */
+const char* FastaReader::skipRecord(const char *p) const {
+	const char *end = data + dataSize;
+	const char *q = findLineEnd(p) + 1;
 
-			base->append(line);
+	if (!isFastq) {
+		while (q < end && *q != '>') {
+			q = findLineEnd(q) + 1;
 		}
+		return q < end ? q : end;
 	}
-	// Record current position
-	currentPos = in.tellg();
 
-	// The file ended and the last sequence has not been added to
-	// the block
-	if (!in.good()) {
-		if (isAllInvalid(base)) {
-			delete info;
-			delete base;
-		} else {
-			base->shrink_to_fit();
-			b->push_back(make_pair(info, base));
+	// Sequence lines, a line starting with '+', then as many quality symbols
+	size_t seqLen = 0;
+	while (q < end && *q != '+') {
+		const char *lineEnd = findLineEnd(q);
+		seqLen += lineEnd - q;
+		if (lineEnd > q && *(lineEnd - 1) == '\r') {
+			seqLen--;
 		}
-		isDone = true;
-		b->shrink_to_fit();
+		q = lineEnd + 1;
+	}
+	if (q >= end) {
+		return end;
 	}
+	q = findLineEnd(q) + 1;
 
-	return b;
+	size_t qualityLen = 0;
+	do {
+		if (q >= end) {
+			return end;
+		}
+		const char *lineEnd = findLineEnd(q);
+		qualityLen += lineEnd - q;
+		if (lineEnd > q && *(lineEnd - 1) == '\r') {
+			qualityLen--;
+		}
+		q = lineEnd + 1;
+	} while (qualityLen < seqLen);
+
+	return q < end ? q : end;
 }
 
 /**
- * Check if the sequence consists of all unknown nucleotides or aa's
+ * Parse the record between first and last into a header (including '>')
+ * and a normalized sequence, which is allocated once.
+ * Returns the position of an invalid symbol or nullptr.
  */
-bool FastaReader::isAllInvalid(const string *base) {
-	bool r = true;
-	const char *arr = base->c_str();
-	int len = base->length();
+const char* FastaReader::parseRecord(const char *first, const char *last,
+		Record &record) {
+	const char *headerEnd = findLineEnd(first);
+	const char *headerLast = headerEnd;
+	if (headerLast > first && *(headerLast - 1) == '\r') {
+		headerLast--;
+	}
+	string *info = new string(first, headerLast - first);
+	if (isFastq) {
+		(*info)[0] = '>';
+	}
+
+	// Measure the sequence lines, which end at the '+' line of FASTQ
+	size_t seqLen = 0;
+	const char *q = headerEnd + 1;
+	while (q < last && !(isFastq && *q == '+')) {
+		const char *lineEnd = findLineEnd(q);
+		size_t len = lineEnd - q;
+		if (len > 0 && *(lineEnd - 1) == '\r') {
+			len--;
+		}
+		seqLen += len;
+		q = lineEnd + 1;
+	}
+	const char *seqLast = q < last ? q : last;
+
+	// Copy and normalize the sequence lines
+	string *base = new string(seqLen, '\0');
+	record.first = info;
+	record.second = base;
+
+	char *w = &(*base)[0];
+	int offset = 0;
+	int start = -1;
+	q = headerEnd + 1;
+	while (q < seqLast) {
+		const char *lineEnd = findLineEnd(q);
+		const char *lineLast = lineEnd;
+		if (lineLast > q && *(lineLast - 1) == '\r') {
+			lineLast--;
+		}
+		const char *error = normalize(q, lineLast, w + offset, offset, start,
+				record.segmentList);
+		if (error != nullptr) {
+			return error;
+		}
+		offset += lineLast - q;
+		q = lineEnd + 1;
+	}
+	if (start != -1) {
+		record.segmentList.push_back(make_pair(start, offset - 1));
+	}
+
+	return nullptr;
+}
+
+/**
+ * Returns the position of the new line character ending the line starting
+ * at p, or the end of the window.
+ */
+const char* FastaReader::findLineEnd(const char *p) const {
+	const char *end = data + dataSize;
+	const char *r = (const char*) memchr(p, '\n', end - p);
+	return r == nullptr ? end : r;
+}
+
+/**
+ * Convert a line to upper case and non-traditional bases to traditional ones
+ * in one pass, and extend the valid segments of the sequence.
+ * offset: The index of the first symbol of the line in the sequence.
+ * start: The start of the current valid segment or -1.
+ * Returns the position of an invalid symbol or nullptr.
+ */
+const char* FastaReader::normalize(const char *first, const char *last,
+		char *w, int offset, int &start, SegmentList &segmentList) const {
+	int len = last - first;
+	bool isValid = true;
 	for (int i = 0; i < len; i++) {
-		if (arr[i] != unknown) {
-			r = false;
-			break;
+		char m = normalMap[(unsigned char) first[i]];
+		w[i] = m;
+		isValid &= m != NOT;
+
+		if (m != unknown) {
+			if (start == -1) {
+				start = offset + i;
+			}
+		} else if (start != -1) {
+			segmentList.push_back(make_pair(start, offset + i - 1));
+			start = -1;
 		}
 	}
 
-	return r;
+	if (!isValid) {
+		for (int i = 0; i < len; i++) {
+			if (w[i] == NOT) {
+				return first + i;
+			}
+		}
+	}
+	return nullptr;
 }
 
 bool FastaReader::isStillReading() {
@@ -214,6 +867,10 @@ long int FastaReader::getCurrentPos() {
 	return currentPos;
 }
 
+uint64_t FastaReader::getRecordNum() {
+	return recordNum;
+}
+
 int FastaReader::getMaxLen() {
 	return maxLen;
 }
@@ -222,12 +879,14 @@ int FastaReader::getMaxLen() {
  * Start reading from the beginning of a file
  */
 void FastaReader::restart() {
-	currentPos = 0;
-	isDone = false;
-	in.clear();
-	in.seekg(currentPos);
+	seek(0);
+	recordNum = 0;
 }
 
 void FastaReader::setBlockSize(int newBlockSize) {
 	blockSize = newBlockSize;
 }
+
+void FastaReader::setThreadNum(int newThreadNum) {
+	threadNum = newThreadNum < 1 ? 1 : newThreadNum;
+}
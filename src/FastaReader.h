@@ -30,39 +30,148 @@
 #include <vector>
 #include <algorithm> // for_each
 #include <stdio.h> // fread
+#include <cstring> // memchr
+#include <cctype> // isspace
+#include <sys/mman.h> // mmap
+#include <sys/stat.h> // fstat
+#include <fcntl.h> // open
+#include <unistd.h> // close
+#include <zlib.h> // gzip and BGZF
+#include <atomic>
 
 #include "Parameters.h"
+#include "Util.h"
 
 using namespace std;
 
-typedef vector<pair<string*, string*> > Block;
+/**
+ * A header (first), a normalized sequence (second), and the valid segments
+ * of the sequence found while normalizing it. The segment list is empty if
+ * the record was not made by FastaReader.
+ */
+struct Record: public pair<string*, string*> {
+	SegmentList segmentList;
+
+	Record() :
+			pair<string*, string*>(nullptr, nullptr) {
+	}
+
+	Record(const pair<string*, string*> &p) :
+			pair<string*, string*>(p) {
+	}
+
+	// The number of the record in its file (all-unknown sequences are not
+	// counted), which matches the record number in FastaIndex
+	uint32_t id = 0;
+};
+
+typedef vector<Record> Block;
 
 class FastaReader {
 private:
+	// Formats of the input file
+	enum Format {
+		PLAIN, GZIP, BGZF
+	};
+
 	int blockSize;
 	string fileName;
-	ifstream in;
 	int maxLen;
 
+	// The file is memory-mapped
+	int fd;
+	const char *map;
+	size_t mapSize;
+	Format format;
+	// Records are in FASTQ format (the quality lines are skipped)
+	bool isFastq;
+
+	// The window of (decompressed) bytes being parsed in place.
+	// It is the mapped file itself if the file is not compressed.
+	const char *data;
+	size_t dataSize;
+	// Decompressed bytes and the stream offset of the first one
+	string buffer;
+	uint64_t bufferStart;
+	// The window reaches the end of the input
+	bool isStreamDone;
+	// Stream offset of the next record
+	uint64_t streamPos;
+
+	// gzip state
+	z_stream *zs;
+	size_t zPos;
+
+	// BGZF state: the next block to decompress and the (compressed offset,
+	// stream offset) of each block in the buffer
+	size_t bgzfPos;
+	vector<pair<uint64_t, uint64_t> > bgzfList;
+
+	// Threads used for parsing a block. It may be changed by another thread
+	// while a block is being read.
+	std::atomic<int> threadNum;
+	// Average bytes per record seen so far
+	double recordBytes;
+
 	bool isDone;
 	long int currentPos;
+	// The number of the next record
+	uint64_t recordNum;
 	char unknown;
 	char codeMap[128];
+	// Maps a byte to its normalized (upper case, traditional) base or NOT
+	char normalMap[256];
 	const char NOT = '!';
-
-	bool isAllInvalid(const string*);
+	const char* findLineEnd(const char*) const;
+	const char* skipRecord(const char*) const;
+	const char* normalize(const char*, const char*, char*, int, int&,
+			SegmentList&) const;
+	const char* parseRecord(const char*, const char*, Record&);
+	void reportSymbol(const char*, const char*, const string&) const;
+	vector<const char*> findRecords(const char*, int);
+
+	void seek(long int);
+	bool fill();
+	void fillGzip();
+	void fillBgzf();
+	void ensure(size_t, int);
+	void discard(size_t);
+	long int toCurrentPos(uint64_t) const;
 
 public:
-	FastaReader(string, int, long int currentPosIn = 0, int maxLenIn = 0);
+	FastaReader(string, int, long int currentPosIn = 0, int maxLenIn = 0,
+			uint64_t recordNumIn = 0);
+	FastaReader(const FastaReader&) = delete;
+	FastaReader& operator=(const FastaReader&) = delete;
 	virtual ~FastaReader();
-	Block* read();
+	/**
+	 * Read the next block. The position of each record in the block is
+	 * appended to the optional list.
+	 */
+	Block* read(vector<long int> *posList = nullptr);
+	/**
+	 * Read the records at the positions (see getCurrentPos), e.g. found by
+	 * FastaIndex, and number them by the id list. The block keeps the order
+	 * of the lists. The position of the next read is lost.
+	 */
+	Block* fetch(const vector<long int>&, const vector<uint32_t>&);
+	/**
+	 * False for a gzip file, which has no random access
+	 */
+	bool canFetch() const;
 	//Block * fRead();
 	static void deleteBlock(Block*);
 	bool isStillReading();
+	/**
+	 * The position of the next record: a byte offset for plain and gzip
+	 * files (uncompressed) or a virtual offset for BGZF files
+	 */
 	long int getCurrentPos();
+	uint64_t getRecordNum();
 	int getMaxLen();
 	void restart();
 	void setBlockSize(int);
+	void setThreadNum(int);
 };
 
 #endif /* FASTAREADER_H_ */
@@ -35,9 +35,12 @@
  */
 GLM::GLM(const Matrix &f, const Matrix &l, output fun) {
 	o = fun;
-	Matrix t = ~f;
-	Matrix s = t * f;
-	weights = s.pseudoInverse() * t * l;
+	// Solve the normal equations by Cholesky. If the features are
+	// (nearly) linearly dependent, solve the least squares problem by QR.
+	Matrix s = f.gram();
+	if (!s.solveCholesky(f.transposeTimes(l), weights)) {
+		weights = f.solveLeastSquares(l);
+	}
 }
 
 GLM::GLM(GLM &other) {
@@ -65,22 +68,26 @@ Matrix GLM::getWeights() const {
 	return weights;
 }
 
+double GLM::classifierOutput(double x) {
+	return x >= 0.5 ? 1.0 : 0.0;
+}
+
+double GLM::regressorOutput(double x) {
+	return x;
+}
+
 /**
  * Makes a GLM instance with a binary output function for classification
  */
 GLM GLM::classifierFactory(const Matrix &f, const Matrix &l) {
-	return GLM(f, l, [](double x) {
-		return x >= 0.5 ? 1.0 : 0.0;
-	});
+	return GLM(f, l, classifierOutput);
 }
 
 /**
  * Makes a GLM instance with a linear output function for regression
  */
 GLM GLM::regressorFactory(const Matrix &f, const Matrix &l) {
-	return GLM(f, l, [](double x) {
-		return x;
-	});
+	return GLM(f, l, regressorOutput);
 }
 
 /**
@@ -89,9 +96,7 @@ GLM GLM::regressorFactory(const Matrix &f, const Matrix &l) {
  * to free its memory.
  */
 GLM* GLM::classifierFactoryHeap(const Matrix &f, const Matrix &l) {
-	return new GLM(f, l, [](double x) {
-		return x >= 0.5 ? 1.0 : 0.0;
-	});
+	return new GLM(f, l, classifierOutput);
 }
 
 /**
@@ -100,9 +105,7 @@ GLM* GLM::classifierFactoryHeap(const Matrix &f, const Matrix &l) {
  * to free its memory.
  */
 GLM* GLM::regressorFactoryHeap(const Matrix &f, const Matrix &l) {
-	return new GLM(f, l, [](double x) {
-		return x;
-	});
+	return new GLM(f, l, regressorOutput);
 }
 
 std::vector<Feature*> GLM::getFeatureList() {
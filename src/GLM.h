@@ -47,6 +47,10 @@ public:
 
 	virtual std::vector<Feature*> getFeatureList();
 
+	// Output functions of a classifier (0 or 1) and of a regression model
+	static double classifierOutput(double);
+	static double regressorOutput(double);
+
 	static GLM classifierFactory(const Matrix &f, const Matrix &l);
 	static GLM regressorFactory(const Matrix &f, const Matrix &l);
 
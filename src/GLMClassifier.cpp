@@ -23,19 +23,30 @@
 #include "GLMClassifier.h"
 
 GLMClassifier::GLMClassifier(const Matrix *f, const Matrix *l, double t, int c,
-		int m, double b) :
+		int m, double b, const std::vector<int> &statList) :
 		fModelTable(f), lModelTable(l), threshold(t), threadNum(c), minFeat(m), balance(
 				b) {
-	pipe = new std::vector<ITransformer*>();
-
 	auto info = StatisticInfo::getInstance();
 	std::vector<Feature*> *oList = info->getList();
+	int s = statList.empty() ? oList->size() : statList.size();
+	if (!statList.empty() && f->getNumCol() == (int) oList->size()) {
+		candidateTable = f->subMatrixByCol(statList.data(), s);
+		fModelTable = &candidateTable;
+	} else if (f->getNumCol() != s) {
+		std::cerr << "GLMClassifier error: " << std::endl;
+		std::cerr << "Column number does not match statistic number.";
+		std::cerr << std::endl;
+		throw std::exception();
+	}
+
+	pipe = new std::vector<ITransformer*>();
+
 	// Make a copy of the feature list
 	fList = new std::vector<Feature*>();
-	int s = oList->size();
 	fList->reserve(s);
 	for (int i = 0; i < s; i++) {
-		auto f = new Feature(*oList->at(i));
+		auto f = new Feature(
+				*oList->at(statList.empty() ? i : statList.at(i)));
 		f->setTableIndex(i);
 		fList->push_back(f);
 	}
@@ -165,15 +176,14 @@ void GLMClassifier::prepareData() {
 	std::cout << "\tValidation size: " << v << std::endl;
 }
 
-pair<Matrix, std::vector<Feature*> > GLMClassifier::selectFeatures(Matrix &t4,
-		std::vector<Feature*> &f4) {
+pair<Matrix, std::vector<Feature*> > GLMClassifier::selectFeatures(
+		ExpandedTable &t4) {
 	// Better if results in 0.1% increase in accuracy
 	auto isNewBetter = [](double newV, double oldV) {
 		return (newV - oldV > 0.001) ? true : false;
 	};
-	BestFirst < GLM
-			> selector(t4, *lTrainTable, f4, GLM::classifierFactory,
-					Evaluator::acc, isNewBetter, true, threadNum, minFeat);
+	BestFirst selector(t4, *lTrainTable, GLM::classifierOutput, Evaluator::acc,
+			isNewBetter, true, threadNum, minFeat);
 	return std::make_pair(selector.transform(t4), selector.getFeatureList());
 }
 
@@ -206,33 +216,14 @@ void GLMClassifier::clean(std::vector<Feature*> &list) {
  * Train and optimize the pipeline
  */
 void GLMClassifier::train() {
-	Normalizer normalizer1(*fTrainTable, *fList);
-	Matrix t1 = normalizer1.transform(*fTrainTable);
-	std::vector<Feature*> f1 = normalizer1.getFeatureList();
-
-	SimConverter sim(t1, f1);
-	Matrix t2 = sim.transform(t1);
-	std::vector<Feature*> f2 = sim.getFeatureList();
-	clean(f1);
-
-	FeatureExpander expander(t2, f2);
-	Matrix t3 = expander.transform(t2);
-	std::vector<Feature*> f3 = expander.getFeatureList();
-	clean(f2);
-
-	Normalizer normalizer2(t3, f3);
-	Matrix t4 = normalizer2.transform(t3);
-	std::vector<Feature*> f4 = normalizer2.getFeatureList();
-	clean(f3);
-
-	auto p5 = selectFeatures(t4, f4);
+	// Normalizer, SimConverter, FeatureExpander, and Normalizer; expanded
+	// columns are made when they are needed
+	ExpandedTable t4(*fTrainTable, *fList, threadNum);
 
-	// auto p5 = selectFeatures(t2, f2); // No squared or paired statistics
+	auto p5 = selectFeatures(t4);
 
 	auto t5 = p5.first;
 	f5 = p5.second;
-	// clean(f2); // No squared or paired statistics
-	clean(f4);
 
 	auto p6 = trainGLM(t5);
 	auto t6 = p6.first;
@@ -283,7 +274,7 @@ void GLMClassifier::train() {
 		}
 	}
 
-	pipe->push_back(new BestFirst<GLM>(f5));
+	pipe->push_back(new BestFirst(f5));
 	pipe->push_back(glm);
 
 	// For now. If it works move to GLM
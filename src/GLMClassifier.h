@@ -30,6 +30,7 @@
 #include "Normalizer.h"
 #include "SimConverter.h"
 #include "FeatureExpander.h"
+#include "ExpandedTable.h"
 #include "GLM.h"
 #include "BestFirst.h"
 #include "Evaluator.h"
@@ -50,6 +51,8 @@ private:
 protected:
 	const Matrix *fModelTable;
 	const Matrix *lModelTable;
+	// The columns of the candidate statistics of a table of all statistics
+	Matrix candidateTable;
 
 	Matrix *fTrainTable;
 	Matrix *fValidateTable;
@@ -70,8 +73,8 @@ protected:
 	std::vector<int> indexList;
 
 	// These methods should be overridden in the regressor
-	virtual pair<Matrix, std::vector<Feature*> > selectFeatures(Matrix&,
-			std::vector<Feature*>&);
+	virtual pair<Matrix, std::vector<Feature*> > selectFeatures(
+			ExpandedTable&);
 	virtual pair<Matrix, GLM*> trainGLM(Matrix&);
 
 	virtual void prepareData();
@@ -82,8 +85,14 @@ protected:
 	void clean(std::vector<Feature*>&);
 
 public:
+	/**
+	 * statList: the positions (in StatisticInfo) of the statistics in the
+	 * columns of the table; all statistics if empty. If the table has a
+	 * column per statistic, only the ones in statList are candidates.
+	 */
 	GLMClassifier(const Matrix*, const Matrix*, double, int, int,
-			double b = 1.0);
+			double b = 1.0, const std::vector<int> &statList =
+					std::vector<int>());
 	virtual ~GLMClassifier();
 	virtual void start();
 
@@ -22,6 +22,10 @@
 
 #include "GLMPredictor.h"
 
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
 GLMPredictor::GLMPredictor() {
 	canDelete = false;
 }
@@ -116,9 +120,83 @@ GLMPredictor::GLMPredictor(std::vector<Feature*> &featList, bool mode) {
 		}
 	}
 
+	makeBound();
+
 	canDelete = true;
 }
 
+void GLMPredictor::makeBound() {
+	isDistList = new bool[featNum];
+	std::fill(isDistList, isDistList + featNum, false);
+	for (int i = 0; i < distNum; i++) {
+		isDistList[distIndexList[i]] = true;
+	}
+
+	// The singles of each selected feature
+	std::vector<std::vector<int> > compList(selectNum);
+	std::vector<double> creditList(singleFeatNum, 0.0);
+	for (int s = 0; s < selectNum; s++) {
+		std::vector<int> &l = compList[s];
+		std::vector<int> stack(1, selectedIndexList[s]);
+		while (!stack.empty()) {
+			int i = stack.back();
+			stack.pop_back();
+			if (i < singleFeatNum) {
+				l.push_back(i);
+			} else {
+				stack.push_back(expList[i].first);
+				stack.push_back(expList[i].second);
+			}
+		}
+		std::sort(l.begin(), l.end());
+		l.erase(std::unique(l.begin(), l.end()), l.end());
+		for (int c : l) {
+			creditList[c] += std::fabs(wList[s]) / l.size();
+		}
+	}
+
+	// Singles taking part in larger weights first
+	orderList = new int[singleFeatNum];
+	for (int i = 0; i < singleFeatNum; i++) {
+		orderList[i] = i;
+	}
+	std::stable_sort(orderList, orderList + singleFeatNum,
+			[&creditList](int a, int b) {
+				return creditList[a] > creditList[b];
+			});
+	std::vector<int> positionList(singleFeatNum);
+	for (int j = 0; j < singleFeatNum; j++) {
+		positionList[orderList[j]] = j;
+	}
+
+	// A selected feature is known after its last single is calculated
+	std::vector<int> stepList(selectNum, 0);
+	stepStartList = new int[singleFeatNum + 1];
+	std::fill(stepStartList, stepStartList + singleFeatNum + 1, 0);
+	for (int s = 0; s < selectNum; s++) {
+		for (int c : compList[s]) {
+			stepList[s] = std::max(stepList[s], positionList[c]);
+		}
+		stepStartList[stepList[s] + 1]++;
+	}
+	for (int j = 0; j < singleFeatNum; j++) {
+		stepStartList[j + 1] += stepStartList[j];
+	}
+	boundIndexList = new int[selectNum];
+	std::vector<int> fillList(stepStartList, stepStartList + singleFeatNum);
+	for (int s = 0; s < selectNum; s++) {
+		boundIndexList[fillList[stepList[s]]++] = s;
+	}
+
+	restList = new double[singleFeatNum];
+	std::fill(restList, restList + singleFeatNum, 0.0);
+	for (int s = 0; s < selectNum; s++) {
+		for (int j = 0; j < stepList[s]; j++) {
+			restList[j] += std::max(wList[s], 0.0);
+		}
+	}
+}
+
 GLMPredictor::GLMPredictor(const GLMPredictor &o) {
 	copy(o);
 }
@@ -154,10 +232,22 @@ void GLMPredictor::copy(const GLMPredictor &o) {
 
 	wList = new double[selectNum];
 	selectedIndexList = new int[selectNum];
+	boundIndexList = new int[selectNum];
 	for (int i = 0; i < selectNum; i++) {
 		wList[i] = o.wList[i];
 		selectedIndexList[i] = o.selectedIndexList[i];
+		boundIndexList[i] = o.boundIndexList[i];
 	}
+
+	isDistList = new bool[featNum];
+	std::copy(o.isDistList, o.isDistList + featNum, isDistList);
+	orderList = new int[singleFeatNum];
+	std::copy(o.orderList, o.orderList + singleFeatNum, orderList);
+	restList = new double[singleFeatNum];
+	std::copy(o.restList, o.restList + singleFeatNum, restList);
+	stepStartList = new int[singleFeatNum + 1];
+	std::copy(o.stepStartList, o.stepStartList + singleFeatNum + 1,
+			stepStartList);
 }
 
 GLMPredictor::~GLMPredictor() {
@@ -168,6 +258,106 @@ GLMPredictor::~GLMPredictor() {
 		delete[] wList;
 		delete[] expList;
 		delete[] selectedIndexList;
+		delete[] isDistList;
+		delete[] orderList;
+		delete[] stepStartList;
+		delete[] boundIndexList;
+		delete[] restList;
+	}
+}
+
+bool GLMPredictor::canBound() const {
+	return !isClassification;
+}
+
+const int* GLMPredictor::getOrderList() const {
+	return orderList;
+}
+
+/**
+ * The same steps as the one-pair method, each one applied to a batch of
+ * pairs, so the inner loops run over pairs and vectorize
+ */
+void GLMPredictor::calculateIdentity(const double *statTable, int n,
+		double *out) const {
+	if (n <= 0) {
+		return;
+	}
+	int batch = std::min(n, BATCH);
+	double work[featNum * batch];
+
+	for (int start = 0; start < n; start += batch) {
+		int size = std::min(batch, n - start);
+
+		// Normalize and trim singles
+		for (int i = 0; i < singleFeatNum; i++) {
+			const double *in = statTable + (int64_t) i * n + start;
+			double *x = work + i * batch;
+			double min = minList[i];
+			double maxMin = maxMinList[i];
+#pragma omp simd
+			for (int p = 0; p < size; p++) {
+				double d = (in[p] - min) / maxMin;
+				d = d > 1.0 ? 1.0 : d;
+				d = d < 0.0 ? 0.0 : d;
+				x[p] = d;
+			}
+		}
+
+		// Convert distances to similarities
+		for (int i = 0; i < distNum; i++) {
+			double *x = work + distIndexList[i] * batch;
+#pragma omp simd
+			for (int p = 0; p < size; p++) {
+				x[p] = 1 - x[p];
+			}
+		}
+
+		// Expand
+		for (int i = singleFeatNum; i < featNum; i++) {
+			const double *a = work + expList[i].first * batch;
+			const double *b = work + expList[i].second * batch;
+			double *x = work + i * batch;
+#pragma omp simd
+			for (int p = 0; p < size; p++) {
+				x[p] = a[p] * b[p];
+			}
+		}
+
+		// Normalize and trim squares and pairs
+		for (int i = singleFeatNum; i < featNum; i++) {
+			double *x = work + i * batch;
+			double min = minList[i];
+			double maxMin = maxMinList[i];
+#pragma omp simd
+			for (int p = 0; p < size; p++) {
+				double d = (x[p] - min) / maxMin;
+				d = d > 1.0 ? 1.0 : d;
+				d = d < 0.0 ? 0.0 : d;
+				x[p] = d;
+			}
+		}
+
+		// Calculate identity
+		double *res = out + start;
+#pragma omp simd
+		for (int p = 0; p < size; p++) {
+			res[p] = bias;
+		}
+		for (int i = 0; i < selectNum; i++) {
+			const double *x = work + selectedIndexList[i] * batch;
+			double w = wList[i];
+#pragma omp simd
+			for (int p = 0; p < size; p++) {
+				res[p] += w * x[p];
+			}
+		}
+
+		if (isClassification) {
+			for (int p = 0; p < size; p++) {
+				res[p] = res[p] >= 0.5 ? 1.0 : 0.0;
+			}
+		}
 	}
 }
 
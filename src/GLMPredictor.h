@@ -46,7 +46,57 @@ private:
 	double *wList;
 	std::pair<int, int> *expList;
 
+	/**
+	 * The score is at most the bias, plus the terms of the known features,
+	 * plus the positive weights of the unknown ones; a feature is in [0, 1].
+	 * Singles are calculated in order of the weights they take part in.
+	 * The selected features known after a step are listed from
+	 * stepStartList[step]; restList[step] is the sum of the positive weights
+	 * of the features known later.
+	 */
+	bool *isDistList;
+	int *orderList;
+	int *stepStartList;
+	int *boundIndexList;
+	double *restList;
+
 	void copy(const GLMPredictor&);
+	void makeBound();
+
+	/**
+	 * The value of a feature as calculateIdentity computes it
+	 */
+	inline double single(const double *data, int i) const {
+		double d = (data[i] - minList[i]) / maxMinList[i];
+		if (d > 1.0) {
+			d = 1.0;
+		}
+		if (d < 0.0) {
+			d = 0.0;
+		}
+		return isDistList[i] ? 1 - d : d;
+	}
+
+	inline double expand(const double *data, int i) const {
+		if (i < singleFeatNum) {
+			return single(data, i);
+		}
+		return expand(data, expList[i].first) * expand(data, expList[i].second);
+	}
+
+	inline double value(const double *data, int i) const {
+		if (i < singleFeatNum) {
+			return single(data, i);
+		}
+		double d = (expand(data, i) - minList[i]) / maxMinList[i];
+		if (d > 1.0) {
+			d = 1.0;
+		}
+		if (d < 0.0) {
+			d = 0.0;
+		}
+		return d;
+	}
 
 public:
 	GLMPredictor();
@@ -56,6 +106,11 @@ public:
 
 	GLMPredictor& operator=(const GLMPredictor&);
 
+	// The largest number of pairs processed together by the batch method
+	static constexpr int BATCH = 256;
+	// Covers rounding in a different order of the terms of the bound
+	static constexpr double BOUND_MARGIN = 1e-9;
+
 	inline double calculateIdentity(double *data) {
 		// Normalize and trim singles
 		for (int i = 0; i < singleFeatNum; i++) {
@@ -106,6 +161,60 @@ public:
 		return res;
 	}
 
+	/**
+	 * Score n pairs at once. The statistics are stored by feature (SoA):
+	 * the i-th statistic of the p-th pair is at statTable[i * n + p].
+	 * The input is not changed; the scores are written to out.
+	 */
+	void calculateIdentity(const double *statTable, int n, double *out) const;
+
+	/**
+	 * True if the bound applies, i.e. the score is not a class
+	 */
+	bool canBound() const;
+
+	/**
+	 * The indexes of the singles in the order they should be calculated
+	 */
+	const int* getOrderList() const;
+
+	/**
+	 * The largest score possible after the singles up to a step (in the
+	 * order of getOrderList) are calculated. Known is 0 before step 0; it
+	 * accumulates the terms of the known features.
+	 */
+	inline double bound(const double *data, int step, double &known) const {
+		for (int q = stepStartList[step]; q < stepStartList[step + 1]; q++) {
+			int s = boundIndexList[q];
+			known += wList[s] * value(data, selectedIndexList[s]);
+		}
+		return bias + known + restList[step];
+	}
+
+	/**
+	 * Calculate the singles of a pair by a statistician. If a minimum is
+	 * given, they are calculated in the order of the bound, which stops as
+	 * soon as the score cannot reach the minimum; then false is returned.
+	 */
+	template<class S>
+	bool calculateBounded(S &s, const int *funIndexArray, double minimum,
+			double *data) const {
+		if (minimum <= 0.0 || !canBound()) {
+			s.calculate(funIndexArray, singleFeatNum, data);
+			return true;
+		}
+
+		double known = 0.0;
+		for (int j = 0; j < singleFeatNum; j++) {
+			int i = orderList[j];
+			data[i] = s.calculate(funIndexArray[i]);
+			if (bound(data, j, known) + BOUND_MARGIN < minimum) {
+				return false;
+			}
+		}
+		return true;
+	}
+
 	int getFeatNum() const;
 	int* getFunIndexArray() const;
 	int getSingleFeatNum() const;
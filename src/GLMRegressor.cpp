@@ -23,8 +23,8 @@
 #include "GLMRegressor.h"
 
 GLMRegressor::GLMRegressor(const Matrix *f, const Matrix *l, double t, int c,
-		int m) :
-		GLMClassifier(f, l, t, c, m) {
+		int m, const std::vector<int> &statList) :
+		GLMClassifier(f, l, t, c, m, 1.0, statList) {
 }
 
 GLMRegressor::~GLMRegressor() {
@@ -94,14 +94,14 @@ void GLMRegressor::prepareData() {
 	std::cout << "\tValidation size: " << v << std::endl;
 }
 
-pair<Matrix, std::vector<Feature*> > GLMRegressor::selectFeatures(Matrix &t4,
-		std::vector<Feature*> &f4) {
+pair<Matrix, std::vector<Feature*> > GLMRegressor::selectFeatures(
+		ExpandedTable &t4) {
 
 	auto isNewBetter = [](double newV, double oldV) {
 		return (oldV - newV > 0.000025) ? true : false; // Original
 	};
 
-	BestFirst<GLM> selector(t4, *lTrainTable, f4, GLM::regressorFactory,
+	BestFirst selector(t4, *lTrainTable, GLM::regressorOutput,
 			Evaluator::mse, isNewBetter, false, threadNum, minFeat,
 			std::numeric_limits<double>::infinity());
 
@@ -46,13 +46,17 @@ private:
 protected:
 	virtual void prepareData();
 
-	virtual pair<Matrix, std::vector<Feature*> > selectFeatures(Matrix&,
-			std::vector<Feature*>&);
+	virtual pair<Matrix, std::vector<Feature*> > selectFeatures(
+			ExpandedTable&);
 
 	virtual pair<Matrix, GLM*> trainGLM(Matrix&);
 
 public:
-	GLMRegressor(const Matrix*, const Matrix*, double, int, int);
+	/**
+	 * statList: the candidate statistics (see GLMClassifier)
+	 */
+	GLMRegressor(const Matrix*, const Matrix*, double, int, int,
+			const std::vector<int> &statList = std::vector<int>());
 	virtual ~GLMRegressor();
 
 	virtual void evaluate(Matrix &o, Matrix &p);
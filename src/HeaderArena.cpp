@@ -0,0 +1,83 @@
+/*
+ Identity 2.0 calculates DNA sequence identity scores rapidly without alignment.
+
+ Copyright (C) 2020-2022 Hani Z. Girgis, PhD
+
+ Academic use: Affero General Public License version 1.
+
+ Any restrictions to use for-profit or non-academics: Alternative commercial license is needed.
+
+ This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+ Please contact Dr. Hani Z. Girgis (hzgirgis@buffalo.edu) if you need more information.
+ */
+
+
+/*
+ * HeaderArena.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Hani Z. Girgis, PhD
+ */
+
+#include "HeaderArena.h"
+
+#include <iostream>
+#include <algorithm>
+#include <cstring>
+
+HeaderArena::HeaderArena() {
+	used = 0;
+	capacity = 0;
+}
+
+HeaderArena::~HeaderArena() {
+	clear();
+}
+
+void HeaderArena::add(uint32_t id, std::string_view header) {
+	if (id != startList.size()) {
+		std::cerr << "HeaderArena error: Expected the header of sequence ";
+		std::cerr << startList.size() << ", but received the one of ";
+		std::cerr << id << "." << std::endl;
+		throw std::exception();
+	}
+	add(header);
+}
+
+void HeaderArena::add(std::string_view header) {
+	size_t len = header.size();
+	if (chunkList.empty() || used + len > capacity) {
+		capacity = std::max(CHUNK_SIZE, len);
+		chunkList.push_back(new char[capacity]);
+		used = 0;
+	}
+
+	char *start = chunkList.back() + used;
+	if (len > 0) {
+		memcpy(start, header.data(), len);
+	}
+	used += len;
+	startList.push_back(start);
+	lengthList.push_back(len);
+}
+
+std::string_view HeaderArena::get(uint32_t id) const {
+	return std::string_view(startList.at(id), lengthList[id]);
+}
+
+uint64_t HeaderArena::size() const {
+	return startList.size();
+}
+
+void HeaderArena::clear() {
+	for (char *chunk : chunkList) {
+		delete[] chunk;
+	}
+	chunkList.clear();
+	startList.clear();
+	lengthList.clear();
+	used = 0;
+	capacity = 0;
+}
@@ -0,0 +1,71 @@
+/*
+ Identity 2.0 calculates DNA sequence identity scores rapidly without alignment.
+
+ Copyright (C) 2020-2022 Hani Z. Girgis, PhD
+
+ Academic use: Affero General Public License version 1.
+
+ Any restrictions to use for-profit or non-academics: Alternative commercial license is needed.
+
+ This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+ Please contact Dr. Hani Z. Girgis (hzgirgis@buffalo.edu) if you need more information.
+ */
+
+
+/*
+ * HeaderArena.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Hani Z. Girgis, PhD
+ *     Purpose: Stores the headers of one input file once. The characters of
+ *     the headers are appended to large chunks, which are never moved; so a
+ *     header costs its characters and 12 bytes, instead of a heap-allocated
+ *     string. A header is referred to by the 32-bit id of its sequence (see
+ *     Record::id) and resolved to text only when results are written.
+ */
+
+#ifndef SRC_HEADERARENA_H_
+#define SRC_HEADERARENA_H_
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+
+class HeaderArena {
+private:
+	std::vector<char*> chunkList;
+	// Bytes used in the last chunk and its capacity
+	size_t used;
+	size_t capacity;
+	std::vector<const char*> startList;
+	std::vector<uint32_t> lengthList;
+
+public:
+	// The size of a chunk; a longer header gets a chunk of its own
+	static constexpr size_t CHUNK_SIZE = 1 << 24;
+
+	HeaderArena();
+	HeaderArena(const HeaderArena&) = delete;
+	HeaderArena& operator=(const HeaderArena&) = delete;
+	virtual ~HeaderArena();
+
+	/**
+	 * Append the header of the next sequence. Headers are added in the
+	 * order of their ids; so the id must equal the number of headers.
+	 */
+	void add(uint32_t, std::string_view);
+	void add(std::string_view);
+
+	/**
+	 * The view is valid as long as the arena is
+	 */
+	std::string_view get(uint32_t) const;
+
+	uint64_t size() const;
+	void clear();
+};
+
+#endif /* SRC_HEADERARENA_H_ */
@@ -25,7 +25,13 @@
 #include <thread>
 
 #include "Util.h"
+#include "Parameters.h"
+#include "ThreadTuner.h"
 #include "ReaderAlignerCoordinator.h"
+#include "PairWriter.h"
+#include "ScoreMatrix.h"
+#include "OutputWriter.h"
+#include "OutputShards.h"
 
 const char *agplv1 =
 		R"(AFFERO GENERAL PUBLIC LICENSE
@@ -106,6 +112,34 @@ TERMS AND CONDITIONS FOR COPYING, DISTRIBUTION AND MODIFICATION
     12. IN NO EVENT UNLESS REQUIRED BY APPLICABLE LAW OR AGREED TO IN WRITING WILL ANY COPYRIGHT HOLDER, OR ANY OTHER PARTY WHO MAY MODIFY AND/OR REDISTRIBUTE THE PROGRAM AS PERMITTED ABOVE, BE LIABLE TO YOU FOR DAMAGES, INCLUDING ANY GENERAL, SPECIAL, INCIDENTAL OR CONSEQUENTIAL DAMAGES ARISING OUT OF THE USE OR INABILITY TO USE THE PROGRAM (INCLUDING BUT NOT LIMITED TO LOSS OF DATA OR DATA BEING RENDERED INACCURATE OR LOSSES SUSTAINED BY YOU OR THIRD PARTIES OR A FAILURE OF THE PROGRAM TO OPERATE WITH ANY OTHER PROGRAMS), EVEN IF SUCH HOLDER OR OTHER PARTY HAS BEEN ADVISED OF THE POSSIBILITY OF SUCH DAMAGES.)";
 
 int main(int argc, char *argv[]) {
+	// Convert a binary output file to text
+	if (argc == 4 && std::string(argv[1]) == "convert") {
+		PairWriter::convert(argv[2], argv[3]);
+		return 0;
+	}
+
+	// Merge the shards listed in a manifest into one sorted file
+	if (argc == 4 && std::string(argv[1]) == "merge") {
+		OutputShards::merge(argv[2], argv[3]);
+		return 0;
+	}
+
+	// Convert a matrix file to Phylip or NumPy
+	if (argc == 5 && std::string(argv[1]) == "matrix") {
+		std::string format(argv[4]);
+		ScoreMatrix matrix(argv[2]);
+		if (format == "phylip") {
+			matrix.writePhylip(argv[3], ThreadTuner::countAvailableCores());
+		} else if (format == "npy") {
+			matrix.writeNpy(argv[3]);
+		} else {
+			std::cerr << "Error: The matrix format must be phylip or npy."
+					<< std::endl;
+			return 1;
+		}
+		return 0;
+	}
+
 	std::cout << std::endl;
 	std::cout << "Identity 1.2 is developed by Hani Z. Girgis, PhD."
 			<< std::endl;
@@ -158,8 +192,9 @@ int main(int argc, char *argv[]) {
 	if (argc == 1 || (argc == 2 && argv[1][1] == 'h')) {
 		std::cout << "List of parameters:" << std::endl;
 		// Required parameters
-		std::cout << "\t-d: Required. Database file in FASTA format."
+		std::cout << "\t-d: Required. Database file in FASTA or FASTQ format. It may be"
 				<< std::endl;
+		std::cout << "\t    compressed by gzip or bgzip." << std::endl;
 		std::cout
 				<< "\t-t: Required. Threshold identity score (between 0 & 0.99), below which pairs are not reported."
 				<< std::endl;
@@ -169,6 +204,9 @@ int main(int argc, char *argv[]) {
 				<< "\t-o: Optional. Output file. Each line has 3 tab-separated fields (>header1    >header2    score)."
 				<< std::endl << "\t    If not provided, the -s option must be used."
 				<< std::endl;
+		std::cout
+				<< "\t    If the name ends with .gz, the output is compressed by gzip while it is written."
+				<< std::endl;
 
 		std::cout
 				<< "\t-a: Optional. Report identity scores for all pairs including those below the threshold -- y"
@@ -178,28 +216,71 @@ int main(int argc, char *argv[]) {
 				<< std::endl;
 
 		std::cout
-				<< "\t    This option should be used if you desire constructing a phylogenetic tree. You may use the"
+				<< "\t    This option should be used if you desire constructing a phylogenetic tree (see -m)."
+				<< std::endl;
+
+		std::cout
+				<< "\t-b: Optional. Write the output in a compact binary format -- y (yes) or n (no). Each pair"
+				<< std::endl;
+		std::cout
+				<< "\t    is stored as two sequence ids and a fixed-point score. The headers are stored once."
+				<< std::endl;
+		std::cout
+				<< "\t    To convert a binary file to text, run: identity convert output.bin output.txt"
+				<< std::endl;
+		std::cout
+				<< "\t    A compressed binary file (.gz) is converted the same way."
+				<< std::endl;
+
+		std::cout
+				<< "\t-p: Optional. Let each thread write its pairs to its own shard -- y (yes) or n (no). The"
+				<< std::endl;
+		std::cout
+				<< "\t    output file lists the shards. To merge them into one file sorted by the sequence order,"
 				<< std::endl;
 		std::cout
-				<< "\t    accompanying Python program to covert Identity's output to a Phylip distance matrix."
+				<< "\t    run: identity merge output.txt merged.txt"
 				<< std::endl;
 
 		std::cout
-				<< "\t-q: Optional. Query file in FASTA format. If no query(s) is provided, all versus all is"
+				<< "\t-m: Optional. Write the all versus all scores as a distance matrix (1 - identity) instead of"
+				<< std::endl;
+		std::cout
+				<< "\t    pairs -- phylip, npy (a condensed NumPy vector of float32 as used by SciPy), or tri (a"
+				<< std::endl;
+		std::cout
+				<< "\t    packed triangular matrix of identity scores). Unreported pairs have the distance 1. To"
+				<< std::endl;
+		std::cout
+				<< "\t    convert a tri file, run: identity matrix output.tri output.phylip phylip|npy"
+				<< std::endl;
+
+		std::cout
+				<< "\t-k: Optional. Report only the best N hits of each query (-k N), sorted by score. Requires -q."
+				<< std::endl;
+		std::cout
+				<< "\t    Pairs that cannot beat the N-th best hit found so far are skipped."
+				<< std::endl;
+
+		std::cout
+				<< "\t-q: Optional. Query file in FASTA or FASTQ format, which may be compressed by gzip or"
+				<< std::endl;
+		std::cout
+				<< "\t    bgzip. If no query(s) is provided, all versus all is"
 				<< std::endl;
 		std::cout << "\t    performed on the database file." << std::endl;
 
 		std::cout
-				<< "\t-c: Optional. Number of cores or hyperthreads. For the search mode, set this parameter to the"
+				<< "\t-c: Optional. Number of cores or hyperthreads, or auto (default). In the auto mode, the CPUs"
 				<< std::endl;
 		std::cout
-				<< "\t    number of cores not hyperthreads. For example, suppose your computer has 4 cores, each of"
+				<< "\t    available to the program are detected (including container CPU quotas) and the number of"
 				<< std::endl;
 		std::cout
-				<< "\t    which supports 2 hyperthreads. Set this parameter to 4 if you are using the search mode or"
+				<< "\t    threads used for aligning vs. reading is selected by measuring the speed on the first blocks."
 				<< std::endl;
 		std::cout
-				<< "\t    to 8 if you are using the all-versus-all mode. By default, all hyperthreads are used."
+				<< "\t    If a number is provided, one thread is reserved for reading."
 				<< std::endl;
 
 		std::cout
@@ -209,6 +290,45 @@ int main(int argc, char *argv[]) {
 				<< "\t    n (no). By default, it is enabled except if the threshold is 0.9 or higher."
 				<< std::endl;
 
+		std::cout
+				<< "\t-e: Optional. Reject most dissimilar pairs by a classifier trained on cheap statistics before"
+				<< std::endl;
+		std::cout
+				<< "\t    the regression model scores them -- y (yes) or n (no, default). Faster on large datasets;"
+				<< std::endl;
+		std::cout
+				<< "\t    a similar pair may be missed rarely. It is saved with the model (-s) and used with a"
+				<< std::endl;
+		std::cout
+				<< "\t    loaded model (-f) only if -e y is given."
+				<< std::endl;
+
+		std::cout
+				<< "\t-x: Optional. Score pairs on histograms folded to shorter k-mers first -- y (yes) or n (no,"
+				<< std::endl;
+		std::cout
+				<< "\t    default). Only pairs near the threshold are scored on the full histograms. Faster if the"
+				<< std::endl;
+		std::cout
+				<< "\t    sequences are long; a similar pair may be missed rarely. It is saved with the model (-s)"
+				<< std::endl;
+		std::cout
+				<< "\t    and used with a loaded model (-f) only if -x y is given."
+				<< std::endl;
+
+		std::cout
+				<< "\t-w: Optional. Count k-mers in a hashed histogram of this many bins (rounded up to a power"
+				<< std::endl;
+		std::cout
+				<< "\t    of 4) if it is smaller than the full one, e.g. -w 4194304. Memory and time per pair are"
+				<< std::endl;
+		std::cout
+				<< "\t    bounded for chromosome-scale sequences; the model is trained on hashed histograms too."
+				<< std::endl;
+		std::cout
+				<< "\t    It is ignored with a loaded model (-f), which keeps the histograms it was trained on."
+				<< std::endl;
+
 		std::cout
 				<< "\t-s: Optional. A file name to store the model, so no training is required if this model is used."
 				<< std::endl;
@@ -285,7 +405,41 @@ int main(int argc, char *argv[]) {
 				<< std::endl;
 		std::cout << std::endl;
 
-		std::cout << "\t7. To print the academic license" << std::endl;
+		std::cout
+				<< "\t7. To perform all versus all with a minimum identity score of 0.8 and report all pairs in"
+				<< std::endl;
+		std::cout << "\t   the binary format, then convert the output to text"
+				<< std::endl;
+		std::cout << "\t\tidentity -d databas.fasta -o output.bin -t 0.8 -a y -b y"
+				<< std::endl;
+		std::cout << "\t\tidentity convert output.bin output.txt" << std::endl;
+		std::cout << std::endl;
+
+		std::cout
+				<< "\t8. To perform all versus all and write a Phylip distance matrix for building a tree"
+				<< std::endl;
+		std::cout
+				<< "\t\tidentity -d databas.fasta -o matrix.phylip -t 0.5 -a y -m phylip"
+				<< std::endl;
+		std::cout << std::endl;
+
+		std::cout
+				<< "\t9. To report the best 5 hits of each query with a minimum identity score of 0.7"
+				<< std::endl;
+		std::cout
+				<< "\t\tidentity -d databas.fasta -q query.fasta -o output.txt -t 0.7 -k 5"
+				<< std::endl;
+		std::cout << std::endl;
+
+		std::cout
+				<< "\t10. To perform all versus all writing a shard per thread, then merge the shards"
+				<< std::endl;
+		std::cout << "\t\tidentity -d databas.fasta -o shards.txt -t 0.5 -p y"
+				<< std::endl;
+		std::cout << "\t\tidentity merge shards.txt output.txt" << std::endl;
+		std::cout << std::endl;
+
+		std::cout << "\t11. To print the academic license" << std::endl;
 		std::cout << "\t\tidentity -l y" << std::endl;
 		std::cout << std::endl;
 
@@ -300,7 +454,15 @@ int main(int argc, char *argv[]) {
 	bool relaxUserInit = false;
 	char license = 'n';
 	char all = 'n';
-	int cores = std::thread::hardware_concurrency();
+	char binary = 'n';
+	std::string matrixFormat("");
+	int topK = 0;
+	char shard = 'n';
+	char prefilter = 'n';
+	char cascade = 'n';
+	int64_t histWidth = 0;
+	int cores = ThreadTuner::countAvailableCores();
+	bool canTune = true;
 	double threshold = -1.0;
 	bool canFillModel = false;
 	bool canSaveModel = false;
@@ -323,7 +485,10 @@ int main(int argc, char *argv[]) {
 			break;
 
 		case 'c': {
-			cores = atoi(argv[i + 1]);
+			if (std::string(argv[i + 1]) != "auto") {
+				cores = atoi(argv[i + 1]);
+				canTune = false;
+			}
 		}
 			break;
 
@@ -348,6 +513,60 @@ int main(int argc, char *argv[]) {
 		}
 			break;
 
+		case 'b': {
+			binary = argv[i + 1][0];
+		}
+			break;
+
+		case 'm': {
+			matrixFormat = std::string(argv[i + 1]);
+		}
+			break;
+
+		case 'p': {
+			shard = argv[i + 1][0];
+		}
+			break;
+
+		case 'e': {
+			prefilter = argv[i + 1][0];
+		}
+			break;
+
+		case 'x': {
+			cascade = argv[i + 1][0];
+		}
+			break;
+
+		case 'w': {
+			histWidth = atoll(argv[i + 1]);
+			if (histWidth < 256) {
+				std::cerr
+						<< "Error: Please provide a histogram width of 256 bins at least (-w 4194304).";
+				std::cerr << std::endl;
+				std::cerr << "\tRerun with -h to see the help message.";
+				std::cerr << std::endl;
+				std::cerr << std::endl;
+				exit(1);
+			}
+			Parameters::setHistWidth(histWidth);
+		}
+			break;
+
+		case 'k': {
+			topK = atoi(argv[i + 1]);
+			if (topK < 1) {
+				std::cerr
+						<< "Error: Please provide a number of hits per query >= 1 (-k 5).";
+				std::cerr << std::endl;
+				std::cerr << "\tRerun with -h to see the help message.";
+				std::cerr << std::endl;
+				std::cerr << std::endl;
+				exit(1);
+			}
+		}
+			break;
+
 		case 'f': {
 			modelFile = std::string(argv[i + 1]);
 			canFillModel = true;
@@ -405,6 +624,95 @@ int main(int argc, char *argv[]) {
 		exit(1);
 	}
 
+	if (binary != 'y' && binary != 'n') {
+		std::cerr
+				<< "Error: If you would like to write the output in the binary format use -b y, otherwise -b n.";
+		std::cerr << std::endl;
+		std::cerr << "\tRerun with -h to see the help message.";
+		std::cerr << std::endl;
+		std::cerr << std::endl;
+		exit(1);
+	}
+
+	if (!matrixFormat.empty()) {
+		if (matrixFormat != "phylip" && matrixFormat != "npy"
+				&& matrixFormat != "tri") {
+			std::cerr
+					<< "Error: The matrix format must be phylip, npy, or tri (-m phylip).";
+			std::cerr << std::endl;
+			std::cerr << "\tRerun with -h to see the help message.";
+			std::cerr << std::endl;
+			std::cerr << std::endl;
+			exit(1);
+		}
+		if (matrixFormat == "tri" && OutputWriter::isGzipName(outFile)) {
+			std::cerr
+					<< "Error: A tri matrix is memory-mapped; it cannot be compressed (.gz).";
+			std::cerr << std::endl;
+			std::cerr << "\tRerun with -h to see the help message.";
+			std::cerr << std::endl;
+			std::cerr << std::endl;
+			exit(1);
+		}
+		if (!qryFile.empty() || binary == 'y') {
+			std::cerr
+					<< "Error: The -m option is for all versus all; it cannot be used with -q or -b.";
+			std::cerr << std::endl;
+			std::cerr << "\tRerun with -h to see the help message.";
+			std::cerr << std::endl;
+			std::cerr << std::endl;
+			exit(1);
+		}
+	}
+
+	if (shard != 'y' && shard != 'n') {
+		std::cerr
+				<< "Error: If you would like each thread to write its own shard use -p y, otherwise -p n.";
+		std::cerr << std::endl;
+		std::cerr << "\tRerun with -h to see the help message.";
+		std::cerr << std::endl;
+		std::cerr << std::endl;
+		exit(1);
+	}
+
+	if (prefilter != 'y' && prefilter != 'n') {
+		std::cerr
+				<< "Error: If you would like to reject dissimilar pairs by a classifier first use -e y, otherwise -e n.";
+		std::cerr << std::endl;
+		std::cerr << "\tRerun with -h to see the help message.";
+		std::cerr << std::endl;
+		std::cerr << std::endl;
+		exit(1);
+	}
+
+	if (cascade != 'y' && cascade != 'n') {
+		std::cerr
+				<< "Error: If you would like to score folded histograms first use -x y, otherwise -x n.";
+		std::cerr << std::endl;
+		std::cerr << "\tRerun with -h to see the help message.";
+		std::cerr << std::endl;
+		std::cerr << std::endl;
+		exit(1);
+	}
+
+	if (shard == 'y' && !matrixFormat.empty()) {
+		std::cerr << "Error: Options -p and -m cannot be used at the same time.";
+		std::cerr << std::endl;
+		std::cerr << "\tRerun with -h to see the help message.";
+		std::cerr << std::endl;
+		std::cerr << std::endl;
+		exit(1);
+	}
+
+	if (topK > 0 && qryFile.empty()) {
+		std::cerr << "Error: The -k option requires a query file (-q).";
+		std::cerr << std::endl;
+		std::cerr << "\tRerun with -h to see the help message.";
+		std::cerr << std::endl;
+		std::cerr << std::endl;
+		exit(1);
+	}
+
 	// Make sure that the required parameters have been provided
 	if (dbFile.empty()) {
 		std::cerr << "Error: Please provide a database file in FASTA format.";
@@ -461,6 +769,11 @@ int main(int argc, char *argv[]) {
 		exit(1);
 	}
 
+	// At least one thread for aligning and one for reading
+	if (canTune && cores < 2) {
+		cores = 2;
+	}
+
 	if (cores < 2) {
 		std::cerr
 				<< "Error: Please provide a number of cores/threads >= 2 (-c 2).";
@@ -489,11 +802,23 @@ int main(int argc, char *argv[]) {
 	std::cout << "Database file: " << dbFile << std::endl;
 	std::cout << "Query file: " << (qryFile.empty() ? "Not provided" : qryFile)
 			<< std::endl;
-	std::cout << "Output file: " << outFile << std::endl;
-	std::cout << "Cores: " << cores << std::endl;
+	std::cout << "Output file: " << outFile
+			<< (binary == 'y' ? " (binary)" : "")
+			<< (OutputWriter::isGzipName(outFile) ? " (gzip)" : "")
+			<< (shard == 'y' ? " (manifest of shards)" : "")
+			<< (matrixFormat.empty() ? "" : " (" + matrixFormat + " matrix)")
+			<< std::endl;
+	std::cout << "Cores: " << cores << (canTune ? " (auto)" : "") << std::endl;
 	std::cout << "Threshold: " << threshold << std::endl;
 	std::cout << "Automatically relax threshold: "
 			<< (relax == 'y' ? "Yes" : "No") << std::endl;
+	std::cout << "Reject dissimilar pairs first: "
+			<< (prefilter == 'y' ? "Yes" : "No") << std::endl;
+	std::cout << "Score folded histograms first: "
+			<< (cascade == 'y' ? "Yes" : "No") << std::endl;
+	if (topK > 0) {
+		std::cout << "Hits per query: " << topK << std::endl;
+	}
 	std::cout << "All vs. all: " << (qryFile.empty() ? "Yes" : "No");
 	std::cout << std::endl << std::endl;
 
@@ -503,7 +828,10 @@ int main(int argc, char *argv[]) {
 
 	ReaderAlignerCoordinator coordinator(cores, blockSize, threshold,
 			relax == 'y' ? true : false, all == 'y' ? true : false,
-			canSaveModel, canFillModel, modelFile);
+			canSaveModel, canFillModel, modelFile, canTune,
+			binary == 'y' ? true : false, matrixFormat, topK,
+			shard == 'y' ? true : false, prefilter == 'y' ? true : false,
+			cascade == 'y' ? true : false);
 	if (qryFile.empty()) {
 		coordinator.alignAllVsAll(dbFile, outFile, "\t");
 	} else {
@@ -25,9 +25,12 @@
 
 template<class V>
 IdentityCalculator<V>::IdentityCalculator(DataGenerator *g, int threadNum,
-		double t, bool skip, bool relax, std::string modelFile) {
+		double t, bool skip, bool relax, std::string modelFile,
+		bool canPrefilter) {
 	//g = generator;
 	threshold = t;
+	prefilter = nullptr;
+	coarse = nullptr;
 	canSkip = skip;
 	canRelax = relax;
 
@@ -44,13 +47,13 @@ IdentityCalculator<V>::IdentityCalculator(DataGenerator *g, int threadNum,
 
 	k = g->getK();
 	kHistSize = g->getHistogramSize();
-	keyList = Util::makeKeyList(kHistSize, k);
 
 	/**
 	 * Train and prepare the predictor
 	 */
+	std::vector<int> statList = g->getCandidateList();
 	GLMRegressor regressor(g->getFeatures(), g->getLabels(), 0.0, threadNum,
-			g->getK());
+			g->getK(), statList);
 	regressor.start();
 
 	absError = regressor.getAbsError();
@@ -58,6 +61,17 @@ IdentityCalculator<V>::IdentityCalculator(DataGenerator *g, int threadNum,
 		threshold -= regressor.getAbsError();
 	}
 
+	// The prefilter is trained at the threshold pairs are filtered at
+	if (canPrefilter && canSkip) {
+		prefilter = Prefilter::train(g->getFeatures(), g->getLabels(),
+				threshold, threadNum);
+	}
+	if (g->getCoarseFeatures() != nullptr && canSkip) {
+		coarse = CoarseScorer::train(g->getCoarseFeatures(), g->getLabels(),
+				k - g->getFoldNum(), kHistSize, g->getFoldNum(), threshold,
+				threadNum, statList);
+	}
+
 	// Free memory used by the training and the validation data
 	g->clearData();
 
@@ -74,7 +88,7 @@ IdentityCalculator<V>::IdentityCalculator(DataGenerator *g, int threadNum,
 	// Write feature list
 	if (!modelFile.empty()) {
 		Serializer serializer(&featList, compositionList, k, kHistSize,
-				absError, g->getMaxLength(), modelFile);
+				absError, g->getMaxLength(), modelFile, prefilter, coarse);
 	}
 
 	// This predictor removes the bias from the feature list
@@ -87,13 +101,13 @@ IdentityCalculator<V>::IdentityCalculator(DataGenerator *g, int threadNum,
 	featList.clear();
 
 	// Construct table builders
-	kTable = new KmerHistogram<uint64_t, V>(k);
+	kTable = new KmerHistogram<uint64_t, V>(k, kHistSize);
 	monoTable = new KmerHistogram<uint64_t, uint64_t>(1);
 }
 
 template<class V>
 IdentityCalculator<V>::IdentityCalculator(Serializer &serializer, double t,
-		bool skip, bool relax) {
+		bool skip, bool relax, bool canPrefilter, bool canCascade) {
 
 	// Parse model
 	// Serializer serializer(modelFile);
@@ -101,6 +115,8 @@ IdentityCalculator<V>::IdentityCalculator(Serializer &serializer, double t,
 	threshold = t;
 	canSkip = skip;
 	canRelax = relax;
+	prefilter = nullptr;
+	coarse = nullptr;
 
 	/**
 	 * These data are needed for statisticians
@@ -119,8 +135,6 @@ IdentityCalculator<V>::IdentityCalculator(Serializer &serializer, double t,
 		threshold -= absError;
 	}
 
-	keyList = Util::makeKeyList(kHistSize, k);
-
 	vector<Feature*> *featList = serializer.getFeatList();
 	featNum = featList->size() - 1; // The bias has not been removed yet.
 	for (auto f : *featList) {
@@ -134,17 +148,34 @@ IdentityCalculator<V>::IdentityCalculator(Serializer &serializer, double t,
 	// This predictor removes the bias from the feature list
 	p = GLMPredictor(*featList, false);
 
+	// A prefilter trained at a lower threshold is still safe to use
+	auto preList = serializer.getPrefilterList();
+	if (canPrefilter && canSkip && preList != nullptr
+			&& threshold >= serializer.getPrefilterThreshold()) {
+		prefilter = new Prefilter(*preList,
+				serializer.getPrefilterThreshold(),
+				serializer.getPrefilterCutoff());
+	}
+	auto coarseList = serializer.getCoarseList();
+	if (canCascade && canSkip && coarseList != nullptr
+			&& threshold >= serializer.getCoarseThreshold()) {
+		coarse = new CoarseScorer(*coarseList, serializer.getCoarseK(),
+				kHistSize, serializer.getFoldNum(),
+				serializer.getCoarseThreshold(), serializer.getCoarseCutoff());
+	}
+
 	// Construct table builders
-	kTable = new KmerHistogram<uint64_t, V>(k);
+	kTable = new KmerHistogram<uint64_t, V>(k, kHistSize);
 	monoTable = new KmerHistogram<uint64_t, uint64_t>(1);
 }
 
 template<class V>
 IdentityCalculator<V>::~IdentityCalculator() {
 	delete[] compositionList;
-	delete[] keyList;
 	delete monoTable;
 	delete kTable;
+	delete prefilter;
+	delete coarse;
 }
 
 /**
@@ -158,15 +189,81 @@ double* IdentityCalculator<V>::score(V *kHist1, V **kHist2List,
 		int threadNum, int len1, int *len2List) {
 
 	double *v = new double[listSize];
+	if (listSize == 0) {
+		return v;
+	}
+
+	// A few pairs of large histograms are scored one after another, each
+	// by all threads
+	int pairThreadNum = ThreadTuner::findInnerThreadNum(listSize, kHistSize,
+			ThreadTuner::SPLIT_BIN_NUM, threadNum);
+	threadNum /= pairThreadNum;
+
+	// The pairs are scored in batches; each thread gets one at least
+	int batch = std::min(GLMPredictor::BATCH,
+			(listSize + threadNum - 1) / threadNum);
+	int batchNum = (listSize + batch - 1) / batch;
 
 #pragma omp parallel for schedule(static) num_threads(threadNum)
-	for (int i = 0; i < listSize; i++) {
-		double ratio = calcRatio(len1, len2List[i]);
-		if (canSkip && ratio < threshold) {
+	for (int b = 0; b < batchNum; b++) {
+		int start = b * batch;
+		int size = std::min(batch, listSize - start);
+
+		// Statistics of the pairs passing the filters, stored by feature
+		double statTable[singleFeatNum * size];
+		double resList[size];
+		int indexList[size];
+		double data[featNum];
+		int n = 0;
+		for (int i = start; i < start + size; i++) {
 			v[i] = 0.0;
-		} else {
-			v[i] = score(kHist1, kHist2List[i], monoHist1, monoHist2List[i],
-					ratio, len1, len2List[i]);
+			double ratio = calcRatio(len1, len2List[i]);
+			if (canSkip && ratio < threshold) {
+				continue;
+			}
+
+			Statistician<V> s(kHistSize, k, kHist1, kHist2List[i], monoHist1,
+					monoHist2List[i], compositionList, pairThreadNum);
+			if (canSkip && s.identityMinimum(len1, len2List[i]) < threshold) {
+				continue;
+			}
+			if (canSkip
+					&& isFarBelow(kHist1, kHist2List[i], monoHist1,
+							monoHist2List[i], threshold)) {
+				continue;
+			}
+			if (!calculate(s, canSkip ? threshold : 0.0, data)) {
+				continue;
+			}
+			indexList[n] = i;
+			for (int f = 0; f < singleFeatNum; f++) {
+				statTable[f * size + n] = data[f];
+			}
+			n++;
+		}
+
+		// The table has room for size pairs; n columns are used
+		if (n < size) {
+			for (int f = 1; f < singleFeatNum; f++) {
+				std::copy(statTable + f * size, statTable + f * size + n,
+						statTable + f * n);
+			}
+		}
+		p.calculateIdentity(statTable, n, resList);
+
+		for (int j = 0; j < n; j++) {
+			int i = indexList[j];
+			double res = resList[j];
+			// An identity score cannot be greater than the length ratio
+			double ratio = calcRatio(len1, len2List[i]);
+			if (res > ratio) {
+				res = ratio;
+			}
+			// Trim score
+			if ((canSkip && res < threshold) || res < 0.0) {
+				res = 0.0;
+			}
+			v[i] = res;
 		}
 	}
 	return v;
@@ -185,17 +282,16 @@ Matrix IdentityCalculator<V>::score(V **kHistList, uint64_t **monoHistList,
 		m(i, i) = 1.0;
 	}
 
-	for (int i = 0; i < listSize; i++) {
-#pragma omp parallel for schedule(static) num_threads(threadNum)
+	// Each row is scored as one versus the sequences after it
+	for (int i = 0; i < listSize - 1; i++) {
+		double *v = score(kHistList[i], kHistList + i + 1, monoHistList[i],
+				monoHistList + i + 1, listSize - i - 1, threadNum, lenList[i],
+				lenList + i + 1);
 		for (int j = i + 1; j < listSize; j++) {
-			double ratio = calcRatio(lenList[i], lenList[j]);
-			if (!canSkip || ratio >= threshold) {
-				double r = score(kHistList[i], kHistList[j], monoHistList[i],
-						monoHistList[j], ratio, lenList[i], lenList[j]);
-				m(i, j) = r;
-				m(j, i) = r;
-			}
+			m(i, j) = v[j - i - 1];
+			m(j, i) = v[j - i - 1];
 		}
+		delete[] v;
 	}
 	return m;
 }
@@ -229,6 +325,15 @@ Matrix IdentityCalculator<V>::score(V **kHistList, uint64_t **monoHistList,
 //
 //	return m;
 //}
+template<class V>
+V* IdentityCalculator<V>::buildKHist(const std::string *seq,
+		const SegmentList &segmentList, int threadNum) {
+	if (coarse == nullptr) {
+		return kTable->build(seq, segmentList, threadNum);
+	}
+	return coarse->build(*kTable, seq, segmentList, threadNum);
+}
+
 template<class V>
 double IdentityCalculator<V>::getError() const {
 	return absError;
@@ -241,64 +346,73 @@ int IdentityCalculator<V>::getK() const {
 
 /**
  * This method calculates the k-mer histograms and the mono
- * histograms. It frees memory used by the sequences
- * stored in the block.
+ * histograms. It frees memory used by the sequences and the headers
+ * stored in the block. The ids of the sequences are returned instead.
  */
 template<class V>
-std::tuple<V**, uint64_t**, std::string**, int*> IdentityCalculator<V>::unpackBlock(
+std::tuple<V**, uint64_t**, uint32_t*, int*> IdentityCalculator<V>::unpackBlock(
 		Block *block, int threadNum) {
 	int size = block->size();
 	V **kHistList = new V*[size];
 	uint64_t **monoHistList = new uint64_t*[size];
-	std::string **infoList = new std::string*[size];
+	uint32_t *idList = new uint32_t[size];
 	int *lenList = new int[size];
 
-#pragma omp parallel for schedule(static) num_threads(threadNum)
+	// A few long sequences are counted one after another, each by all
+	// threads
+	int64_t longest = 0;
+	for (int i = 0; i < size; i++) {
+		longest = std::max<int64_t>(longest, block->at(i).second->length());
+	}
+	int seqThreadNum = ThreadTuner::findInnerThreadNum(size, longest,
+			ThreadTuner::SPLIT_LENGTH, threadNum);
+
+#pragma omp parallel for schedule(static) num_threads(threadNum / seqThreadNum)
 	for (int i = 0; i < size; i++) {
-		auto p = block->at(i);
-		infoList[i] = p.first;
+		auto &p = block->at(i);
+		idList[i] = p.id;
 		std::string *seq = p.second;
-		kHistList[i] = kTable->build(seq);
-		monoHistList[i] = monoTable->build(seq);
+		kHistList[i] = buildKHist(seq, p.segmentList, seqThreadNum);
+		monoHistList[i] = monoTable->build(seq, p.segmentList, seqThreadNum);
 		// A check
 		if (Util::isAllZeros(kHistList[i], kHistSize)
 				|| Util::isAllZeros(monoHistList[i], monoHistSize)) {
 #pragma omp critical (unpackBlock)
 			{
 				std::cerr << "Found histograms made of all zeros: ";
-				std::cerr << *infoList[i] << std::endl;
+				std::cerr << *p.first << std::endl;
 				throw std::exception();
 			}
 		}
 
 		lenList[i] = seq->length();
 		delete seq;
+		delete p.first;
 	}
 	block->clear();
 	delete block;
 
-	return std::make_tuple(kHistList, monoHistList, infoList, lenList);
+	return std::make_tuple(kHistList, monoHistList, idList, lenList);
 }
 
 template<class V>
 void IdentityCalculator<V>::freeBlock(
-		std::tuple<V**, uint64_t**, std::string**, int*> t, int size,
+		std::tuple<V**, uint64_t**, uint32_t*, int*> t, int size,
 		int threadNum) {
 	auto kHistList = get < 0 > (t);
 	auto monoHistList = get < 1 > (t);
-	auto infoList = get < 2 > (t);
+	auto idList = get < 2 > (t);
 	auto lenList = get < 3 > (t);
 
 #pragma omp parallel for schedule(static) num_threads(threadNum)
 	for (int i = 0; i < size; i++) {
 		delete[] kHistList[i];
 		delete[] monoHistList[i];
-		delete infoList[i];
 	}
 
 	delete[] kHistList;
 	delete[] monoHistList;
-	delete[] infoList;
+	delete[] idList;
 	delete[] lenList;
 }
 
@@ -38,6 +38,9 @@
 #include "Matrix.h"
 #include "KmerHistogram.h"
 #include "Serializer.h"
+#include "Prefilter.h"
+#include "CoarseScorer.h"
+#include "ThreadTuner.h"
 #include "Util.h"
 
 template<class V>
@@ -50,6 +53,11 @@ private:
 //	DataGenerator *g;
 
 	GLMPredictor p;
+	// Rejects most dissimilar pairs by the cheap statistics; may be nullptr
+	Prefilter *prefilter;
+	// Scores the folded histograms first; may be nullptr. If it is set, a
+	// histogram of unpackBlock or buildKHist is followed by its folded one.
+	CoarseScorer *coarse;
 	int featNum;
 	int singleFeatNum;
 	std::vector<int> funIndexList;
@@ -58,8 +66,6 @@ private:
 	double *compositionList;
 	int k;
 
-	uint8_t *keyList;
-
 	KmerHistogram<uint64_t, V> *kTable;
 	KmerHistogram<uint64_t, uint64_t> *monoTable;
 
@@ -72,14 +78,19 @@ protected:
 
 public:
 	IdentityCalculator(DataGenerator*, int, double, bool, bool,
-			std::string modelFile = "");
-	IdentityCalculator(Serializer&, double, bool, bool);
+			std::string modelFile = "", bool canPrefilter = false);
+	/**
+	 * A saved prefilter is used only if canPrefilter is true, and a saved
+	 * coarse model only if canCascade is true
+	 */
+	IdentityCalculator(Serializer&, double, bool, bool,
+			bool canPrefilter = false, bool canCascade = false);
 
 	virtual ~IdentityCalculator();
 	double getError() const;
 	int getK() const;
 
-	void freeBlock(std::tuple<V**, uint64_t**, std::string**, int*>, int, int);
+	void freeBlock(std::tuple<V**, uint64_t**, uint32_t*, int*>, int, int);
 
 	/**
 	 * Returns true if it is impossible to obtain the desired identity
@@ -103,23 +114,73 @@ public:
 		return l1 < l2 ? l1 / l2 : l2 / l1;
 	}
 
+	/**
+	 * Calculate the statistics of a pair. If a minimum is given, they are
+	 * calculated in the order of the predictor's bound, which stops as soon
+	 * as the score cannot reach the minimum; then false is returned. A pair
+	 * the prefilter rejects is not calculated at all.
+	 */
+	inline bool calculate(Statistician<V> &s, double minimum, double *data) {
+		if (minimum > 0.0 && prefilter != nullptr
+				&& prefilter->canApply(minimum)) {
+			double preData[prefilter->getFeatNum()];
+			s.calculate(prefilter->getFunIndexArray(),
+					prefilter->getSingleFeatNum(), preData);
+			if (prefilter->isRejected(preData)) {
+				return false;
+			}
+		}
+
+		return p.calculateBounded(s, funIndexArray, minimum, data);
+	}
+
+	/**
+	 * True if the coarse stage shows the pair cannot reach the minimum
+	 */
+	inline bool isFarBelow(V *kHist1, V *kHist2, uint64_t *monoHist1,
+			uint64_t *monoHist2, double minimum) {
+		return minimum > 0.0 && coarse != nullptr && coarse->canApply(minimum)
+				&& coarse->isRejected(kHist1 + kHistSize, kHist2 + kHistSize,
+						monoHist1, monoHist2, compositionList);
+	}
+
 	/**
 	 * One vs. one
 	 */
 	inline virtual double score(V *kHist1, V *kHist2, uint64_t *monoHist1,
 			uint64_t *monoHist2, double ratio, int l1, int l2) {
+		return score(kHist1, kHist2, monoHist1, monoHist2, ratio, l1, l2, 0.0);
+	}
+
+	/**
+	 * One vs. one. Scores below the minimum, e.g. the K-th best score of
+	 * the query so far, are not of interest; so the filters use it too.
+	 * The bins of the pair are split over threadNum threads.
+	 */
+	inline double score(V *kHist1, V *kHist2, uint64_t *monoHist1,
+			uint64_t *monoHist2, double ratio, int l1, int l2,
+			double minimum, int threadNum = 1) {
+		double t = canSkip ? std::max(threshold, minimum) : minimum;
+		bool canFilter = canSkip || minimum > 0.0;
+
 		// Calculate statistics
 		Statistician<V> s(kHistSize, k, kHist1, kHist2, monoHist1, monoHist2,
-				compositionList, keyList);
+				compositionList, threadNum);
 		double res;
-		if (canSkip && s.identityMinimum(l1,l2) < threshold) {
+		if (canFilter && s.identityMinimum(l1,l2) < t) {
 			//cout << "Skipping according to filter." << endl;
 			res = 0.0;
+		} else if (canFilter
+				&& isFarBelow(kHist1, kHist2, monoHist1, monoHist2, t)) {
+			res = 0.0;
 		} else {
 			double data[featNum];
-			s.calculate(funIndexArray, singleFeatNum, data);
 			// Calculate identity score
-			res = p.calculateIdentity(data);
+			if (calculate(s, canFilter ? t : 0.0, data)) {
+				res = p.calculateIdentity(data);
+			} else {
+				res = 0.0;
+			}
 
 			// In case of error, correct it
 			// An identity score cannot be greater than the length ratio
@@ -128,7 +189,7 @@ public:
 			}
 
 			// Trim score
-			if ((canSkip && res < threshold) || res < 0.0) {
+			if ((canFilter && res < t) || res < 0.0) {
 				res = 0.0;
 			}
 		}
@@ -154,8 +215,15 @@ public:
 //	Matrix* scoreHeap(V **kHistList, uint64_t **monoHistList, int listSize,
 //			int threadNum, int *lenList);
 
-	std::tuple<V**, uint64_t**, std::string**, int*> unpackBlock(Block *b,
+	/**
+	 * Headers are not kept; a sequence is referred to by its id
+	 */
+	std::tuple<V**, uint64_t**, uint32_t*, int*> unpackBlock(Block *b,
 			int threadNum);
+	/**
+	 * The k-mer histogram of a sequence, as unpackBlock builds it
+	 */
+	V* buildKHist(const std::string*, const SegmentList&, int threadNum = 1);
 	int getKHistSize() const;
 	int getMonoHistSize() const;
 
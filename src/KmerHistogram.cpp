@@ -6,7 +6,7 @@
  * Author: Hani Zakaria Girgis, PhD
  */
 template<class I, class V>
-KmerHistogram<I, V>::KmerHistogram(int keyLength) :
+KmerHistogram<I, V>::KmerHistogram(int keyLength, I tableSize) :
 		k(keyLength) {
 	if (k < 1) {
 		cerr << "k must be at least 1." << endl;
@@ -40,6 +40,15 @@ KmerHistogram<I, V>::KmerHistogram(int keyLength) :
 		temp.append(1, 'G');
 	}
 	maxTableSize = hash(&temp) + 1;
+
+	isHashed = tableSize > 0 && tableSize < maxTableSize;
+	hashShift = 64;
+	if (isHashed) {
+		maxTableSize = tableSize;
+		for (I s = maxTableSize; s > 1; s /= 4) {
+			hashShift -= 2;
+		}
+	}
 }
 
 template<class I, class V>
@@ -97,26 +106,88 @@ void KmerHistogram<I, V>::hash(const string *sequence, int start, int end,
  */
 template<class I, class V>
 V* KmerHistogram<I, V>::build(const string *sequence) {
-	// Segment coordinates are inclusive [s,e]
-	// This peace of code is duplicated in KmerHistogram
-	char unknown = Parameters::getUnknown();
-	vector < pair<int, int> > segmentList;
-	// Store non-N/non-X index
-	int start = -1;
-	int len = sequence->size();
-	const char *array = sequence->c_str();
-	for (unsigned int i = 0; i < len; i++) {
-		char c = array[i];
-		if (c != unknown && start == -1) {
-			start = i;
-		} else if (c == unknown && start != -1) {
-			segmentList.push_back(make_pair(start, i - 1));
-			start = -1;
-		} else if (i == len - 1 && c != unknown && start != -1) {
-			segmentList.push_back(make_pair(start, i));
-			start = -1;
+	SegmentList segmentList;
+	Util::findSegments(sequence, segmentList);
+	V *valueList = new V[maxTableSize];
+	buildHelper(sequence, segmentList, valueList, 1);
+	return valueList;
+}
+
+/**
+ * segmentList: The valid segments of the sequence as found by FastaReader.
+ * 	If it is empty, the segments are found here.
+ */
+template<class I, class V>
+V* KmerHistogram<I, V>::build(const string *sequence,
+		const SegmentList &segmentList, int threadNum) {
+	V *valueList = new V[maxTableSize];
+	build(sequence, segmentList, valueList, threadNum);
+	return valueList;
+}
+
+/**
+ * Same as the above method, but the histogram is written to a table of
+ * getMaxTableSize() values owned by the client; so the table can be reused
+ * for the next sequence.
+ */
+template<class I, class V>
+void KmerHistogram<I, V>::build(const string *sequence,
+		const SegmentList &segmentList, V *valueList, int threadNum) {
+	if (segmentList.empty()) {
+		SegmentList foundList;
+		Util::findSegments(sequence, foundList);
+		buildHelper(sequence, foundList, valueList, threadNum);
+	} else {
+		buildHelper(sequence, segmentList, valueList, threadNum);
+	}
+}
+
+/**
+ * Fold a histogram into the histogram of the (k - foldNum)-mers: a group of
+ * 4^foldNum bins shares the same prefix, so the bins of a group are summed.
+ * The last foldNum k-mer prefixes of a segment are not counted.
+ * out: A table of getMaxTableSize() / 4^foldNum values
+ */
+template<class I, class V>
+void KmerHistogram<I, V>::fold(const V *valueList, int foldNum, V *out) {
+	I group = bases[k - 1 - foldNum];
+	I size = maxTableSize / group;
+	for (I i = 0; i < size; i++) {
+		const V *g = valueList + i * group;
+		V sum = 0;
+		for (I j = 0; j < group; j++) {
+			sum += g[j];
 		}
+		out[i] = sum;
 	}
+}
+
+/**
+ * Increment the k-mers starting at start through end
+ */
+template<class I, class V>
+void KmerHistogram<I, V>::count(const string *sequence, int start, int end,
+		V *valueList) {
+	vector < I > hashList = vector<I>();
+	hashList.reserve(end - start + 1);
+	hash(sequence, start, end, &hashList);
+
+	unsigned int size = hashList.size();
+	if (isHashed) {
+		for (unsigned int i = 0; i < size; i++) {
+			uint64_t h = hashList[i] * 0x9E3779B97F4A7C15ULL;
+			valueList[h >> hashShift]++;
+		}
+	} else {
+		for (unsigned int i = 0; i < size; i++) {
+			valueList[hashList[i]]++;
+		}
+	}
+}
+
+template<class I, class V>
+void KmerHistogram<I, V>::buildHelper(const string *sequence,
+		const SegmentList &segmentList, V *valueList, int threadNum) {
 	// Post condition
 	if (segmentList.empty()) {
 		cerr << "KmerHistogram: At least one valid segment is required.";
@@ -125,41 +196,95 @@ V* KmerHistogram<I, V>::build(const string *sequence) {
 		throw std::exception();
 	}
 
-	// The hashed values, i.e. the values of the histograms.
-	// The index is the 4ry representation of the key
-	V *valueList = new V[maxTableSize];
-	// Initialize values
-	for (I i = 0; i < maxTableSize; i++) {
-		valueList[i] = 0;
+	// Split the valid segments into chunks of k-mers
+	vector<pair<int, int>> chunkList;
+	if (threadNum > 1) {
+		int64_t kmerNum = 0;
+		for (auto segment : segmentList) {
+			kmerNum += std::max(0, segment.second - segment.first - k + 2);
+		}
+		int64_t chunk = std::max(MIN_CHUNK, kmerNum / (4 * threadNum));
+		for (auto segment : segmentList) {
+			int last = segment.second - k + 1;
+			for (int64_t s = segment.first; s <= last; s += chunk) {
+				chunkList.push_back(
+						make_pair(s, std::min<int64_t>(s + chunk - 1, last)));
+			}
+		}
+		int64_t maxNum = 1 + MAX_PARTIAL_BYTES / (maxTableSize * sizeof(V));
+		threadNum = std::min<int64_t>( { (int64_t) threadNum,
+				(int64_t) chunkList.size(), maxNum });
 	}
 
-	// Increment k-mer's in each valid segment
-	for (auto segment : segmentList) {
-		if (segment.first <= segment.second - k + 1) {
-			vector < I > hashList = vector<I>();
-			hashList.reserve(segment.second - segment.first + 1);
-			hash(sequence, segment.first, segment.second - k + 1, &hashList);
+	bool isOverflow = false;
+	if (threadNum > 1) {
+		// Each thread counts its chunks in its own table; the first one is
+		// the histogram. The tables are added bin range by bin range.
+		int chunkNum = chunkList.size();
+		vector<V*> partList;
+#pragma omp parallel num_threads(threadNum)
+		{
+#pragma omp single
+			{
+				partList.push_back(valueList);
+				for (int t = 1; t < omp_get_num_threads(); t++) {
+					partList.push_back(new V[maxTableSize]);
+				}
+			}
+			V *part = partList[omp_get_thread_num()];
+			std::fill(part, part + maxTableSize, 0);
+
+#pragma omp for schedule(dynamic)
+			for (int c = 0; c < chunkNum; c++) {
+				count(sequence, chunkList[c].first, chunkList[c].second, part);
+			}
 
-			unsigned int size = hashList.size();
-			for (unsigned int i = 0; i < size; i++) {
-				valueList[hashList[i]]++;
+			int partNum = partList.size();
+#pragma omp for schedule(static) reduction(||:isOverflow)
+			for (I y = 0; y < maxTableSize; y++) {
+				V sum = valueList[y];
+				for (int t = 1; t < partNum; t++) {
+					sum += partList[t][y];
+				}
+				valueList[y] = sum;
+				isOverflow = isOverflow || sum < 0;
+			}
+		}
+		for (unsigned int t = 1; t < partList.size(); t++) {
+			delete[] partList[t];
+		}
+	} else {
+		// The hashed values, i.e. the values of the histograms.
+		// The index is the 4ry representation of the key
+		// Initialize values
+		for (I i = 0; i < maxTableSize; i++) {
+			valueList[i] = 0;
+		}
+
+		// Increment k-mer's in each valid segment
+		for (auto segment : segmentList) {
+			if (segment.first <= segment.second - k + 1) {
+				count(sequence, segment.first, segment.second - k + 1,
+						valueList);
 			}
 		}
-	}
 
-	// Check overflow
-	for (I y = 0; y < maxTableSize; y++) {
-		if (valueList[y] < 0) {
-			cerr << "A negative value is a likely indication of overflow.";
-			cerr << endl;
-			cerr
-					<< "To the developer: Consider larger data type in KmerHistogram.";
-			cerr << endl;
-			throw std::exception();
+		// Check overflow
+		for (I y = 0; y < maxTableSize; y++) {
+			if (valueList[y] < 0) {
+				isOverflow = true;
+				break;
+			}
 		}
 	}
 
-	return valueList;
+	if (isOverflow) {
+		cerr << "A negative value is a likely indication of overflow.";
+		cerr << endl;
+		cerr << "To the developer: Consider larger data type in KmerHistogram.";
+		cerr << endl;
+		throw std::exception();
+	}
 }
 
 /**
@@ -204,18 +329,6 @@ void KmerHistogram<I, V>::getKeys(vector<string> &keyList) {
 	}
 }
 
-template<class I, class V>
-void KmerHistogram<I, V>::getKeysDigitFormat(uint8_t keyList[]) {
-	int alphaSize = Parameters::getAlphabetSize();
-
-	for (int c = k - 1; c >= 0; c--) {
-		for (int r = 0; r < maxTableSize; r++) {
-			keyList[(r * k) + k - 1 - c] = (r / ((uint64_t) pow(alphaSize, c)))
-					% alphaSize;
-		}
-	}
-}
-
 /**
  * Print the contents of the whole table
  */
@@ -16,8 +16,12 @@
 #include <math.h>
 #include <iostream>
 #include <tuple>
+#include <vector>
+#include <algorithm>
+#include <omp.h>
 
 #include "Parameters.h"
+#include "Util.h"
 
 using namespace std;
 
@@ -35,19 +39,43 @@ private:
 	I bases[maxKeyLength];
 	I mMinusOne[4];
 	int digitList['T' + 1];
+	// A hashed histogram has fewer bins than k-mers. A k-mer is counted in
+	// the top bits of its multiplicative (Fibonacci) hash, so a group of
+	// consecutive bins is a hashed histogram too (see fold).
+	bool isHashed;
+	int hashShift;
+
+	// A chunk of a sequence counted by one thread has this many k-mers at
+	// least. The partial tables of the threads take this many bytes at most.
+	static constexpr int64_t MIN_CHUNK = 1 << 16;
+	static constexpr int64_t MAX_PARTIAL_BYTES = 1LL << 30;
+
+	void count(const string*, int, int, V*);
+	void buildHelper(const string*, const SegmentList&, V*, int);
 
 public:
 	/* Methods */
-	KmerHistogram(int);
+	/**
+	 * tableSize: The number of bins, a power of 4 below 4^k, of a hashed
+	 * histogram. All k-mers have their own bins by default.
+	 */
+	KmerHistogram(int, I tableSize = 0);
 	virtual ~KmerHistogram();
 
 	I hash(const string*);
 	I hash(const string*, int);
 	void hash(const string*, int, int, vector<I>*);
 	V* build(const string *sequence);
+	/**
+	 * threadNum: A long sequence may be split into chunks counted by this
+	 * many threads in their own tables, which are added at the end.
+	 */
+	V* build(const string *sequence, const SegmentList&, int threadNum = 1);
+	void build(const string *sequence, const SegmentList&, V*,
+			int threadNum = 1);
+	void fold(const V*, int, V*);
 
 	void getKeys(vector<string> &keys);
-	void getKeysDigitFormat(uint8_t keyList[]);
 	void printTable(V*);
 	void printPythonFormat(V*);
 
@@ -23,6 +23,16 @@
 
 #include "Matrix.h"
 
+#include <algorithm>
+#include <cmath>
+
+// Tiles of the multiplication; a tile of the second operand fits in L2
+static const int TILE = 128;
+
+// A pivot smaller than this fraction of its diagonal (or of the largest
+// pivot) means the matrix is singular or nearly so
+static const double SINGULAR = 1e-10;
+
 Matrix::Matrix() :
 		numRow(0), numCol(0) {
 	m = nullptr;
@@ -62,6 +72,11 @@ Matrix::Matrix(const Matrix &o) :
 }
 
 Matrix& Matrix::operator=(const Matrix &o) {
+	if (this == &o) {
+		return *this;
+	}
+	clearData();
+
 	numRow = o.getNumRow();
 	numCol = o.getNumCol();
 	int64_t size = numRow * numCol;
@@ -372,44 +387,274 @@ Matrix* Matrix::times(const Matrix *other) const {
 		throw std::exception();
 	}
 
-	Matrix *result = new Matrix(numRow, other->getNumCol());
+	return new Matrix(this->operator*(*other));
+}
 
-	double curSum = 0.0;
-	for (int i = 0; i < result->getNumRow(); i++) {
-		for (int j = 0; j < result->getNumCol(); j++) {
-			curSum = 0;
+/**
+ * The loops are ordered (i, k, j); so the inner loop runs over contiguous
+ * rows of the second matrix and the result, and it is vectorized. The
+ * second matrix is processed in tiles that stay in the cache.
+ */
+Matrix Matrix::operator*(const Matrix &other) const {
+	if (numCol != other.getNumRow()) {
+		std::cerr << "Invalid input: Matrix dimension mismatch." << std::endl;
+		throw std::exception();
+	}
+
+	int n = other.getNumCol();
+	Matrix result(numRow, n);
+	double *r = result.m;
+	const double *b = other.m;
+
+	// A column vector, e.g. the weights of a GLM
+	if (n == 1) {
+		for (int i = 0; i < numRow; i++) {
+			const double *a = m + (int64_t) i * numCol;
+			double sum = 0.0;
+#pragma omp simd reduction(+:sum)
 			for (int k = 0; k < numCol; k++) {
-				curSum = curSum + item(i, k) * other->item(k, j);
+				sum += a[k] * b[k];
+			}
+			r[i] = sum;
+		}
+		return result;
+	}
+
+	for (int kk = 0; kk < numCol; kk += TILE) {
+		int kEnd = std::min(kk + TILE, numCol);
+		for (int jj = 0; jj < n; jj += TILE) {
+			int jEnd = std::min(jj + TILE, n);
+			for (int i = 0; i < numRow; i++) {
+				const double *a = m + (int64_t) i * numCol;
+				double *ri = r + (int64_t) i * n;
+				for (int k = kk; k < kEnd; k++) {
+					double aik = a[k];
+					const double *bk = b + (int64_t) k * n;
+#pragma omp simd
+					for (int j = jj; j < jEnd; j++) {
+						ri[j] += aik * bk[j];
+					}
+				}
 			}
-			result->item(i, j) = curSum;
 		}
 	}
 
 	return result;
 }
 
-Matrix Matrix::operator*(const Matrix &other) const {
-	if (numCol != other.getNumRow()) {
+/**
+ * The transpose of this x other in one pass over the rows of both
+ */
+Matrix Matrix::transposeTimes(const Matrix &other) const {
+	if (numRow != other.getNumRow()) {
 		std::cerr << "Invalid input: Matrix dimension mismatch." << std::endl;
 		throw std::exception();
 	}
 
-	double curSum = 0.0;
-	Matrix result(numRow, other.getNumCol());
+	int n = other.getNumCol();
+	Matrix result(numCol, n);
+	double *r = result.m;
+	const double *b = other.m;
 
-	for (int i = 0; i < result.getNumRow(); i++) {
-		for (int j = 0; j < result.getNumCol(); j++) {
-			curSum = 0;
-			for (int k = 0; k < numCol; k++) {
-				curSum = curSum + m[indexOf(i, k)] * other(k, j);
+	for (int i = 0; i < numRow; i++) {
+		const double *a = m + (int64_t) i * numCol;
+		const double *bi = b + (int64_t) i * n;
+		for (int c = 0; c < numCol; c++) {
+			double aic = a[c];
+			double *rc = r + (int64_t) c * n;
+#pragma omp simd
+			for (int j = 0; j < n; j++) {
+				rc[j] += aic * bi[j];
 			}
-			result(i, j) = curSum;
 		}
 	}
 
 	return result;
 }
 
+/**
+ * The transpose of this x this in one pass over the rows. Only the upper
+ * triangle is accumulated; it is mirrored at the end.
+ */
+Matrix Matrix::gram() const {
+	Matrix result(numCol, numCol);
+	double *r = result.m;
+
+	for (int i = 0; i < numRow; i++) {
+		const double *a = m + (int64_t) i * numCol;
+		for (int c = 0; c < numCol; c++) {
+			double aic = a[c];
+			double *rc = r + (int64_t) c * numCol;
+#pragma omp simd
+			for (int j = c; j < numCol; j++) {
+				rc[j] += aic * a[j];
+			}
+		}
+	}
+
+	for (int c = 0; c < numCol; c++) {
+		for (int j = c + 1; j < numCol; j++) {
+			r[(int64_t) j * numCol + c] = r[(int64_t) c * numCol + j];
+		}
+	}
+
+	return result;
+}
+
+/**
+ * Cholesky decomposition (this = L x the transpose of L) followed by
+ * forward and backward substitution. Returns false, without changing x,
+ * if the matrix is not positive definite or it is nearly singular.
+ */
+bool Matrix::solveCholesky(const Matrix &b, Matrix &x) const {
+	if (numRow != numCol || b.getNumRow() != numRow) {
+		std::cerr << "Invalid input: Matrix dimension mismatch." << std::endl;
+		throw std::exception();
+	}
+
+	int p = numRow;
+	Matrix l(p, p);
+	double *lm = l.m;
+	for (int j = 0; j < p; j++) {
+		const double *lj = lm + (int64_t) j * p;
+		double d = m[indexOf(j, j)];
+		for (int k = 0; k < j; k++) {
+			d -= lj[k] * lj[k];
+		}
+		if (!(d > SINGULAR * m[indexOf(j, j)])) {
+			return false;
+		}
+		double pivot = std::sqrt(d);
+		lm[(int64_t) j * p + j] = pivot;
+
+		for (int i = j + 1; i < p; i++) {
+			const double *li = lm + (int64_t) i * p;
+			double v = m[indexOf(i, j)];
+			for (int k = 0; k < j; k++) {
+				v -= li[k] * lj[k];
+			}
+			lm[(int64_t) i * p + j] = v / pivot;
+		}
+	}
+
+	int n = b.getNumCol();
+	Matrix y(b);
+	double *ym = y.m;
+	for (int c = 0; c < n; c++) {
+		// L z = b
+		for (int i = 0; i < p; i++) {
+			double v = ym[(int64_t) i * n + c];
+			for (int k = 0; k < i; k++) {
+				v -= lm[(int64_t) i * p + k] * ym[(int64_t) k * n + c];
+			}
+			ym[(int64_t) i * n + c] = v / lm[(int64_t) i * p + i];
+		}
+		// The transpose of L x = z
+		for (int i = p - 1; i >= 0; i--) {
+			double v = ym[(int64_t) i * n + c];
+			for (int k = i + 1; k < p; k++) {
+				v -= lm[(int64_t) k * p + i] * ym[(int64_t) k * n + c];
+			}
+			ym[(int64_t) i * n + c] = v / lm[(int64_t) i * p + i];
+		}
+	}
+
+	x = y;
+	return true;
+}
+
+/**
+ * Householder QR of this matrix. The transposes of this matrix and of b
+ * are factorized, so a column is contiguous. The weight of a column that
+ * depends on the previous ones is zero.
+ */
+Matrix Matrix::solveLeastSquares(const Matrix &b) const {
+	if (b.getNumRow() != numRow) {
+		std::cerr << "Invalid input: Matrix dimension mismatch." << std::endl;
+		throw std::exception();
+	}
+
+	int p = numCol;
+	int n = b.getNumCol();
+	Matrix a = this->operator~();
+	Matrix c = ~b;
+	double *am = a.m;
+	double *cm = c.m;
+	std::vector<double> v(numRow);
+	std::vector<double> diagonal(p, 0.0);
+
+	int stepNum = std::min(numRow, p);
+	for (int j = 0; j < stepNum; j++) {
+		double *aj = am + (int64_t) j * numRow;
+		double norm = 0.0;
+		for (int i = j; i < numRow; i++) {
+			norm += aj[i] * aj[i];
+		}
+		norm = std::sqrt(norm);
+		if (norm == 0.0) {
+			continue;
+		}
+
+		double alpha = aj[j] > 0 ? -norm : norm;
+		double vNorm = 0.0;
+		for (int i = j; i < numRow; i++) {
+			v[i] = aj[i];
+		}
+		v[j] -= alpha;
+		for (int i = j; i < numRow; i++) {
+			vNorm += v[i] * v[i];
+		}
+		diagonal[j] = alpha;
+		if (vNorm == 0.0) {
+			continue;
+		}
+
+		// Reflect the following columns of this matrix and b
+		auto reflect = [&](double *col) {
+			double s = 0.0;
+#pragma omp simd reduction(+:s)
+			for (int i = j; i < numRow; i++) {
+				s += v[i] * col[i];
+			}
+			s = 2.0 * s / vNorm;
+#pragma omp simd
+			for (int i = j; i < numRow; i++) {
+				col[i] -= s * v[i];
+			}
+		};
+		for (int k = j + 1; k < p; k++) {
+			reflect(am + (int64_t) k * numRow);
+		}
+		for (int k = 0; k < n; k++) {
+			reflect(cm + (int64_t) k * numRow);
+		}
+	}
+
+	double maxPivot = 0.0;
+	for (int j = 0; j < stepNum; j++) {
+		maxPivot = std::max(maxPivot, std::fabs(diagonal[j]));
+	}
+
+	// R x = the first p rows of the transpose of Q x b
+	Matrix x(p, n);
+	for (int k = 0; k < n; k++) {
+		const double *ck = cm + (int64_t) k * numRow;
+		for (int j = stepNum - 1; j >= 0; j--) {
+			if (std::fabs(diagonal[j]) <= SINGULAR * maxPivot) {
+				continue;
+			}
+			double s = ck[j];
+			for (int h = j + 1; h < stepNum; h++) {
+				// R(j, h) is in row h of the transpose
+				s -= am[(int64_t) h * numRow + j] * x(h, k);
+			}
+			x(j, k) = s / diagonal[j];
+		}
+	}
+
+	return x;
+}
+
 /**
  * Returns an object allocated on the heap
  * It is the client's responsibility to free memory allocated to it
@@ -63,6 +63,15 @@ public:
 	Matrix operator!() const; // Inverse
 	Matrix pseudoInverse() const;
 
+	// Products without making the transpose
+	Matrix transposeTimes(const Matrix&) const; // The transpose of this x n
+	Matrix gram() const; // The transpose of this x this
+
+	// Solve this x = b for a symmetric positive-definite matrix
+	bool solveCholesky(const Matrix &b, Matrix &x) const;
+	// Find x minimizing ||this x - b|| by Householder QR
+	Matrix solveLeastSquares(const Matrix &b) const;
+
 	// Returns a matrix allocated on the heap
 	Matrix* times(const Matrix*) const;
 	Matrix* transpose() const;
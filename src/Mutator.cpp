@@ -28,10 +28,10 @@
  * The composition list is constructed from the input sequence
  */
 Mutator::Mutator(const string *oSequenceIn, int maxBlockIn, int seed,
-		int minBlockIn) {
+		int minBlockIn, const SegmentList *segmentListIn) {
 	oSequence = oSequenceIn;
 	makeCompositionList();
-	help(maxBlockIn, seed, minBlockIn);
+	help(maxBlockIn, seed, minBlockIn, segmentListIn);
 }
 
 /**
@@ -42,10 +42,14 @@ Mutator::Mutator(const string *oSequenceIn, int maxBlockIn, int seed,
 	oSequence = oSequenceIn;
 	compositionList = compositionListIn;
 	ownCompositionList = false;
-	help(maxBlockIn, seed, minBlockIn);
+	help(maxBlockIn, seed, minBlockIn, nullptr);
 }
 
-void Mutator::help(int maxBlockIn, int seed, int minBlockIn) {
+/**
+ * segmentListIn: The valid segments as found by FastaReader or nullptr.
+ */
+void Mutator::help(int maxBlockIn, int seed, int minBlockIn,
+		const SegmentList *segmentListIn) {
 	// Preconditions
 	if (maxBlockIn <= 1) {
 		cerr << "The maximum block size must be greater than 1" << endl;
@@ -72,23 +76,12 @@ void Mutator::help(int maxBlockIn, int seed, int minBlockIn) {
 	translocationFactor = Parameters::getTranslocationFactor();
 
 	// Segment coordinates are inclusive [s,e]
-	// This peace of code is duplicated in KmerHistogram
 	unknown = Parameters::getUnknown();
-	segmentList = new vector<pair<int, int> >();
-	// Store non-N/non-X index
-	int start = -1;
-	int oLen = oSequence->size();
-	for (unsigned int i = 0; i < oLen; i++) {
-		if (oSequence->at(i) != unknown && start == -1) {
-			start = i;
-		} else if (oSequence->at(i) == unknown && start != -1) {
-			segmentList->push_back(make_pair(start, i - 1));
-			start = -1;
-		} else if (i == oLen - 1 && oSequence->at(i) != unknown
-				&& start != -1) {
-			segmentList->push_back(make_pair(start, i));
-			start = -1;
-		}
+	if (segmentListIn != nullptr && !segmentListIn->empty()) {
+		segmentList = new SegmentList(*segmentListIn);
+	} else {
+		segmentList = new SegmentList();
+		Util::findSegments(oSequence, *segmentList);
 	}
 	// Post condition
 	if (segmentList->empty()) {
@@ -119,8 +112,13 @@ void Mutator::help(int maxBlockIn, int seed, int minBlockIn) {
 	tLimit = 1.0;
 
 	// Credit: https://en.cppreference.com/w/cpp/numeric/random/uniform_real_distribution
-	gen = new std::default_random_engine(seed);
-	zeroOneRand = new uniform_real_distribution<>(0.0, 1.0);
+	gen.seed(seed);
+	zeroOneRand = uniform_real_distribution<>(0.0, 1.0);
+
+	hasLowerCase = std::any_of(oSequence->begin(), oSequence->end(),
+			[](char c) {
+				return c >= 97;
+			});
 }
 
 void Mutator::makeCompositionList() {
@@ -187,16 +185,13 @@ Mutator::~Mutator() {
 
 	segmentList->clear();
 	delete segmentList;
-
-	delete gen;
-	delete zeroOneRand;
 }
 
 /*
  * Return a nucleotide according to the distribution of the original sequence.
  */
 char Mutator::getRandomNucleotide() {
-	double p = (*zeroOneRand)(*gen);
+	double p = zeroOneRand(gen);
 	char r;
 	if (p <= aLimit) {
 		r = 'A';
@@ -234,10 +229,26 @@ char Mutator::getRandomNucleotide() {
  * . Randomization has been fixed, i.e. the same sequences are produced using the same seed.
  */
 pair<string*, double> Mutator::mutateSequence(double mutationRate) {
+	string *mSequence = new string();
+	double identity = mutateSequence(mutationRate, *mSequence);
+	// Trim extra space that was allocated for the mutations
+	mSequence->shrink_to_fit();
+	return std::make_pair(mSequence, identity);
+}
+
+/**
+ * Same as the above method, but the mutated sequence is written to a
+ * buffer owned by the client, which can be reused for the next sequence.
+ * Unchanged runs are copied directly from the original sequence.
+ * Returns the identity score.
+ */
+double Mutator::mutateSequence(double mutationRate, string &mSequence) {
+	mSequence.clear();
+
 	// Added on 6/7/2021
 	if (Util::isEqual(mutationRate, 0.0)) {
-		string *mSequence = new string(*oSequence);
-		return make_pair(mSequence, 1.0);
+		mSequence.append(*oSequence);
+		return 1.0;
 	}
 
 	// Pre-conditions
@@ -260,13 +271,7 @@ pair<string*, double> Mutator::mutateSequence(double mutationRate) {
 
 	int oLength = oSequence->length();
 
-	string *mSequence = new string("");
-
-	// Delete if good
-	// mSequenceList->push_back(mSequence);
-
-	// Extra space is trimmed at the end of this method.
-	mSequence->reserve(oSequence->size() + mutationTotal);
+	mSequence.reserve(oSequence->size() + mutationTotal);
 
 	// This vector holds the locations of the deleted segments.
 	vector<pair<int, int> > deleteList;
@@ -291,7 +296,7 @@ pair<string*, double> Mutator::mutateSequence(double mutationRate) {
 
 	double identity = 0.0;
 	if (mutationTotal < 1) {
-		mSequence->append(*oSequence);
+		mSequence.append(*oSequence);
 		identity = 1.0;
 	} else {
 		int segIndex = 0;
@@ -318,14 +323,12 @@ pair<string*, double> Mutator::mutateSequence(double mutationRate) {
 			}
 			// If no valid index found
 			if (index >= oLength || oSequence->at(index) == unknown) {
-				mSequence->append(
-						oSequence->substr(oldIndex, oLength - oldIndex));
+				appendOriginal(mSequence, oldIndex, oLength - oldIndex);
 				break;
 			}
 			// If some indexes are skipped, copy the in-between region
 			if (index != oldIndex) {
-				mSequence->append(
-						oSequence->substr(oldIndex, index - oldIndex));
+				appendOriginal(mSequence, oldIndex, index - oldIndex);
 			}
 			// Find the correct segment. The end is needed to limit the
 			// random block size.
@@ -342,12 +345,12 @@ pair<string*, double> Mutator::mutateSequence(double mutationRate) {
 			}
 
 			// Select mutation type randomly
-			int mutationType = mutationList->at(randMutIndexDist(*gen));
+			int mutationType = mutationList->at(randMutIndexDist(gen));
 			// Translocation depends on block deletion.
 			// Choose another mutation type if translocation is selected but
 			// the delete list is empty.
 			while (mutationType == Mutation::TRANSLOCATION && deleteList.empty()) {
-				mutationType = mutationList->at(randMutIndexDist(*gen));
+				mutationType = mutationList->at(randMutIndexDist(gen));
 			}
 
 			int randBlockSize;
@@ -355,7 +358,7 @@ pair<string*, double> Mutator::mutateSequence(double mutationRate) {
 			// Variables for block mutations
 			if (mutationType > Mutation::MISMATCH) {
 				// Calculate random block size minBlock–-maxBlock
-				randBlockSize = randBlockSizeDist(*gen);
+				randBlockSize = randBlockSizeDist(gen);
 
 				// Make sure that the random block size is not greater than the number
 				// of nucleotides need to be mutated.
@@ -396,9 +399,9 @@ pair<string*, double> Mutator::mutateSequence(double mutationRate) {
 			case Mutation::INSERTION: {
 				isBlockMutation = false;
 				// Insert a random nucleotide
-				mSequence->append(1, getRandomNucleotide());
+				mSequence.push_back(getRandomNucleotide());
 				// Copy from index to the next index - 1
-				mSequence->append(oSequence->substr(index, nextIndex - index));
+				appendOriginal(mSequence, index, nextIndex - index);
 				// Update alignment length only
 				alignLen += 1;
 			}
@@ -407,8 +410,7 @@ pair<string*, double> Mutator::mutateSequence(double mutationRate) {
 				isBlockMutation = false;
 
 				// Copy from index+1 to the next index - 1
-				mSequence->append(
-						oSequence->substr(index + 1, nextIndex - index - 1));
+				appendOriginal(mSequence, index + 1, nextIndex - index - 1);
 				// Update number of matches only
 				matchNum -= 1;
 			}
@@ -416,10 +418,9 @@ pair<string*, double> Mutator::mutateSequence(double mutationRate) {
 			case Mutation::MISMATCH: {
 				isBlockMutation = false;
 				char randChar = getRandomNucleotide();
-				mSequence->append(1, randChar);
+				mSequence.push_back(randChar);
 				// Copy from index to the next index - 1
-				mSequence->append(
-						oSequence->substr(index + 1, nextIndex - index - 1));
+				appendOriginal(mSequence, index + 1, nextIndex - index - 1);
 
 				// ToDo: check to see if the new character is the same as
 				// the old one and update the number of matches. I allowed this
@@ -433,18 +434,17 @@ pair<string*, double> Mutator::mutateSequence(double mutationRate) {
 				break;
 			case Mutation::B_INSERTION: {
 				for (int h = 0; h < randBlockSize; h++) {
-					mSequence->append(1, getRandomNucleotide());
+					mSequence.push_back(getRandomNucleotide());
 				}
 
-				mSequence->append(oSequence->substr(index, nextIndex - index));
+				appendOriginal(mSequence, index, nextIndex - index);
 				// Update alignment length only
 				alignLen += randBlockSize;
 			}
 				break;
 			case Mutation::B_DELETION: {
-				mSequence->append(
-						oSequence->substr(index + randBlockSize,
-								nextIndex - index - randBlockSize));
+				appendOriginal(mSequence, index + randBlockSize,
+						nextIndex - index - randBlockSize);
 				deleteList.push_back(
 						make_pair(index, index + randBlockSize - 1));
 				// Update number of matches only
@@ -453,34 +453,31 @@ pair<string*, double> Mutator::mutateSequence(double mutationRate) {
 				break;
 			case Mutation::DUPLICATION: {
 				// Copy the block
-				mSequence->append(oSequence->substr(index, randBlockSize));
+				appendOriginal(mSequence, index, randBlockSize);
 
 				// Copy the segment starting with the block
-				mSequence->append(oSequence->substr(index, nextIndex - index));
+				appendOriginal(mSequence, index, nextIndex - index);
 				// Update alignment length only
 				alignLen += randBlockSize;
 			}
 				break;
 			case Mutation::INVERSION: {
-				// Invert the segment
-				string seg("");
-				seg.reserve(randBlockSize);
+				// Invert the segment in place
+				int segStart = mSequence.size();
 				for (int h = index + randBlockSize - 1; h >= index; h--) {
-					seg.append(1, oSequence->at(h));
+					mSequence.push_back(oSequence->at(h));
 				}
 
-				mSequence->append(seg);
-
-				mSequence->append(
-						oSequence->substr(index + randBlockSize,
-								nextIndex - index - randBlockSize));
+				appendOriginal(mSequence, index + randBlockSize,
+						nextIndex - index - randBlockSize);
+				const char *seg = mSequence.data() + segStart;
 
 				// Inversion should be treated in a similar way to mismatch.
 				// However, it should consider that fact that all nucleotides
 				// are still present, but in the opposite direction.
 				double misMatch = 0.0; // Number of mismatches
 				for (int h = index; h < index + randBlockSize; h++) {
-					if (oSequence->at(h) != seg.at(h - index)) {
+					if (oSequence->at(h) != seg[h - index]) {
 						misMatch++;
 					}
 				}
@@ -493,12 +490,11 @@ pair<string*, double> Mutator::mutateSequence(double mutationRate) {
 				pair<int, int> segment = deleteList.back();
 				// Copy a deleted block
 
-				mSequence->append(
-						oSequence->substr(segment.first,
-								segment.second - segment.first + 1));
+				appendOriginal(mSequence, segment.first,
+						segment.second - segment.first + 1);
 
 				// Copy the original segment
-				mSequence->append(oSequence->substr(index, nextIndex - index));
+				appendOriginal(mSequence, index, nextIndex - index);
 				deleteList.pop_back();
 
 				// Update alignment length and match number
@@ -526,14 +522,27 @@ pair<string*, double> Mutator::mutateSequence(double mutationRate) {
 		}
 		identity = matchNum / alignLen;
 	}
-	// Trim extra space that was allocated at the beginning of this method
-	mSequence->shrink_to_fit();
-	// Convert the mutated string to upper case
+	// Convert the mutated string to upper case. Random nucleotides are
+	// upper case; so only a lower case original needs it.
 	// Based on code found at https://thispointer.com
-	std::for_each(mSequence->begin(), mSequence->end(), [](char &c) {
-		if (c >= 97)
-			c = ::toupper(c);
-	});
+	if (hasLowerCase) {
+		std::for_each(mSequence.begin(), mSequence.end(), [](char &c) {
+			if (c >= 97)
+				c = ::toupper(c);
+		});
+	}
 
-	return std::make_pair(mSequence, identity);
+	return identity;
+}
+
+/**
+ * Copy count characters of the original sequence starting at start.
+ * The count is clipped as std::string::substr does.
+ */
+void Mutator::appendOriginal(string &mSequence, int start, int count) const {
+	int oLength = oSequence->length();
+	if (count < 0 || count > oLength - start) {
+		count = oLength - start;
+	}
+	mSequence.append(oSequence->data() + start, count);
 }
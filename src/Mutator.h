@@ -55,7 +55,7 @@ private:
 	bool ownCompositionList;
 	vector<double> * compositionList;
 	// A list holding pairs of valid segments, which do not include N or X.
-	vector< pair<int,int> > * segmentList;
+	SegmentList * segmentList;
 
 	// When the block size is small (e.g. < 5 nucleotides), the single point
 	// mutation model is very realistic
@@ -65,21 +65,28 @@ private:
 	char unknown;
 	int effectiveLength = 0;
 
-	default_random_engine * gen;
-	uniform_real_distribution<> * zeroOneRand;
+	// Each mutator has its own generator; so one mutator per thread needs
+	// no locking
+	default_random_engine gen;
+	uniform_real_distribution<> zeroOneRand;
+
+	// The mutated sequence needs to be converted to upper case
+	bool hasLowerCase;
 
 	double translocationFactor;
 	double inversionFactor;
 
 	char getRandomNucleotide();
 	void makeCompositionList();
-	void help(int, int , int);
+	void help(int, int , int, const SegmentList *);
+	void appendOriginal(string&, int, int) const;
 
 public:
 	enum Mutation {INSERTION, DELETION, MISMATCH, B_INSERTION,
 		B_DELETION, DUPLICATION, INVERSION, TRANSLOCATION};
 
-	Mutator(const string *, int, int , int minBlockIn = 2);
+	Mutator(const string *, int, int , int minBlockIn = 2,
+			const SegmentList *segmentListIn = nullptr);
 	Mutator(const string *, int, int , vector<double> *,int minBlockIn = 2);
 	virtual ~Mutator();
 	void enableSinglePoint();
@@ -88,6 +95,7 @@ public:
 	void enableTranslocation();
 
 	pair<string*, double> mutateSequence(double);
+	double mutateSequence(double, string&);
 };
 
 #endif /* MUTATOR_H_ */
@@ -25,152 +25,107 @@
 
 Node::Node() {
 	size = 0;
-	list = nullptr;
+	std::fill(wordList, wordList + WORD_NUM, 0);
 }
 
 /**
  * l: An array of features
  * s: Size of feature array
  */
-Node::Node(int *l, int s) {
-	list = l;
-	size = s;
+Node::Node(const int *l, int s) {
+	size = 0;
+	std::fill(wordList, wordList + WORD_NUM, 0);
 
 	// Pre-condition: l must be sorted
-	for (int i = 0; i < size - 1; i++) {
-		if (list[i] >= list[i + 1]) {
+	for (int i = 0; i < s - 1; i++) {
+		if (l[i] >= l[i + 1]) {
 			std::cerr << "Node error: Unsorted array." << std::endl;
-			std::cerr << *this << std::endl;
 			throw std::exception();
 		}
 	}
-}
 
-Node::Node(const Node &n) {
-	size = n.size;
-	list = new int[size];
-	for (int i = 0; i < size; i++) {
-		list[i] = n.list[i];
-	}
-}
-
-Node::Node(Node &&n) {
-	size = n.size;
-	list = n.list;
-	n.list = nullptr;
-}
-
-Node::~Node() {
-	if (list != nullptr) {
-		delete[] list;
+	for (int i = 0; i < s; i++) {
+		checkFeature(l[i]);
+		wordList[l[i] / 64] |= 1ULL << (l[i] % 64);
 	}
+	size = s;
 }
 
-Node& Node::operator=(const Node &n) {
-	if (list != nullptr) {
-		delete[] list;
+void Node::checkFeature(int f) {
+	if (f < 0) {
+		std::cerr << "Node error: A feature number must be non negative.";
+		std::cerr << std::endl;
+		throw std::exception();
 	}
 
-	size = n.size;
-	list = new int[size];
-	for (int i = 0; i < size; i++) {
-		list[i] = n.list[i];
+	if (f >= MAX_FEATURE) {
+		std::cerr << "Node error: A node can hold up to " << MAX_FEATURE;
+		std::cerr << " features, but received feature " << f << "."
+				<< std::endl;
+		throw std::exception();
 	}
+}
 
-	return *this;
+bool Node::has(int f) const {
+	return (wordList[f / 64] >> (f % 64)) & 1ULL;
 }
 
 /**
  * Construct a new node with the specified feature deleted
- * The resulting feature list is sorted
  */
-Node Node::del(int f) {
+Node Node::del(int f) const {
 	if (size == 0) {
 		std::cerr << "Node error: Cannot perform delete on empty node.";
 		std::cerr << std::endl;
 		throw std::exception();
 	}
+	checkFeature(f);
 
-	if (f < 0) {
-		std::cerr << "Node error: A feature number must be non negative.";
-		std::cerr << std::endl;
-		throw std::exception();
-	}
-
-	int *l = new int[size - 1];
-	int j = 0;
-	for (int i = 0; i < size; i++) {
-		if (list[i] != f) {
-			l[j] = list[i];
-			j++;
-		}
+	Node n(*this);
+	if (has(f)) {
+		n.wordList[f / 64] &= ~(1ULL << (f % 64));
+		n.size--;
 	}
-
-	return Node(l, size - 1);
+	return n;
 }
 
 /**
  * Construct a new node the specified feature added
- * The resulting feature list is sorted
  */
-Node Node::add(int f) {
-	if (f < 0) {
-		std::cerr << "Node error: A feature number must be non negative.";
-		std::cerr << std::endl;
-		throw std::exception();
-	}
-
-	// Find index for new feature
-	int i = 0;
-	for (; i < size; i++) {
-		if (list[i] > f) {
-			break;
-		}
-	}
-	// Construct the new node
-	int *l = new int[size + 1];
-	l[i] = f;
-
-	for (int j = 0; j < i; j++) {
-		l[j] = list[j];
-	}
+Node Node::add(int f) const {
+	checkFeature(f);
 
-	for (int j = i + 1; j < size + 1; j++) {
-		l[j] = list[j - 1];
+	Node n(*this);
+	if (!has(f)) {
+		n.wordList[f / 64] |= 1ULL << (f % 64);
+		n.size++;
 	}
-
-	return Node(l, size + 1);
+	return n;
 }
 
 /**
  * Perform the deletion and the addition operation on this node
  */
-std::vector<Node> Node::expand(int fNum) {
+std::vector<Node> Node::expand(int fNum) const {
 	if (fNum <= 0) {
 		std::cerr << "Node error: Feature number must be positive.";
 		std::cerr << std::endl;
 		throw std::exception();
 	}
+	checkFeature(fNum - 1);
 
 	std::vector<Node> l;
 	l.reserve(fNum);
-	for (int i = 0; i < size; i++) {
-		l.push_back(this->del(list[i]));
+	for (int f = 0; f < fNum; f++) {
+		if (has(f)) {
+			l.push_back(del(f));
+		}
 	}
 
-	int i = 0;
-	int f = 0;
-	while (f < fNum) {
-		int limit = fNum;
-		if (i < size) {
-			limit = list[i];
-			i++;
-		}
-		for (int j = f; j < limit; j++, f++) {
-			Node n = this->add(j);
-			l.push_back(n);
+	for (int f = 0; f < fNum; f++) {
+		if (!has(f)) {
+			l.push_back(add(f));
 		}
-		f++; // Skip list[i]
 	}
 
 	return l;
@@ -180,46 +135,41 @@ int Node::getSize() const {
 	return size;
 }
 
-/**
- * Internal array must be sorted
- */
 bool Node::operator==(const Node &other) const {
-	bool r = false;
-	if (other.getSize() == size) {
-		const int *oList = other.getList();
-		for (int i = 0; i < size; i++) {
-			if (oList[i] != list[i]) {
-				r = false;
-				break;
-			} else {
-				r = true;
-			}
-		}
-	}
-	return r;
+	return size == other.size
+			&& std::equal(wordList, wordList + WORD_NUM, other.wordList);
 }
 
-const int* Node::getList() const {
-	return list;
+std::vector<int> Node::getList() const {
+	std::vector<int> l;
+	l.reserve(size);
+	for (int w = 0; w < WORD_NUM; w++) {
+		uint64_t word = wordList[w];
+		while (word != 0) {
+			l.push_back(w * 64 + __builtin_ctzll(word));
+			word &= word - 1;
+		}
+	}
+	return l;
 }
 
 /**
  * Credit: https://stackoverflow.com/questions/12840975/hashing-an-unordered-sequence-of-small-integers
  */
-size_t NodeHasher::operator()(const Node &n) const {
+size_t Node::hash() const {
 	std::size_t result = 0;
-	const int *l = n.getList();
-	int s = n.getSize();
-
-	for (int i = 0; i < s; i++) {
-		result ^= l[i] + 0x9e3779b9 + (result << 6) + (result >> 2);
+	for (int w = 0; w < WORD_NUM; w++) {
+		result ^= wordList[w] + 0x9e3779b9 + (result << 6) + (result >> 2);
 	}
-
+	// The set uses the low bits; mix the high bits into them
+	result ^= result >> 33;
+	result *= 0xff51afd7ed558ccdULL;
+	result ^= result >> 33;
 	return result;
 }
 
 std::ostream& operator<<(std::ostream &os, const Node &n) {
-	const int *l = n.getList();
+	std::vector<int> l = n.getList();
 	for (int i = 0; i < n.getSize(); i++) {
 		os << l[i];
 		if (i != n.getSize() - 1) {
@@ -228,3 +178,65 @@ std::ostream& operator<<(std::ostream &os, const Node &n) {
 	}
 	return os;
 }
+
+NodeSet::NodeSet() {
+	count = 0;
+	slotList.resize(64);
+	isUsedList.resize(64, false);
+}
+
+/**
+ * The index of the node or of the empty slot where it belongs
+ */
+size_t NodeSet::find(const Node &n) const {
+	size_t mask = slotList.size() - 1;
+	size_t i = n.hash() & mask;
+	while (isUsedList[i] && !(slotList[i] == n)) {
+		i = (i + 1) & mask;
+	}
+	return i;
+}
+
+bool NodeSet::insert(const Node &n) {
+	// Keep the load factor at most one half
+	if (2 * (count + 1) > slotList.size()) {
+		grow();
+	}
+
+	size_t i = find(n);
+	if (isUsedList[i]) {
+		return false;
+	}
+	slotList[i] = n;
+	isUsedList[i] = true;
+	count++;
+	return true;
+}
+
+bool NodeSet::contains(const Node &n) const {
+	return isUsedList[find(n)];
+}
+
+void NodeSet::grow() {
+	std::vector<Node> oldSlotList(2 * slotList.size());
+	std::vector<bool> oldIsUsedList(2 * slotList.size(), false);
+	oldSlotList.swap(slotList);
+	oldIsUsedList.swap(isUsedList);
+
+	for (size_t i = 0; i < oldSlotList.size(); i++) {
+		if (oldIsUsedList[i]) {
+			size_t j = find(oldSlotList[i]);
+			slotList[j] = oldSlotList[i];
+			isUsedList[j] = true;
+		}
+	}
+}
+
+size_t NodeSet::size() const {
+	return count;
+}
+
+void NodeSet::clear() {
+	count = 0;
+	std::fill(isUsedList.begin(), isUsedList.end(), false);
+}
@@ -19,6 +19,9 @@
  *  Created on: Apr 28, 2020
  *      Author: Dr. Hani Z. Girgis
  *     Purpose: A graph node for the best-first search algorithm
+ *
+ *  A node is a set of features stored as a fixed-width bitset; so copying,
+ *  expanding, comparing and hashing nodes do not allocate memory.
  */
 
 #ifndef NODE_H_
@@ -27,36 +30,60 @@
 #include <vector>
 #include <iostream>
 #include <algorithm>
+#include <cstdint>
 
 class Node {
+public:
+	static const int WORD_NUM = 32;
+	// The largest number of features a node can hold
+	static const int MAX_FEATURE = 64 * WORD_NUM;
+
 private:
 	int size;
-	int *list;
+	uint64_t wordList[WORD_NUM];
+
+	static void checkFeature(int);
 
 public:
 	Node();
-	Node(int*, int);
-	Node(const Node&);
-	Node(Node&&);
-	virtual ~Node();
-
-	Node& operator=(const Node &n);
+	Node(const int*, int);
 
 	int getSize() const;
 	bool operator==(const Node &other) const;
-	const int* getList() const;
+	bool has(int) const;
+	/**
+	 * The features in ascending order
+	 */
+	std::vector<int> getList() const;
+	size_t hash() const;
 
-	Node del(int);
-	Node add(int);
-	std::vector<Node> expand(int);
+	Node del(int) const;
+	Node add(int) const;
+	std::vector<Node> expand(int) const;
 };
 
-class NodeHasher {
+/**
+ * A set of nodes in one array (open addressing and linear probing)
+ */
+class NodeSet {
+private:
+	std::vector<Node> slotList;
+	std::vector<bool> isUsedList;
+	size_t count;
+
+	size_t find(const Node&) const;
+	void grow();
+
 public:
+	NodeSet();
+
 	/**
-	 * A hashing function for Node
+	 * Returns false if the node is already in the set
 	 */
-	size_t operator()(const Node &p) const;
+	bool insert(const Node&);
+	bool contains(const Node&) const;
+	size_t size() const;
+	void clear();
 };
 
 std::ostream& operator<<(std::ostream &os, const Node &n);
@@ -0,0 +1,366 @@
+/*
+ Identity 2.0 calculates DNA sequence identity scores rapidly without alignment.
+
+ Copyright (C) 2020-2022 Hani Z. Girgis, PhD
+
+ Academic use: Affero General Public License version 1.
+
+ Any restrictions to use for-profit or non-academics: Alternative commercial license is needed.
+
+ This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+ Please contact Dr. Hani Z. Girgis (hzgirgis@buffalo.edu) if you need more information.
+ */
+
+
+/*
+ * OutputShards.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Hani Z. Girgis, PhD
+ *
+ *  The merge is an external sort: the shards are read in runs that fit in
+ *  memory, each full run is sorted and saved, and the runs are merged.
+ */
+
+#include "OutputShards.h"
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <queue>
+#include <cstdio>
+#include <sys/stat.h>
+
+#include "FastaIndex.h"
+
+static const std::string TAG = "#identity-shards";
+static const int VERSION = 1;
+// Records sorted in memory at a time (256 MB)
+static const size_t RUN_SIZE = 1 << 24;
+// Records read from a run at a time while merging
+static const size_t READ_SIZE = 1 << 14;
+
+struct ShardRecord {
+	uint32_t id1;
+	uint32_t id2;
+	double score;
+};
+static_assert(sizeof(ShardRecord) == PairWriter::SHARD_RECORD_SIZE,
+		"A shard record must not be padded");
+
+/**
+ * Records are grouped by the first id. Within a group, they are sorted by
+ * the second id, or by the score (best first) if they are ranked hits.
+ */
+struct RecordOrder {
+	bool isRanked;
+
+	bool operator()(const ShardRecord &a, const ShardRecord &b) const {
+		if (a.id1 != b.id1) {
+			return a.id1 < b.id1;
+		}
+		if (isRanked && a.score != b.score) {
+			return a.score > b.score;
+		}
+		if (a.id2 != b.id2) {
+			return a.id2 < b.id2;
+		}
+		return a.score < b.score;
+	}
+};
+
+/**
+ * The size and the modification time identify the version of a file
+ */
+static std::string describeFile(const std::string &fileName) {
+	struct stat info;
+	if (stat(fileName.c_str(), &info) != 0) {
+		return "";
+	}
+	int64_t time = (int64_t) info.st_mtim.tv_sec * 1000000000
+			+ info.st_mtim.tv_nsec;
+	return std::to_string(info.st_size) + "\t" + std::to_string(time);
+}
+
+static std::string baseName(const std::string &path) {
+	size_t slash = path.rfind('/');
+	return slash == std::string::npos ? path : path.substr(slash + 1);
+}
+
+static std::string dirName(const std::string &path) {
+	size_t slash = path.rfind('/');
+	return slash == std::string::npos ? "" : path.substr(0, slash + 1);
+}
+
+OutputShards::OutputShards(std::string manifestNameIn, std::string firstFileIn,
+		std::string secondFileIn, bool isBinaryIn, int precisionIn,
+		bool isRankedIn) {
+	manifestName = manifestNameIn;
+	firstFile = firstFileIn;
+	secondFile = secondFileIn;
+	isBinary = isBinaryIn;
+	precision = precisionIn;
+	isRanked = isRankedIn;
+	isClosed = false;
+}
+
+OutputShards::~OutputShards() {
+	try {
+		close();
+	} catch (const std::exception&) {
+		// The error has been reported
+	}
+	for (auto shard : shardList) {
+		delete shard;
+	}
+}
+
+OutputWriter* OutputShards::getShard(int i) {
+	while ((int) shardList.size() <= i) {
+		std::string shardName = manifestName + ".shard."
+				+ std::to_string(shardList.size());
+		shardList.push_back(new OutputWriter(shardName));
+	}
+	return shardList[i];
+}
+
+void OutputShards::close() {
+	if (isClosed) {
+		return;
+	}
+	isClosed = true;
+
+	for (auto shard : shardList) {
+		shard->close();
+	}
+	writeManifest();
+}
+
+void OutputShards::writeManifest() const {
+	std::ofstream out(manifestName);
+	out << TAG << "\t" << VERSION << "\n";
+	out << "format\t" << (isBinary ? "binary" : "text") << "\n";
+	out << "precision\t" << precision << "\n";
+	out << "order\t" << (isRanked ? "score" : "pair") << "\n";
+	out << "first\t" << firstFile << "\t" << describeFile(firstFile) << "\n";
+	out << "second\t" << secondFile << "\t" << describeFile(secondFile)
+			<< "\n";
+	for (size_t i = 0; i < shardList.size(); i++) {
+		out << "shard\t" << baseName(manifestName) << ".shard." << i << "\n";
+	}
+	out.close();
+
+	if (!out.good()) {
+		std::cerr << "OutputShards error: Cannot write to file: "
+				<< manifestName << std::endl;
+		throw std::exception();
+	}
+}
+
+/**
+ * Reads the records of a sorted run a few at a time. The last run is
+ * kept in memory.
+ */
+class RunReader {
+private:
+	std::ifstream in;
+	std::vector<ShardRecord> recordList;
+	size_t pos = 0;
+	bool isMemory;
+
+public:
+	RunReader(const std::string &runName) :
+			in(runName, std::ios::binary) {
+		isMemory = false;
+	}
+
+	RunReader(std::vector<ShardRecord> &run) {
+		recordList.swap(run);
+		isMemory = true;
+	}
+
+	bool next(ShardRecord &r) {
+		if (pos == recordList.size()) {
+			if (isMemory) {
+				return false;
+			}
+			recordList.resize(READ_SIZE);
+			in.read((char*) recordList.data(), READ_SIZE * sizeof(ShardRecord));
+			recordList.resize(in.gcount() / sizeof(ShardRecord));
+			pos = 0;
+			if (recordList.empty()) {
+				return false;
+			}
+		}
+		r = recordList[pos++];
+		return true;
+	}
+};
+
+static void writeRun(std::vector<ShardRecord> &recordList,
+		const std::string &runName, const RecordOrder &isBefore) {
+	std::sort(recordList.begin(), recordList.end(), isBefore);
+	std::ofstream out(runName, std::ios::binary);
+	out.write((const char*) recordList.data(),
+			recordList.size() * sizeof(ShardRecord));
+	out.close();
+	if (!out.good()) {
+		std::cerr << "OutputShards error: Cannot write to file: " << runName
+				<< std::endl;
+		throw std::exception();
+	}
+	recordList.clear();
+}
+
+void OutputShards::merge(std::string manifestName, std::string outFile,
+		std::string dlm) {
+	std::ifstream manifest(manifestName);
+	std::string tag;
+	int version = 0;
+	manifest >> tag >> version;
+	if (!manifest.good() || tag != TAG || version != VERSION) {
+		std::cerr << "OutputShards error: " << manifestName;
+		std::cerr << " is not a manifest of Identity shards." << std::endl;
+		throw std::exception();
+	}
+
+	bool isBinary = false;
+	int precision = 8;
+	RecordOrder isBefore = { false };
+	std::string fileList[2];
+	std::vector<std::string> shardList;
+	std::string line;
+	std::getline(manifest, line);
+	while (std::getline(manifest, line)) {
+		std::istringstream fields(line);
+		std::string key;
+		std::string value;
+		std::getline(fields, key, '\t');
+		std::getline(fields, value, '\t');
+		if (key == "format") {
+			isBinary = value == "binary";
+		} else if (key == "precision") {
+			precision = std::stoi(value);
+		} else if (key == "order") {
+			isBefore.isRanked = value == "score";
+		} else if (key == "first" || key == "second") {
+			std::string version;
+			std::getline(fields, version);
+			if (describeFile(value) != version) {
+				std::cerr << "OutputShards error: " << value;
+				std::cerr << " has changed since the shards were written."
+						<< std::endl;
+				throw std::exception();
+			}
+			fileList[key == "first" ? 0 : 1] = value;
+		} else if (key == "shard") {
+			shardList.push_back(dirName(manifestName) + value);
+		}
+	}
+
+	// Sort the shards in runs
+	std::vector<std::string> runList;
+	std::vector<ShardRecord> recordList;
+	for (auto &shardName : shardList) {
+		std::ifstream in(shardName, std::ios::binary);
+		if (!in.good()) {
+			std::cerr << "OutputShards error: Cannot open file: " << shardName
+					<< std::endl;
+			throw std::exception();
+		}
+		while (in.good()) {
+			size_t used = recordList.size();
+			size_t n = std::min(RUN_SIZE - used, 64 * READ_SIZE);
+			recordList.resize(used + n);
+			in.read((char*) (recordList.data() + used),
+					n * sizeof(ShardRecord));
+			recordList.resize(used + in.gcount() / sizeof(ShardRecord));
+			if (recordList.size() == RUN_SIZE) {
+				runList.push_back(
+						outFile + ".run." + std::to_string(runList.size()));
+				writeRun(recordList, runList.back(), isBefore);
+			}
+		}
+	}
+	std::sort(recordList.begin(), recordList.end(), isBefore);
+
+	// Headers are needed for the text format only
+	FastaIndex *firstIndex = nullptr;
+	FastaIndex *secondIndex = nullptr;
+	if (!isBinary) {
+		firstIndex = new FastaIndex(fileList[0]);
+		secondIndex =
+				fileList[1] == fileList[0] ?
+						firstIndex : new FastaIndex(fileList[1]);
+	}
+
+	OutputWriter out(outFile);
+	if (isBinary) {
+		PairWriter::writeTables(&out, fileList[0], fileList[1]);
+	}
+
+	{
+		PairWriter writer(&out,
+				isBinary ? PairWriter::BINARY : PairWriter::TEXT, dlm,
+				precision);
+		const std::string none;
+
+		// Merge the runs
+		auto isAfter = [&isBefore](const std::pair<ShardRecord, int> &a,
+				const std::pair<ShardRecord, int> &b) {
+			return isBefore(b.first, a.first);
+		};
+		std::priority_queue<std::pair<ShardRecord, int>,
+				std::vector<std::pair<ShardRecord, int> >, decltype(isAfter)> heap(
+				isAfter);
+		std::vector<RunReader*> readerList;
+		for (size_t i = 0; i < runList.size(); i++) {
+			readerList.push_back(new RunReader(runList[i]));
+		}
+		readerList.push_back(new RunReader(recordList));
+		for (size_t i = 0; i < readerList.size(); i++) {
+			ShardRecord r;
+			if (readerList[i]->next(r)) {
+				heap.push(std::make_pair(r, i));
+			}
+		}
+
+		while (!heap.empty()) {
+			auto top = heap.top();
+			heap.pop();
+			const ShardRecord &r = top.first;
+			if (isBinary) {
+				writer.write(none, r.id1, none, r.id2, r.score);
+			} else if (r.id1 < firstIndex->getCount()
+					&& r.id2 < secondIndex->getCount()) {
+				writer.write(firstIndex->getHeader(r.id1), r.id1,
+						secondIndex->getHeader(r.id2), r.id2, r.score);
+			} else {
+				std::cerr << "OutputShards error: Invalid sequence id in ";
+				std::cerr << manifestName << std::endl;
+				throw std::exception();
+			}
+
+			ShardRecord next;
+			if (readerList[top.second]->next(next)) {
+				heap.push(std::make_pair(next, top.second));
+			}
+		}
+
+		for (auto reader : readerList) {
+			delete reader;
+		}
+	}
+	out.close();
+
+	for (auto &runName : runList) {
+		remove(runName.c_str());
+	}
+	if (secondIndex != firstIndex) {
+		delete secondIndex;
+	}
+	delete firstIndex;
+}
@@ -0,0 +1,85 @@
+/*
+ Identity 2.0 calculates DNA sequence identity scores rapidly without alignment.
+
+ Copyright (C) 2020-2022 Hani Z. Girgis, PhD
+
+ Academic use: Affero General Public License version 1.
+
+ Any restrictions to use for-profit or non-academics: Alternative commercial license is needed.
+
+ This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+ Please contact Dr. Hani Z. Girgis (hzgirgis@buffalo.edu) if you need more information.
+ */
+
+
+/*
+ * OutputShards.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Hani Z. Girgis, PhD
+ *     Purpose: Each aligner thread writes its pairs to its own shard file,
+ *     so threads share nothing on the output path. The output file is a
+ *     manifest listing the shards in order. The merge step sorts the pairs
+ *     by the sequence ids (first, then second) and writes one text or
+ *     binary file, which is the same whatever the number of threads. The
+ *     best hits of a query (-k) are kept sorted by score instead.
+ *
+ *     The manifest is tab-separated text:
+ *     #identity-shards	version
+ *     format	text or binary
+ *     precision	digits of a score in the text format
+ *     order	pair (by the second id) or score (best first, ties by the id)
+ *     first	file providing the first column, its size, modification time
+ *     second	file providing the second column, its size, modification time
+ *     shard	file name relative to the manifest (one line per shard)
+ */
+
+#ifndef SRC_OUTPUTSHARDS_H_
+#define SRC_OUTPUTSHARDS_H_
+
+#include <string>
+#include <vector>
+
+#include "OutputWriter.h"
+#include "PairWriter.h"
+
+class OutputShards {
+private:
+	std::string manifestName;
+	std::string firstFile;
+	std::string secondFile;
+	bool isBinary;
+	int precision;
+	bool isRanked;
+	std::vector<OutputWriter*> shardList;
+	bool isClosed;
+
+	void writeManifest() const;
+
+public:
+	OutputShards(std::string, std::string, std::string, bool, int,
+			bool isRanked = false);
+	OutputShards(const OutputShards&) = delete;
+	OutputShards& operator=(const OutputShards&) = delete;
+	virtual ~OutputShards();
+
+	/**
+	 * The writer of a shard; it is created on the first request.
+	 * Not thread safe.
+	 */
+	OutputWriter* getShard(int);
+
+	/**
+	 * Close the shards and write the manifest
+	 */
+	void close();
+
+	/**
+	 * Merge the shards of a manifest into one sorted output file
+	 */
+	static void merge(std::string, std::string, std::string dlm = "\t");
+};
+
+#endif /* SRC_OUTPUTSHARDS_H_ */
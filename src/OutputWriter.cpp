@@ -0,0 +1,202 @@
+/*
+ Identity 2.0 calculates DNA sequence identity scores rapidly without alignment.
+
+ Copyright (C) 2020-2022 Hani Z. Girgis, PhD
+
+ Academic use: Affero General Public License version 1.
+
+ Any restrictions to use for-profit or non-academics: Alternative commercial license is needed.
+
+ This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+ Please contact Dr. Hani Z. Girgis (hzgirgis@buffalo.edu) if you need more information.
+ */
+
+/*
+ * OutputWriter.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Hani Z. Girgis, PhD
+ */
+
+#include "OutputWriter.h"
+
+#include <iostream>
+#include <algorithm>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <zlib.h>
+
+// Buffers waiting to be written before submitting threads are blocked
+static const size_t MAX_QUEUE = 64;
+// Fast compression, so the writer keeps up with the aligners
+static const int LEVEL = 1;
+
+OutputWriter::OutputWriter(std::string fileNameIn, int compressNumIn) {
+	fileName = fileNameIn;
+	isCompressed = isGzipName(fileName);
+	compressNum = std::max(1, compressNumIn);
+	byteNum = 0;
+	isClosed = false;
+	isFailed = false;
+
+	fd = open(fileName.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0) {
+		std::cerr << "OutputWriter error: Cannot open file: " << fileName
+				<< std::endl;
+		throw std::exception();
+	}
+
+	worker = std::thread(&OutputWriter::run, this);
+}
+
+OutputWriter::~OutputWriter() {
+	try {
+		close();
+	} catch (const std::exception&) {
+		// The error has been reported
+	}
+}
+
+void OutputWriter::submit(std::string *buffer) {
+	if (buffer->empty()) {
+		delete buffer;
+		return;
+	}
+
+	std::unique_lock<std::mutex> guard(lock);
+	hasRoom.wait(guard, [this]() {
+		return queue.size() < MAX_QUEUE;
+	});
+	queue.push_back(buffer);
+	hasWork.notify_one();
+}
+
+void OutputWriter::run() {
+	// The number of buffers compressed together
+	size_t batchSize = isCompressed ? 2 * compressNum : 1;
+	std::vector<std::string*> batch;
+	std::vector<std::string> zipList(batchSize);
+
+	while (true) {
+		{
+			std::unique_lock<std::mutex> guard(lock);
+			hasWork.wait(guard, [this]() {
+				return !queue.empty() || isClosed;
+			});
+			if (queue.empty()) {
+				break;
+			}
+			while (!queue.empty() && batch.size() < batchSize) {
+				batch.push_back(queue.front());
+				queue.pop_front();
+			}
+			hasRoom.notify_all();
+		}
+
+		if (isCompressed) {
+			int n = batch.size();
+#pragma omp parallel for schedule(dynamic) num_threads(compressNum)
+			for (int i = 0; i < n; i++) {
+				if (!compress(*batch[i], zipList[i])) {
+					isFailed = true;
+				}
+			}
+			for (int i = 0; i < n; i++) {
+				output(zipList[i]);
+			}
+		} else {
+			for (auto buffer : batch) {
+				output(*buffer);
+			}
+		}
+
+		for (auto buffer : batch) {
+			delete buffer;
+		}
+		batch.clear();
+	}
+
+	// An empty gzip file still needs one member
+	if (isCompressed && byteNum == 0) {
+		std::string empty;
+		if (compress(std::string(), empty)) {
+			output(empty);
+		} else {
+			isFailed = true;
+		}
+	}
+}
+
+void OutputWriter::output(const std::string &buffer) {
+	writeAll(buffer.data(), buffer.size());
+	byteNum += buffer.size();
+}
+
+/**
+ * Compress a buffer as a complete gzip member
+ */
+bool OutputWriter::compress(const std::string &in, std::string &out) const {
+	z_stream zs;
+	memset(&zs, 0, sizeof(zs));
+	// 16 + 15: a gzip header and a 32 KB window
+	if (deflateInit2(&zs, LEVEL, Z_DEFLATED, 16 + 15, 8, Z_DEFAULT_STRATEGY)
+			!= Z_OK) {
+		return false;
+	}
+
+	out.resize(deflateBound(&zs, in.size()));
+	zs.next_in = (Bytef*) in.data();
+	zs.avail_in = in.size();
+	zs.next_out = (Bytef*) &out[0];
+	zs.avail_out = out.size();
+	int r = deflate(&zs, Z_FINISH);
+	out.resize(zs.total_out);
+	deflateEnd(&zs);
+	return r == Z_STREAM_END;
+}
+
+void OutputWriter::writeAll(const char *data, size_t size) {
+	while (size > 0 && !isFailed) {
+		ssize_t n = write(fd, data, size);
+		if (n < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			isFailed = true;
+		} else {
+			data += n;
+			size -= n;
+		}
+	}
+}
+
+void OutputWriter::close() {
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		if (isClosed) {
+			return;
+		}
+		isClosed = true;
+	}
+	hasWork.notify_one();
+	worker.join();
+	::close(fd);
+
+	if (isFailed) {
+		std::cerr << "OutputWriter error: Cannot write to file: " << fileName
+				<< std::endl;
+		throw std::exception();
+	}
+}
+
+bool OutputWriter::getIsCompressed() const {
+	return isCompressed;
+}
+
+bool OutputWriter::isGzipName(std::string name) {
+	return name.size() > 3 && name.compare(name.size() - 3, 3, ".gz") == 0;
+}
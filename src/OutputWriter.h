@@ -0,0 +1,91 @@
+/*
+ Identity 2.0 calculates DNA sequence identity scores rapidly without alignment.
+
+ Copyright (C) 2020-2022 Hani Z. Girgis, PhD
+
+ Academic use: Affero General Public License version 1.
+
+ Any restrictions to use for-profit or non-academics: Alternative commercial license is needed.
+
+ This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+ Please contact Dr. Hani Z. Girgis (hzgirgis@buffalo.edu) if you need more information.
+ */
+
+/*
+ * OutputWriter.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Hani Z. Girgis, PhD
+ *     Purpose: Writes full buffers handed over by other threads to a file on
+ *     one background thread. Threads format their results into their own
+ *     buffers; so they never wait for each other or for the disk unless
+ *     the queue is full. Buffers are written in the order they are submitted.
+ *     If the file name ends with .gz, each buffer is compressed as an
+ *     independent gzip member (as pigz does); the members of a batch are
+ *     compressed in parallel by the writer thread. The file is a valid gzip
+ *     file, which gzip, zcat, and FastaReader read as one stream.
+ */
+
+#ifndef SRC_OUTPUTWRITER_H_
+#define SRC_OUTPUTWRITER_H_
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+
+class OutputWriter {
+private:
+	std::string fileName;
+	int fd;
+	// Compress the output by gzip on this number of threads
+	bool isCompressed;
+	int compressNum;
+	uint64_t byteNum;
+
+	std::deque<std::string*> queue;
+	std::mutex lock;
+	std::condition_variable hasWork;
+	std::condition_variable hasRoom;
+	bool isClosed;
+	std::atomic<bool> isFailed;
+	std::thread worker;
+
+	void run();
+	void output(const std::string&);
+	void writeAll(const char*, size_t);
+	bool compress(const std::string&, std::string&) const;
+
+public:
+	// The size a buffer grows to before it is submitted
+	static const size_t BUFFER_SIZE = 1 << 20;
+
+	OutputWriter(std::string, int compressNum = 1);
+	OutputWriter(const OutputWriter&) = delete;
+	OutputWriter& operator=(const OutputWriter&) = delete;
+	virtual ~OutputWriter();
+
+	/**
+	 * Thread safe. The writer takes over the buffer and deletes it.
+	 */
+	void submit(std::string*);
+
+	/**
+	 * Write the remaining buffers and close the file
+	 */
+	void close();
+
+	bool getIsCompressed() const;
+
+	/**
+	 * True if the file name ends with .gz
+	 */
+	static bool isGzipName(std::string);
+};
+
+#endif /* SRC_OUTPUTWRITER_H_ */
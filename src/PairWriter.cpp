@@ -0,0 +1,267 @@
+/*
+ Identity 2.0 calculates DNA sequence identity scores rapidly without alignment.
+
+ Copyright (C) 2020-2022 Hani Z. Girgis, PhD
+
+ Academic use: Affero General Public License version 1.
+
+ Any restrictions to use for-profit or non-academics: Alternative commercial license is needed.
+
+ This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+ Please contact Dr. Hani Z. Girgis (hzgirgis@buffalo.edu) if you need more information.
+ */
+
+/*
+ * PairWriter.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Hani Z. Girgis, PhD
+ */
+
+#include "PairWriter.h"
+
+#include <fstream>
+#include <iomanip>
+#include <vector>
+#include <cstring>
+#include <cstdio>
+#include <cmath>
+#include <charconv>
+#include <algorithm>
+#include <zlib.h>
+
+#include "FastaIndex.h"
+
+static const char MAGIC[8] = { 'I', 'D', 'P', 'A', 'I', 'R', 'S', 1 };
+
+/**
+ * Store the n low bytes of an integer in little-endian order, whatever the
+ * order of the host
+ */
+static inline void putLittle(char *out, uint64_t v, int n) {
+	for (int i = 0; i < n; i++) {
+		out[i] = (char) (v >> (8 * i));
+	}
+}
+
+static inline uint64_t getLittle(const char *in, int n) {
+	uint64_t v = 0;
+	for (int i = 0; i < n; i++) {
+		v |= (uint64_t) (unsigned char) in[i] << (8 * i);
+	}
+	return v;
+}
+
+static inline void appendLittle(std::string &out, uint64_t v, int n) {
+	char bytes[8];
+	putLittle(bytes, v, n);
+	out.append(bytes, n);
+}
+
+PairWriter::PairWriter(OutputWriter *outIn, Format formatIn,
+		std::string dlmIn, int precisionIn) {
+	out = outIn;
+	format = formatIn;
+	dlm = dlmIn;
+	precision = precisionIn;
+	buffer = new std::string();
+	buffer->reserve(OutputWriter::BUFFER_SIZE + 1024);
+}
+
+PairWriter::~PairWriter() {
+	flush();
+	delete buffer;
+}
+
+void PairWriter::flush() {
+	if (!buffer->empty()) {
+		out->submit(buffer);
+		buffer = new std::string();
+		buffer->reserve(OutputWriter::BUFFER_SIZE + 1024);
+	}
+}
+
+/**
+ * Same as std::setprecision(precision) in the default float format
+ */
+void PairWriter::appendScore(double score) {
+	char s[32];
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+	auto r = std::to_chars(s, s + sizeof(s), score, std::chars_format::general,
+			precision);
+	buffer->append(s, r.ptr - s);
+#else
+	int n = snprintf(s, sizeof(s), "%.*g", precision, score);
+	buffer->append(s, n);
+#endif
+}
+
+void PairWriter::write(std::string_view info1, uint32_t id1,
+		std::string_view info2, uint32_t id2, double score) {
+	if (format == SHARD) {
+		char record[SHARD_RECORD_SIZE];
+		memcpy(record, &id1, 4);
+		memcpy(record + 4, &id2, 4);
+		memcpy(record + 8, &score, 8);
+		buffer->append(record, SHARD_RECORD_SIZE);
+	} else if (format == BINARY) {
+		if (score > 1.0) {
+			score = 1.0;
+		} else if (score < 0.0) {
+			score = 0.0;
+		}
+		uint16_t s = std::round(score * SCALE);
+
+		char record[RECORD_SIZE];
+		putLittle(record, id1, 4);
+		putLittle(record + 4, id2, 4);
+		putLittle(record + 8, s, 2);
+		buffer->append(record, RECORD_SIZE);
+	} else {
+		buffer->append(info1);
+		buffer->append(dlm);
+		buffer->append(info2);
+		buffer->append(dlm);
+		appendScore(score);
+		buffer->push_back('\n');
+	}
+
+	if (buffer->size() >= OutputWriter::BUFFER_SIZE) {
+		flush();
+	}
+}
+
+static void writeTable(std::string &out, const FastaIndex &index) {
+	uint64_t count = index.getCount();
+	appendLittle(out, count, 8);
+	for (uint64_t i = 0; i < count; i++) {
+		std::string_view header = index.getHeader(i);
+		uint32_t len = header.size();
+		appendLittle(out, len, 4);
+		out.append(header);
+	}
+}
+
+void PairWriter::writeTables(OutputWriter *out, std::string firstFile,
+		std::string secondFile, int threadNum) {
+	uint32_t scale = SCALE;
+	uint32_t tableNum = firstFile == secondFile ? 1 : 2;
+	std::string *tables = new std::string();
+	tables->append(MAGIC, 8);
+	appendLittle(*tables, scale, 4);
+	appendLittle(*tables, tableNum, 4);
+
+	writeTable(*tables, FastaIndex(firstFile, threadNum));
+	if (tableNum == 2) {
+		writeTable(*tables, FastaIndex(secondFile, threadNum));
+	}
+	out->submit(tables);
+}
+
+/**
+ * Read up to n bytes; a gzip file is decompressed, any other is read as is.
+ * Returns the number of bytes read.
+ */
+static size_t readBytes(gzFile in, char *data, size_t n) {
+	size_t total = 0;
+	while (total < n) {
+		int r = gzread(in, data + total,
+				(unsigned int) std::min(n - total, (size_t) 1 << 30));
+		if (r <= 0) {
+			break;
+		}
+		total += r;
+	}
+	return total;
+}
+
+static bool readLittle(gzFile in, int n, uint64_t &v) {
+	char bytes[8];
+	if (readBytes(in, bytes, n) != (size_t) n) {
+		return false;
+	}
+	v = getLittle(bytes, n);
+	return true;
+}
+
+static bool readTable(gzFile in, std::vector<std::string> &table) {
+	uint64_t count = 0;
+	if (!readLittle(in, 8, count)) {
+		return false;
+	}
+	for (uint64_t i = 0; i < count; i++) {
+		uint64_t len = 0;
+		if (!readLittle(in, 4, len)) {
+			return false;
+		}
+		std::string header(len, '\0');
+		if (readBytes(in, &header[0], len) != len) {
+			return false;
+		}
+		table.push_back(header);
+	}
+	return true;
+}
+
+void PairWriter::convert(std::string binFile, std::string textFile,
+		std::string dlm) {
+	gzFile in = gzopen(binFile.c_str(), "rb");
+	if (in == nullptr) {
+		std::cerr << "PairWriter error: Cannot open " << binFile << std::endl;
+		throw std::exception();
+	}
+
+	char magic[8];
+	uint64_t scale = 0;
+	uint64_t tableNum = 0;
+	bool isValid = readBytes(in, magic, 8) == 8 && readLittle(in, 4, scale)
+			&& readLittle(in, 4, tableNum);
+	if (!isValid || memcmp(magic, MAGIC, 8) != 0 || scale == 0
+			|| (tableNum != 1 && tableNum != 2)) {
+		gzclose(in);
+		std::cerr << "PairWriter error: " << binFile;
+		std::cerr << " is not a binary output file of Identity." << std::endl;
+		throw std::exception();
+	}
+
+	std::vector<std::string> firstTable;
+	std::vector<std::string> secondTable;
+	isValid = readTable(in, firstTable)
+			&& (tableNum == 1 || readTable(in, secondTable));
+	const std::vector<std::string> &table2 =
+			tableNum == 2 ? secondTable : firstTable;
+
+	if (!isValid) {
+		gzclose(in);
+		std::cerr << "PairWriter error: The header tables of " << binFile;
+		std::cerr << " are incomplete." << std::endl;
+		throw std::exception();
+	}
+
+	std::ofstream out(textFile);
+	const int chunk = 1 << 16;
+	std::vector<char> buffer(chunk * RECORD_SIZE);
+	size_t size;
+	do {
+		size = readBytes(in, buffer.data(), buffer.size());
+		int64_t n = size / RECORD_SIZE;
+		for (int64_t r = 0; r < n; r++) {
+			const char *record = buffer.data() + r * RECORD_SIZE;
+			uint64_t id1 = getLittle(record, 4);
+			uint64_t id2 = getLittle(record + 4, 4);
+			uint64_t s = getLittle(record + 8, 2);
+			if (id1 >= firstTable.size() || id2 >= table2.size()) {
+				gzclose(in);
+				std::cerr << "PairWriter error: Invalid sequence id in ";
+				std::cerr << binFile << std::endl;
+				throw std::exception();
+			}
+			out << firstTable[id1] << dlm << table2[id2] << dlm
+					<< (double) s / scale << "\n";
+		}
+	} while (size == buffer.size());
+	gzclose(in);
+	out.close();
+}
@@ -0,0 +1,104 @@
+/*
+ Identity 2.0 calculates DNA sequence identity scores rapidly without alignment.
+
+ Copyright (C) 2020-2022 Hani Z. Girgis, PhD
+
+ Academic use: Affero General Public License version 1.
+
+ Any restrictions to use for-profit or non-academics: Alternative commercial license is needed.
+
+ This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+ Please contact Dr. Hani Z. Girgis (hzgirgis@buffalo.edu) if you need more information.
+ */
+
+/*
+ * PairWriter.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Hani Z. Girgis, PhD
+ *     Purpose: Writes a scored pair of sequences as a text line
+ *     (header1 dlm header2 dlm score) or as a fixed-width binary record.
+ *     A writer formats into its own buffer, which is handed to an
+ *     OutputWriter when full; so one writer per thread needs no locking.
+ *
+ *     The binary file (little-endian) consists of:
+ *     + "IDPAIRS" followed by the format version (1 byte)
+ *     + The score scale (uint32) and the number of header tables (uint32):
+ *       1 if both columns refer to the same file, otherwise 2.
+ *     + Each table: the number of headers (uint64), then the length (uint32)
+ *       and the characters of each header. The id of a sequence is its
+ *       number in the table (see FastaIndex).
+ *     + Records to the end of the file: id1 (uint32), id2 (uint32), and
+ *       round(score * scale) (uint16).
+ *
+ *     A shard (see OutputShards) holds records only: id1 (uint32), id2
+ *     (uint32), and the score (double). A shard is read back by the run
+ *     that wrote it, so it is in the byte order of the host.
+ */
+
+#ifndef SRC_PAIRWRITER_H_
+#define SRC_PAIRWRITER_H_
+
+#include <string>
+#include <string_view>
+#include <iostream>
+#include <cstdint>
+
+#include "OutputWriter.h"
+
+class PairWriter {
+public:
+	enum Format {
+		TEXT, BINARY, SHARD
+	};
+
+private:
+	OutputWriter *out;
+	std::string *buffer;
+	Format format;
+	std::string dlm;
+	int precision;
+
+	void appendScore(double);
+
+public:
+	// A score is stored as round(score * SCALE)
+	static const uint32_t SCALE = 10000;
+	// Bytes per binary record
+	static const int RECORD_SIZE = 10;
+	// Bytes per shard record
+	static const int SHARD_RECORD_SIZE = 16;
+
+	PairWriter(OutputWriter*, Format, std::string, int);
+	PairWriter(const PairWriter&) = delete;
+	PairWriter& operator=(const PairWriter&) = delete;
+	/**
+	 * Flushes the buffer
+	 */
+	virtual ~PairWriter();
+
+	void write(std::string_view, uint32_t, std::string_view, uint32_t,
+			double);
+
+	/**
+	 * Hand the buffer over to the output writer
+	 */
+	void flush();
+
+	/**
+	 * Write the header tables of a binary file. The first file provides
+	 * the first column. The second file may be the first one.
+	 */
+	static void writeTables(OutputWriter*, std::string, std::string,
+			int threadNum = 1);
+
+	/**
+	 * Convert a binary file, which may be compressed by gzip, to the
+	 * tab-separated text format
+	 */
+	static void convert(std::string, std::string, std::string dlm = "\t");
+};
+
+#endif /* SRC_PAIRWRITER_H_ */
@@ -37,6 +37,7 @@ int Parameters::MIN_BLOCK_SIZE = 2;
 int Parameters::MAX_BLOCK_SIZE = 5;
 int Parameters::BLOCK_SIZE = 1000;
 int Parameters::K_RELAX = 1; //2;
+int Parameters::HIST_WIDTH = 0;
 
 // These are not used
 int Parameters::MIN_FEAT_NUM = 3;
@@ -282,6 +283,23 @@ void Parameters::setKRelax(int kRelax) {
 	K_RELAX = kRelax;
 }
 
+int Parameters::getHistWidth() {
+	return HIST_WIDTH;
+}
+
+void Parameters::setHistWidth(int64_t width) {
+	int64_t w = 1;
+	while (w < width) {
+		w *= getAlphabetSize();
+	}
+	if (w > std::numeric_limits<int>::max()) {
+		std::cerr << "The histogram width is too large: " << width;
+		std::cerr << std::endl;
+		throw std::exception();
+	}
+	HIST_WIDTH = w;
+}
+
 int Parameters::getMsItr() {
 	return MS_ITR;
 }
@@ -26,6 +26,7 @@
 
 #include <iostream>
 #include <limits>
+#include <cstdint>
 
 class Parameters {
 private:
@@ -53,6 +54,8 @@ private:
 	static double DELTA_C;
 
 	static int K_RELAX;
+	// The number of bins of a hashed k-mer histogram; 0 means dense
+	static int HIST_WIDTH;
 	static void checkMutPerTemp();
 
 	static double TRANSLOCATION_FACTOR;
@@ -118,6 +121,12 @@ public:
 	static int getKRelax();
 	static void setKRelax(int);
 
+	static int getHistWidth();
+	/**
+	 * The width is rounded up to a power of the alphabet size
+	 */
+	static void setHistWidth(int64_t);
+
 	// Parameters controlling training
 	static int getMinFeatNum();
 	static void setMinFeatNum(int);
@@ -0,0 +1,116 @@
+/*
+ Identity 2.0 calculates DNA sequence identity scores rapidly without alignment.
+
+ Copyright (C) 2020-2022 Hani Z. Girgis, PhD
+
+ Academic use: Affero General Public License version 1.
+
+ Any restrictions to use for-profit or non-academics: Alternative commercial license is needed.
+
+ This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+ Please contact Dr. Hani Z. Girgis (hzgirgis@buffalo.edu) if you need more information.
+ */
+
+
+/*
+ * Prefilter.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Hani Z. Girgis, PhD
+ */
+
+#include "Prefilter.h"
+
+#include <iostream>
+
+#include "GLMClassifier.h"
+#include "StatisticInfo.h"
+#include "CutoffTuner.h"
+
+Prefilter::Prefilter(std::vector<Feature*> &list, double t, double c) {
+	threshold = t;
+	cutoff = c;
+	makePredictor(list);
+}
+
+Prefilter::~Prefilter() {
+	for (auto f : featList) {
+		delete f;
+	}
+	featList.clear();
+}
+
+void Prefilter::makePredictor(std::vector<Feature*> &list) {
+	featNum = list.size() - 1; // The bias has not been removed yet.
+	for (auto f : list) {
+		if (f->getNumOfComp() == 0 && f->getName().compare("constant") != 0) {
+			funIndexList.push_back(f->getFunIndex());
+		}
+	}
+	// This predictor removes the bias from the feature list; its output is
+	// not rounded to a class, so the cutoff can be tuned
+	predictor = GLMPredictor(list, false);
+}
+
+Prefilter* Prefilter::train(const Matrix *f, const Matrix *l, double t,
+		int threadNum) {
+	std::cout << "Training the prefilter ..." << std::endl;
+
+	if (!CutoffTuner::hasBothClasses(l, t)) {
+		std::cout << "\tNot enough similar and dissimilar pairs. ";
+		std::cout << "The prefilter is not used." << std::endl;
+		return nullptr;
+	}
+
+	auto info = StatisticInfo::getInstance();
+	std::vector<int> statList = info->getCheapIndexList();
+	Matrix cheapTable = f->subMatrixByCol(statList.data(), statList.size());
+	GLMClassifier classifier(&cheapTable, l, t, threadNum,
+			CutoffTuner::MIN_FEAT, 1.0, statList);
+	classifier.start();
+
+	std::vector<Feature*> list = classifier.getFeatureList();
+	Prefilter *p = new Prefilter(list, t, 0.0);
+	for (auto feat : list) {
+		delete feat;
+	}
+	p->featList = classifier.getFeatureList();
+
+	// Lower the cutoff until almost all similar pairs pass
+	std::cout << "\tStatistics: " << p->funIndexList.size() << std::endl;
+	p->cutoff = CutoffTuner::tune(f, l, t, p->predictor, p->funIndexList,
+			p->featNum);
+	std::cout << "\tCutoff: " << p->cutoff << std::endl;
+
+	return p;
+}
+
+bool Prefilter::canApply(double t) const {
+	return t >= threshold;
+}
+
+const int* Prefilter::getFunIndexArray() const {
+	return funIndexList.data();
+}
+
+int Prefilter::getSingleFeatNum() const {
+	return funIndexList.size();
+}
+
+int Prefilter::getFeatNum() const {
+	return featNum;
+}
+
+double Prefilter::getThreshold() const {
+	return threshold;
+}
+
+double Prefilter::getCutoff() const {
+	return cutoff;
+}
+
+std::vector<Feature*>* Prefilter::getFeatureList() {
+	return &featList;
+}
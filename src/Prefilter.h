@@ -0,0 +1,97 @@
+/*
+ Identity 2.0 calculates DNA sequence identity scores rapidly without alignment.
+
+ Copyright (C) 2020-2022 Hani Z. Girgis, PhD
+
+ Academic use: Affero General Public License version 1.
+
+ Any restrictions to use for-profit or non-academics: Alternative commercial license is needed.
+
+ This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+ Please contact Dr. Hani Z. Girgis (hzgirgis@buffalo.edu) if you need more information.
+ */
+
+
+/*
+ * Prefilter.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Hani Z. Girgis, PhD
+ *     Purpose: The first stage of a two-stage model. A GLM classifier is
+ *     trained at the threshold on the cheap statistics only (see
+ *     StatisticInfo::getCheapIndexList). Its cutoff is lowered until almost
+ *     all similar pairs of the training data pass. A pair it rejects is not
+ *     scored by the regressor; so most dissimilar pairs never pay for the
+ *     expensive statistics.
+ */
+
+#ifndef SRC_PREFILTER_H_
+#define SRC_PREFILTER_H_
+
+#include <vector>
+
+#include "Matrix.h"
+#include "Feature.h"
+#include "GLMPredictor.h"
+
+class Prefilter {
+private:
+	// The identity score the classifier is trained at
+	double threshold;
+	// A pair is rejected if the output of the classifier is below it
+	double cutoff;
+
+	int featNum;
+	std::vector<int> funIndexList;
+	GLMPredictor predictor;
+	// The features and the weights; kept for saving the model
+	std::vector<Feature*> featList;
+
+	void makePredictor(std::vector<Feature*>&);
+
+public:
+	/**
+	 * The features of the classifier (the bias first) are taken over by the
+	 * predictor. A pair is rejected if the classifier output is below the
+	 * cutoff.
+	 */
+	Prefilter(std::vector<Feature*>&, double, double);
+	Prefilter(const Prefilter&) = delete;
+	Prefilter& operator=(const Prefilter&) = delete;
+	virtual ~Prefilter();
+
+	/**
+	 * Select the cheap statistics of a classifier separating the synthetic
+	 * pairs at the threshold. Returns nullptr if there are too few similar
+	 * or dissimilar pairs to train on.
+	 */
+	static Prefilter* train(const Matrix*, const Matrix*, double, int);
+
+	/**
+	 * A pair rejected at the training threshold is also dissimilar at a
+	 * higher one
+	 */
+	bool canApply(double) const;
+
+	/**
+	 * data: the statistics listed by getFunIndexArray and room for the
+	 * expanded features (getFeatNum). They are changed.
+	 */
+	inline bool isRejected(double *data) {
+		return predictor.calculateIdentity(data) < cutoff;
+	}
+
+	const int* getFunIndexArray() const;
+	int getSingleFeatNum() const;
+	int getFeatNum() const;
+	double getThreshold() const;
+	double getCutoff() const;
+	/**
+	 * Empty if the prefilter is loaded from a model
+	 */
+	std::vector<Feature*>* getFeatureList();
+};
+
+#endif /* SRC_PREFILTER_H_ */
@@ -22,10 +22,24 @@
 
 #include "ReaderAlignerCoordinator.h"
 
+/**
+ * A loaded model keeps the histograms it was trained on
+ */
+static void checkHistWidth(const Serializer &serializer) {
+	int width = Parameters::getHistWidth();
+	int fullSize = pow(Parameters::getAlphabetSize(), serializer.getK());
+	if (width > 0 && std::min(width, fullSize) != serializer.getHistSize()) {
+		std::cout << "ReaderAlignerCoordinator warning: ";
+		std::cout << "The histogram width (-w) is ignored. The model uses ";
+		std::cout << serializer.getHistSize() << " bins." << std::endl;
+	}
+}
+
 ReaderAlignerCoordinator::ReaderAlignerCoordinator(
 		int workerNumIn, // @suppress("Class members should be properly initialized")
 		int blockSizeIn, double t, bool r, bool a, bool s, bool f,
-		std::string file) {
+		std::string file, bool tune, bool binary, std::string matrix,
+		int k, bool sharded, bool prefilter, bool cascade) {
 	workerNum = workerNumIn;
 	blockSize = blockSizeIn;
 	threshold = t;
@@ -34,6 +48,13 @@ ReaderAlignerCoordinator::ReaderAlignerCoordinator(
 	canSaveModel = s;
 	canFillModel = f;
 	modelFile = file;
+	canTune = tune;
+	isBinary = binary;
+	matrixFormat = matrix;
+	topK = k;
+	isSharded = sharded;
+	canPrefilter = prefilter;
+	canCascade = cascade;
 }
 
 ReaderAlignerCoordinator::~ReaderAlignerCoordinator() {
@@ -55,28 +76,33 @@ void ReaderAlignerCoordinator::alignFileVsFile1(string fileDb, string fileQry,
 
 	if (canFillModel) {
 		Serializer serializer(modelFile);
-		int64_t maxLength = serializer.getMaxLength();
+		checkHistWidth(serializer);
+		int64_t maxLength = findMaxLength(fileDb, fileQry,
+				serializer.getMaxLength());
 		int hSize = serializer.getHistSize();
 		int k = serializer.getK();
 		double error = serializer.getAbsError();
 		// Determine histogram data type
 		if (maxLength <= std::numeric_limits<int8_t>::max()) {
 			AlignerParallel<int8_t> aligner(serializer, threshold, canReportAll,
-					dlm, workerNum, fileOut);
+					dlm, workerNum, fileOut, canPrefilter, canCascade);
 			helper1<int8_t>(fileDb, fileQry, fileOut, dlm, isAllVsAll, aligner);
 		} else if (maxLength <= std::numeric_limits<int16_t>::max()) {
 			AlignerParallel<int16_t> aligner(serializer, threshold,
-					canReportAll, dlm, workerNum, fileOut);
+					canReportAll, dlm, workerNum, fileOut, canPrefilter,
+					canCascade);
 			helper1<int16_t>(fileDb, fileQry, fileOut, dlm, isAllVsAll,
 					aligner);
 		} else if (maxLength <= std::numeric_limits<int32_t>::max()) {
 			AlignerParallel<int32_t> aligner(serializer, threshold,
-					canReportAll, dlm, workerNum, fileOut);
+					canReportAll, dlm, workerNum, fileOut, canPrefilter,
+					canCascade);
 			helper1<int32_t>(fileDb, fileQry, fileOut, dlm, isAllVsAll,
 					aligner);
 		} else if (maxLength <= std::numeric_limits<int64_t>::max()) {
 			AlignerParallel<int64_t> aligner(serializer, threshold,
-					canReportAll, dlm, workerNum, fileOut);
+					canReportAll, dlm, workerNum, fileOut, canPrefilter,
+					canCascade);
 			helper1<int64_t>(fileDb, fileQry, fileOut, dlm, isAllVsAll,
 					aligner);
 		} else {
@@ -86,56 +112,73 @@ void ReaderAlignerCoordinator::alignFileVsFile1(string fileDb, string fileQry,
 			std::cout << "A histogram entry is 64 bits." << std::endl;
 
 			AlignerParallel<int64_t> aligner(serializer, threshold,
-					canReportAll, dlm, workerNum, fileOut);
+					canReportAll, dlm, workerNum, fileOut, canPrefilter,
+					canCascade);
 			helper1<int64_t>(fileDb, fileQry, fileOut, dlm, isAllVsAll,
 					aligner);
 		}
 	} else {
 		DataGenerator *g = nullptr;
 		if (isAllVsAll) {
-			g = new SynDataGenerator(fileDb, threshold, workerNum);
+			g = new SynDataGenerator(fileDb, threshold, workerNum,
+					std::vector<int>(), canCascade);
 		} else {
-			g = new SynDataGenerator(fileDb, fileQry, threshold, workerNum);
+			g = new SynDataGenerator(fileDb, fileQry, threshold, workerNum,
+					std::vector<int>(), canCascade);
 		}
 		int64_t maxLength = g->getMaxLength();
 		int hSize = g->getHistogramSize();
 		int k = g->getK();
 		// If regression alone, it must learn the entire function not part of it.
 		// That is why no threshold, i.e. threshold = 0.
-		GLMRegressor r(g->getFeatures(), g->getLabels(), 0.0, workerNum, k);
+		std::vector<int> statList = g->getCandidateList();
+		GLMRegressor r(g->getFeatures(), g->getLabels(), 0.0, workerNum, k,
+				statList);
 		r.start();
 		double error = r.getAbsError();
-		// Free memory used by the training and the validation data
-		g->clearData();
 		if (canRelax) {
 			std::cout << "Relaxing the threshold by " << error << std::endl;
 		} else {
 			error = 0.0;
 		}
+		// The prefilter is trained at the threshold pairs are filtered at
+		Prefilter *prefilter = nullptr;
+		if (canPrefilter && !canReportAll) {
+			prefilter = Prefilter::train(g->getFeatures(), g->getLabels(),
+					threshold - error, workerNum);
+		}
+		CoarseScorer *coarse = nullptr;
+		if (g->getCoarseFeatures() != nullptr && !canReportAll) {
+			coarse = CoarseScorer::train(g->getCoarseFeatures(), g->getLabels(),
+					k - g->getFoldNum(), hSize, g->getFoldNum(),
+					threshold - error, workerNum, statList);
+		}
+		// Free memory used by the training and the validation data
+		g->clearData();
 
 		ITransformer *t = &r;
 		// Determine histogram data type
 		if (maxLength <= std::numeric_limits<int8_t>::max()) {
 			AlignerParallel<int8_t> aligner(k, hSize, threshold, error,
 					canReportAll, g->getCompositionList(), t, dlm, workerNum,
-					maxLength, fileOut, modelFile);
+					maxLength, fileOut, modelFile, prefilter, coarse);
 			helper1<int8_t>(fileDb, fileQry, fileOut, dlm, isAllVsAll, aligner);
 		} else if (maxLength <= std::numeric_limits<int16_t>::max()) {
 			AlignerParallel<int16_t> aligner(k, hSize, threshold, error,
 					canReportAll, g->getCompositionList(), t, dlm, workerNum,
-					maxLength, fileOut, modelFile);
+					maxLength, fileOut, modelFile, prefilter, coarse);
 			helper1<int16_t>(fileDb, fileQry, fileOut, dlm, isAllVsAll,
 					aligner);
 		} else if (maxLength <= std::numeric_limits<int32_t>::max()) {
 			AlignerParallel<int32_t> aligner(k, hSize, threshold, error,
 					canReportAll, g->getCompositionList(), t, dlm, workerNum,
-					maxLength, fileOut, modelFile);
+					maxLength, fileOut, modelFile, prefilter, coarse);
 			helper1<int32_t>(fileDb, fileQry, fileOut, dlm, isAllVsAll,
 					aligner);
 		} else if (maxLength <= std::numeric_limits<int64_t>::max()) {
 			AlignerParallel<int64_t> aligner(k, hSize, threshold, error,
 					canReportAll, g->getCompositionList(), t, dlm, workerNum,
-					maxLength, fileOut, modelFile);
+					maxLength, fileOut, modelFile, prefilter, coarse);
 			helper1<int64_t>(fileDb, fileQry, fileOut, dlm, isAllVsAll,
 					aligner);
 		} else {
@@ -146,7 +189,7 @@ void ReaderAlignerCoordinator::alignFileVsFile1(string fileDb, string fileQry,
 
 			AlignerParallel<int64_t> aligner(k, hSize, threshold, error,
 					canReportAll, g->getCompositionList(), t, dlm, workerNum,
-					maxLength, fileOut, modelFile);
+					maxLength, fileOut, modelFile, prefilter, coarse);
 			helper1<int64_t>(fileDb, fileQry, fileOut, dlm, isAllVsAll,
 					aligner);
 		}
@@ -155,6 +198,81 @@ void ReaderAlignerCoordinator::alignFileVsFile1(string fileDb, string fileQry,
 	}
 }
 
+/**
+ * A model may have been trained on shorter sequences than the ones to be
+ * aligned. The histogram type must hold the longest sequence of both.
+ */
+int64_t ReaderAlignerCoordinator::findMaxLength(string fileDb, string fileQry,
+		int64_t modelMaxLength) {
+	FastaIndex dbIndex(fileDb, workerNum);
+	int64_t r = std::max(modelMaxLength, dbIndex.getMaxLength());
+	if (fileQry != fileDb) {
+		FastaIndex qryIndex(fileQry, workerNum);
+		r = std::max(r, qryIndex.getMaxLength());
+	}
+	return r;
+}
+
+/**
+ * Align block A versus each block of a database reader, which reads on a
+ * separate thread
+ */
+template<class V, class R>
+void ReaderAlignerCoordinator::alignBlockA(AlignerParallel<V> &aligner,
+		R &dbReader, ThreadTuner &tuner) {
+	// Share the threads with the reader
+	aligner.setThreadNum(tuner.next());
+	dbReader.setThreadNum(workerNum - tuner.next());
+	// Start a reading task
+	LockFreeQueue<Block*, 1000> buffer;
+	auto readFuture = std::async([&dbReader, &buffer]() -> int {
+		int blockRead = 0;
+		while (dbReader.isStillReading()) {
+			buffer.push(dbReader.read());
+			blockRead++;
+		}
+		return blockRead;
+	});
+
+	// Align each query block versus this database block
+	int blockProcessed = 0;
+	int blockRead = -1;
+	while (true) {
+		if (buffer.size() > 0) {
+			bool isReading = dbReader.isStillReading();
+			if (isReading) {
+				aligner.setThreadNum(tuner.next());
+			} else {
+				// The reading thread is done. Use it in the aligner.
+				aligner.setThreadNum(workerNum);
+			}
+
+			uint64_t pairNum = (uint64_t) aligner.getSizeA()
+					* buffer.front()->size();
+			tuner.start();
+			aligner.processBlockB(buffer.front());
+			if (isReading) {
+				tuner.stop(pairNum);
+				// The tuner may have moved to another candidate
+				dbReader.setThreadNum(workerNum - tuner.next());
+			}
+			buffer.pop();
+			blockProcessed++;
+
+		} else if (!dbReader.isStillReading()) {
+			// The reading thread is done. Use it in the aligner.
+			aligner.setThreadNum(workerNum);
+
+			if (readFuture.valid()) {
+				blockRead = readFuture.get();
+			}
+			if (blockProcessed == blockRead) {
+				break;
+			}
+		}
+	}
+}
+
 template<class V>
 void ReaderAlignerCoordinator::helper1(string fileDb, string fileQry,
 		string fileOut, string dlm, bool isAllVsAll,
@@ -172,55 +290,69 @@ void ReaderAlignerCoordinator::helper1(string fileDb, string fileQry,
 			<< "Calculating the identity scores. This step may take long time ..."
 			<< std::endl;
 
+	// The pair output is closed, so it does not write to the manifest
+	OutputShards *shards = nullptr;
+	if (isSharded) {
+		aligner.closeOutput();
+		shards = new OutputShards(fileOut, fileQry, fileDb, isBinary, 8);
+		aligner.setShardedOutput(shards);
+	} else if (isBinary) {
+		aligner.setBinaryOutput(fileQry, fileDb);
+	}
+
+	// The matrix is the output file itself (tri) or a temporary file next to
+	// it, which is converted at the end. The pair output is closed first, so
+	// it does not write to the same file.
+	ScoreMatrix *matrix = nullptr;
+	std::string matrixFile;
+	if (isAllVsAll && !matrixFormat.empty()) {
+		aligner.closeOutput();
+		matrixFile = matrixFormat == "tri" ? fileOut : fileOut + ".tri";
+		matrix = new ScoreMatrix(matrixFile, FastaIndex(fileDb, workerNum));
+		aligner.setMatrixOutput(matrix);
+	}
+
 	FastaReader qryReader(fileQry, blockSize);
+	qryReader.setThreadNum(workerNum);
+
+	// While the reader is working, try leaving it a free thread or sharing
+	// all threads with it. Without tuning, one thread is left free.
+	std::vector<int> candidateList { workerNum - 1 };
+	if (canTune) {
+		candidateList.push_back(workerNum);
+	}
+	ThreadTuner tuner(candidateList);
+
+	if (isAllVsAll && !canReportAll && qryReader.canFetch()) {
+		// Blocks are read from the longest sequences to the shortest ones. A
+		// block is aligned versus the next ones up to the first sequence
+		// that is too short for all of its sequences.
+		FastaIndex index(fileDb, workerNum);
+		std::vector<uint32_t> orderList = index.getLengthOrder();
+		SortedReader sortedReader(fileDb, index, orderList, blockSize);
+		sortedReader.setThreadNum(workerNum);
 
-	if (isAllVsAll) {
+		// Process the first block versus itself.
+		aligner.setBlockA(sortedReader.read(), isAllVsAll);
+		while (sortedReader.isStillReading()) {
+			// Construct a database reader
+			SortedReader dbReader(fileDb, index, orderList, blockSize,
+					sortedReader.getNext());
+			dbReader.stopBelow(threshold, sortedReader.getLastLength());
+
+			alignBlockA(aligner, dbReader, tuner);
+
+			aligner.setBlockA(sortedReader.read(), isAllVsAll);
+		}
+	} else if (isAllVsAll) {
 		// Process the first block versus itself.
 		aligner.setBlockA(qryReader.read(), isAllVsAll);
 		while (qryReader.isStillReading()) {
 			// Construct a database reader
 			FastaReader dbReader(fileDb, blockSize, qryReader.getCurrentPos(),
-					qryReader.getMaxLen());
-
-			// Make sure there is one free thread for reading
-			aligner.setThreadNum(workerNum - 1);
-			// Start a reading task
-			LockFreeQueue<Block*, 1000> buffer;
-			auto readFuture = std::async([&dbReader, &buffer]() -> int {
-				int blockRead = 0;
-				while (dbReader.isStillReading()) {
-					buffer.push(dbReader.read());
-					blockRead++;
-				}
-				return blockRead;
-			});
-
-			// Align each query block versus this database block
-			int blockProcessed = 0;
-			int blockRead = -1;
-			while (true) {
-				if (buffer.size() > 0) {
-					if (!dbReader.isStillReading()) {
-						// The reading thread is done. Use it in the aligner.
-						aligner.setThreadNum(workerNum);
-					}
-
-					aligner.processBlockB(buffer.front());
-					buffer.pop();
-					blockProcessed++;
-
-				} else if (!dbReader.isStillReading()) {
-					// The reading thread is done. Use it in the aligner.
-					aligner.setThreadNum(workerNum);
+					qryReader.getMaxLen(), qryReader.getRecordNum());
 
-					if (readFuture.valid()) {
-						blockRead = readFuture.get();
-					}
-					if (blockProcessed == blockRead) {
-						break;
-					}
-				}
-			}
+			alignBlockA(aligner, dbReader, tuner);
 
 			aligner.setBlockA(qryReader.read(), isAllVsAll);
 		}
@@ -231,47 +363,26 @@ void ReaderAlignerCoordinator::helper1(string fileDb, string fileQry,
 			// Construct a database reader
 			FastaReader dbReader(fileDb, blockSize);
 
-			// Make sure there is one free thread for reading
-			aligner.setThreadNum(workerNum - 1);
-
-			// Start a reading task
-			LockFreeQueue<Block*, 1000> buffer;
-			auto readFuture = std::async([&dbReader, &buffer]() -> int {
-				int blockRead = 0;
-				while (dbReader.isStillReading()) {
-					buffer.push(dbReader.read());
-					blockRead++;
-				}
-				return blockRead;
-			});
-
-			// Align each query block versus this database block
-			int blockProcessed = 0;
-			int blockRead = -1;
-			while (true) {
-				if (buffer.size() > 0) {
-					if (!dbReader.isStillReading()) {
-						// The reading thread is done. Use it in the aligner.
-						aligner.setThreadNum(workerNum);
-					}
-
-					aligner.processBlockB(buffer.front());
-					buffer.pop();
-
-					blockProcessed++;
-				} else if (!dbReader.isStillReading()) {
-					// The reading thread is done. Use it in the aligner.
-					aligner.setThreadNum(workerNum);
+			alignBlockA(aligner, dbReader, tuner);
+		}
+	}
 
-					if (readFuture.valid()) {
-						blockRead = readFuture.get();
-					}
+	if (shards != nullptr) {
+		aligner.setShardedOutput(nullptr);
+		shards->close();
+		delete shards;
+	}
 
-					if (blockProcessed == blockRead) {
-						break;
-					}
-				}
-			}
+	if (matrix != nullptr) {
+		aligner.setMatrixOutput(nullptr);
+		if (matrixFormat == "phylip") {
+			matrix->writePhylip(fileOut, workerNum);
+		} else if (matrixFormat == "npy") {
+			matrix->writeNpy(fileOut);
+		}
+		delete matrix;
+		if (matrixFile != fileOut) {
+			remove(matrixFile.c_str());
 		}
 	}
 }
@@ -283,12 +394,15 @@ void ReaderAlignerCoordinator::alignFileVsFile2(string fileDb, string fileQry,
 	int64_t maxLength;
 	if (canFillModel) {
 		serializer = new Serializer(modelFile);
-		maxLength = serializer->getMaxLength();
+		checkHistWidth(*serializer);
+		maxLength = findMaxLength(fileDb, fileQry, serializer->getMaxLength());
 	} else {
 		if (isAllVsAll) {
-			g = new SynDataGenerator(fileDb, threshold, workerNum);
+			g = new SynDataGenerator(fileDb, threshold, workerNum,
+					std::vector<int>(), canCascade);
 		} else {
-			g = new SynDataGenerator(fileDb, fileQry, threshold, workerNum);
+			g = new SynDataGenerator(fileDb, fileQry, threshold, workerNum,
+					std::vector<int>(), canCascade);
 		}
 		maxLength = g->getMaxLength();
 	}
@@ -337,13 +451,13 @@ void ReaderAlignerCoordinator::helper2_simple(string fileDb, string fileQry,
 	IdentityCalculator<V> *id;
 	if (canFillModel) {
 		id = new IdentityCalculator<V>(*serializer, threshold, canSkip,
-				canRelax);
+				canRelax, canPrefilter, canCascade);
 	} else if (canSaveModel) {
 		id = new IdentityCalculator<V>(g, workerNum, threshold, canSkip,
-				canRelax, modelFile);
+				canRelax, modelFile, canPrefilter);
 	} else {
 		id = new IdentityCalculator<V>(g, workerNum, threshold, canSkip,
-				canRelax);
+				canRelax, "", canPrefilter);
 	}
 
 	/**
@@ -367,6 +481,10 @@ void ReaderAlignerCoordinator::helper2_simple(string fileDb, string fileQry,
 		fileQry = temp;
 	}
 
+	// Headers are resolved by sequence id when scores are written
+	FastaIndex dbIndex(fileDb, workerNum);
+	FastaIndex qryIndex(fileQry, workerNum);
+
 	// Construct a database reader.
 	FastaReader dbReader(fileDb, blockSize);
 
@@ -380,7 +498,7 @@ void ReaderAlignerCoordinator::helper2_simple(string fileDb, string fileQry,
 		auto dbTuble = id->unpackBlock(dbBlock, workerNum);
 		V **dbKHistList = get<0>(dbTuble);
 		uint64_t **dbMonoHistList = get<1>(dbTuble);
-		std::string **dbInfoList = get<2>(dbTuble);
+		uint32_t *dbIdList = get<2>(dbTuble);
 		int *dbLenList = get<3>(dbTuble);
 
 		// Construct a query reader
@@ -392,19 +510,19 @@ void ReaderAlignerCoordinator::helper2_simple(string fileDb, string fileQry,
 			auto qryTuble = id->unpackBlock(qryBlock, workerNum);
 			V **qryKHistList = get<0>(qryTuble);
 			uint64_t **qryMonoHistList = get<1>(qryTuble);
-			std::string **qryInfoList = get<2>(qryTuble);
+			uint32_t *qryIdList = get<2>(qryTuble);
 			int *qryLenList = get<3>(qryTuble);
 
 			for (int i = 0; i < dbSize; i++) {
-				std::string dbSeq = *dbInfoList[i];
+				std::string_view dbSeq = dbIndex.getHeader(dbIdList[i]);
 				double *v = id->score(dbKHistList[i], qryKHistList,
 						dbMonoHistList[i], qryMonoHistList, qrySize, workerNum,
 						dbLenList[i], qryLenList);
 
 				for (int j = 0; j < qrySize; j++) {
 					if (v[j] > 0.0) {
-						out << dbSeq << "\t" << *qryInfoList[j] << "\t" << v[j]
-								<< std::endl;
+						out << dbSeq << "\t" << qryIndex.getHeader(qryIdList[j])
+								<< "\t" << v[j] << std::endl;
 					}
 				}
 				delete[] v;
@@ -433,13 +551,13 @@ void ReaderAlignerCoordinator::helper2(string fileDb, string fileQry,
 	IdentityCalculator<V> *id;
 	if (canFillModel) {
 		id = new IdentityCalculator<V>(*serializer, threshold, canSkip,
-				canRelax);
+				canRelax, canPrefilter, canCascade);
 	} else if (canSaveModel) {
 		id = new IdentityCalculator<V>(g, workerNum, threshold, canSkip,
-				canRelax, modelFile);
+				canRelax, modelFile, canPrefilter);
 	} else {
 		id = new IdentityCalculator<V>(g, workerNum, threshold, canSkip,
-				canRelax);
+				canRelax, "", canPrefilter);
 	}
 
 	/**
@@ -454,8 +572,21 @@ void ReaderAlignerCoordinator::helper2(string fileDb, string fileQry,
 		std::cout << "Relaxing the threshold" << std::endl;
 	}
 
-// Make sure you have one thread for reading
-	workerNum--;
+// Leave one thread for reading unless the tuner finds it better to share.
+// In the search mode, hyperthreads sharing a core usually compete; so the
+// physical cores are tried first.
+	std::vector<int> candidateList;
+	if (canTune) {
+		int physicalNum = ThreadTuner::countPhysicalCores();
+		if (physicalNum < workerNum) {
+			candidateList.push_back(physicalNum - 1);
+		}
+		candidateList.push_back(workerNum - 1);
+		candidateList.push_back(workerNum);
+	} else {
+		candidateList.push_back(workerNum - 1);
+	}
+	ThreadTuner tuner(candidateList);
 
 	std::cout
 			<< "Calculating the identity scores. This step may take long time ..."
@@ -469,16 +600,38 @@ void ReaderAlignerCoordinator::helper2(string fileDb, string fileQry,
 
 // Construct a database reader.
 	FastaReader dbReader(fileDb, blockSize);
-
-// Open output file
-	std::ofstream out(fileOut.c_str(), std::ios::out);
+	dbReader.setThreadNum(workerNum);
+
+// Query blocks are handed to the aligners in turn. If they are fewer than
+// the aligners, the idle threads help the busy aligners with large
+// sequences.
+	int64_t qryBlockNum = (FastaIndex(fileQry, workerNum).getCount()
+			+ blockSize - 1) / blockSize;
+	qryBlockNum = std::max<int64_t>(qryBlockNum, 1);
+
+// Open output file, or a manifest of a shard per aligner
+	OutputWriter *out = nullptr;
+	OutputShards *shards = nullptr;
+	PairWriter::Format format = PairWriter::TEXT;
+	if (isSharded) {
+		shards = new OutputShards(fileOut, fileDb, fileQry, isBinary, 4,
+				topK > 0);
+		format = PairWriter::SHARD;
+	} else {
+		out = new OutputWriter(fileOut, std::max(1, workerNum / 4));
+		if (isBinary) {
+			PairWriter::writeTables(out, fileDb, fileQry, workerNum);
+			format = PairWriter::BINARY;
+		}
+	}
 
 	while (dbReader.isStillReading()) {
 		// Construct a query reader
 		FastaReader *qryReader;
 		if (isAllVsAll) {
 			qryReader = new FastaReader(fileQry, blockSize,
-					dbReader.getCurrentPos(), dbReader.getMaxLen());
+					dbReader.getCurrentPos(), dbReader.getMaxLen(),
+					dbReader.getRecordNum());
 		} else {
 			qryReader = new FastaReader(fileQry, blockSize);
 		}
@@ -505,27 +658,34 @@ void ReaderAlignerCoordinator::helper2(string fileDb, string fileQry,
 		Block *dbBlock = dbReader.read();
 
 		// Start concurrent aligner tasks
+		int alignerNum = tuner.next();
+		int alignerThreadNum =
+				qryBlockNum < alignerNum ? alignerNum / qryBlockNum : 1;
+		tuner.start();
+		uint64_t qrySeqNum = 0;
 		vector<Aligner<V>*> alignerList;
-		alignerList.reserve(workerNum);
-		vector<future<std::pair<bool, stringstream*> > > futureList;
-		futureList.reserve(workerNum);
-		for (int i = 0; i < workerNum; i++) {
-			Aligner<V> *aligner = new Aligner<V>(*id, dbBlock, dlm,
-					canReportAll, threshold, canRelax);
+		alignerList.reserve(alignerNum);
+		vector<future<void> > futureList;
+		futureList.reserve(alignerNum);
+		for (int i = 0; i < alignerNum; i++) {
+			Aligner<V> *aligner = new Aligner<V>(*id, dbBlock,
+					shards != nullptr ? shards->getShard(i) : out, dlm,
+					canReportAll, threshold, canRelax, format, topK,
+					alignerThreadNum);
 			alignerList.push_back(aligner);
-			futureList.push_back(
-					std::async([aligner]() -> std::pair<bool, stringstream*> {
-						return aligner->start();
-					}));
+			futureList.push_back(std::async([aligner]() {
+				aligner->start();
+			}));
 		}
 
 		// Read a block and pass it to one of the workers
 		int nextIndex = 0;
 		while (true) {
 			if (buffer.size() > 0) {
+				qrySeqNum += buffer.front().first->size();
 				alignerList.at(nextIndex)->enqueueBlock(buffer.front());
 				buffer.pop();
-				nextIndex = (nextIndex + 1) % workerNum;
+				nextIndex = (nextIndex + 1) % alignerNum;
 			} else if (!qryReader->isStillReading()) {
 				break;
 			} else {
@@ -534,23 +694,32 @@ void ReaderAlignerCoordinator::helper2(string fileDb, string fileQry,
 		}
 
 		// Tell the workers that no more blocks will be passed to them.
-		for (int i = 0; i < workerNum; i++) {
+		for (int i = 0; i < alignerNum; i++) {
 			alignerList.at(i)->stop();
 		}
 
 		// Wait until all of the workers are done.
-		for (int i = 0; i < workerNum; i++) {
-			auto p = futureList.at(i).get();
-			if (p.first) {
-				out << p.second->rdbuf();
+		for (int i = 0; i < alignerNum; i++) {
+			futureList.at(i).get();
+		}
+		tuner.stop(qrySeqNum * dbBlock->size());
+
+		// The database has been searched for the queries of this block
+		if (topK > 0) {
+			TopHits *hits = alignerList.at(0)->getHits();
+			for (int i = 1; i < alignerNum; i++) {
+				hits->merge(*alignerList.at(i)->getHits());
 			}
+			PairWriter writer(shards != nullptr ? shards->getShard(0) : out,
+					format, dlm, 4);
+			hits->write(writer, *dbBlock);
 		}
 
 		// Free resources
 		FastaReader::deleteBlock(dbBlock);
 
 		// Delete the aligners
-		for (int i = 0; i < workerNum; i++) {
+		for (int i = 0; i < alignerNum; i++) {
 			delete alignerList.at(i);
 		}
 		alignerList.clear();
@@ -560,7 +729,12 @@ void ReaderAlignerCoordinator::helper2(string fileDb, string fileQry,
 	cout << endl;
 
 // Close output file.
-	out.flush();
-	out.close();
+	if (shards != nullptr) {
+		shards->close();
+		delete shards;
+	} else {
+		out->close();
+		delete out;
+	}
 	delete id;
 }
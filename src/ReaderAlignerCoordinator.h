@@ -29,6 +29,7 @@
 #include <chrono>
 
 #include "FastaReader.h"
+#include "FastaIndex.h"
 #include "Aligner.h"
 #include "Parameters.h"
 #include "GLMClassifier.h"
@@ -36,6 +37,9 @@
 #include "SynDataGenerator.h"
 #include "AlignerParallel.h"
 #include "IdentityCalculator.h"
+#include "ThreadTuner.h"
+#include "ScoreMatrix.h"
+#include "SortedReader.h"
 
 using namespace std;
 
@@ -49,10 +53,28 @@ private:
 	bool canSaveModel;
 	bool canFillModel;
 	std::string modelFile;
+	// Select the number of aligner threads by measuring the throughput
+	bool canTune;
+	// Write the pairs in the binary format (see PairWriter)
+	bool isBinary;
+	// All vs. all as a matrix: tri (see ScoreMatrix), phylip, or npy.
+	// Empty for pairs.
+	std::string matrixFormat;
+	// Report the best K hits of each query if positive
+	int topK;
+	// Each thread writes to its own shard; the output file is a manifest
+	bool isSharded;
+	// Reject most dissimilar pairs by a classifier first (see Prefilter)
+	bool canPrefilter;
+	// Score folded histograms first (see CoarseScorer)
+	bool canCascade;
 
 	void alignFileVsFile1(string, string, string, string, bool);
 	void alignFileVsFile2(string, string, string, string, bool);
+	int64_t findMaxLength(string, string, int64_t);
 
+	template<class V, class R>
+	void alignBlockA(AlignerParallel<V>&, R&, ThreadTuner&);
 	template<class V>
 	void helper1(string, string, string, string, bool,
 			AlignerParallel<V> &aligner);
@@ -65,7 +87,11 @@ private:
 
 public:
 	ReaderAlignerCoordinator(int, int, double, bool, bool, bool canSaveModel =
-			false, bool canFillModel = false, std::string modelFile = "");
+			false, bool canFillModel = false, std::string modelFile = "",
+			bool canTune = false, bool isBinary = false,
+			std::string matrixFormat = "", int topK = 0,
+			bool isSharded = false, bool canPrefilter = false,
+			bool canCascade = false);
 	virtual ~ReaderAlignerCoordinator();
 
 	void alignAllVsAll(string, string, string);
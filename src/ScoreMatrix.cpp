@@ -0,0 +1,263 @@
+/*
+ Identity 2.0 calculates DNA sequence identity scores rapidly without alignment.
+
+ Copyright (C) 2020-2022 Hani Z. Girgis, PhD
+
+ Academic use: Affero General Public License version 1.
+
+ Any restrictions to use for-profit or non-academics: Alternative commercial license is needed.
+
+ This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+ Please contact Dr. Hani Z. Girgis (hzgirgis@buffalo.edu) if you need more information.
+ */
+
+
+/*
+ * ScoreMatrix.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Hani Z. Girgis, PhD
+ */
+
+#include "ScoreMatrix.h"
+#include "OutputWriter.h"
+
+#include <iostream>
+#include <algorithm>
+#include <cstring>
+#include <cstdio>
+#include <charconv>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+static const char MAGIC[8] = { 'I', 'D', 'M', 'A', 'T', 'R', 'X', 1 };
+// The scores start at a page boundary
+static const uint64_t PAGE = 4096;
+// Length of the fixed part: magic, size, and offset
+static const uint64_t PREFIX = 24;
+
+/**
+ * Number of pairs (i < j) among n sequences
+ */
+static uint64_t countPairs(uint64_t n) {
+	return n < 2 ? 0 : n * (n - 1) / 2;
+}
+
+ScoreMatrix::ScoreMatrix(std::string fileNameIn, const FastaIndex &index) {
+	fileName = fileNameIn;
+	size = index.getCount();
+	isWritable = true;
+
+	std::string prefix(PREFIX, '\0');
+	memcpy(&prefix[0], MAGIC, 8);
+	memcpy(&prefix[8], &size, 8);
+	for (uint64_t i = 0; i < size; i++) {
+		std::string_view header = index.getHeader(i);
+		uint32_t len = header.size();
+		prefix.append((const char*) &len, 4);
+		prefix.append(header);
+	}
+	uint64_t offset = ((prefix.size() + PAGE - 1) / PAGE) * PAGE;
+	memcpy(&prefix[16], &offset, 8);
+
+	fd = open(fileName.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0) {
+		std::cerr << "ScoreMatrix error: Cannot open file: " << fileName
+				<< std::endl;
+		throw std::exception();
+	}
+
+	// The file is sparse; unset scores read as 0
+	mapSize = offset + countPairs(size) * sizeof(float);
+	if (ftruncate(fd, mapSize) != 0) {
+		std::cerr << "ScoreMatrix error: Cannot allocate " << mapSize;
+		std::cerr << " bytes for file: " << fileName << std::endl;
+		::close(fd);
+		throw std::exception();
+	}
+
+	map(offset, true);
+	memcpy(base, prefix.data(), prefix.size());
+}
+
+ScoreMatrix::ScoreMatrix(std::string fileNameIn) {
+	fileName = fileNameIn;
+	isWritable = false;
+
+	fd = open(fileName.c_str(), O_RDONLY);
+	struct stat info;
+	char magic[8];
+	uint64_t offset = 0;
+	size = 0;
+	bool isValid = fd >= 0 && fstat(fd, &info) == 0
+			&& pread(fd, magic, 8, 0) == 8 && memcmp(magic, MAGIC, 8) == 0
+			&& pread(fd, &size, 8, 8) == 8 && pread(fd, &offset, 8, 16) == 8;
+	if (isValid) {
+		mapSize = offset + countPairs(size) * sizeof(float);
+		isValid = offset >= PREFIX && (uint64_t) info.st_size == mapSize;
+	}
+
+	if (!isValid) {
+		if (fd >= 0) {
+			::close(fd);
+		}
+		std::cerr << "ScoreMatrix error: " << fileName;
+		std::cerr << " is not a matrix file of Identity." << std::endl;
+		throw std::exception();
+	}
+
+	map(offset, false);
+}
+
+void ScoreMatrix::map(size_t offset, bool canWrite) {
+	int prot = canWrite ? PROT_READ | PROT_WRITE : PROT_READ;
+	void *m = mmap(nullptr, mapSize, prot, MAP_SHARED, fd, 0);
+	if (m == MAP_FAILED) {
+		std::cerr << "ScoreMatrix error: Cannot map file: " << fileName
+				<< std::endl;
+		::close(fd);
+		throw std::exception();
+	}
+	base = (char*) m;
+	scoreList = (float*) (base + offset);
+}
+
+ScoreMatrix::~ScoreMatrix() {
+	munmap(base, mapSize);
+	::close(fd);
+}
+
+uint64_t ScoreMatrix::getSize() const {
+	return size;
+}
+
+void ScoreMatrix::set(uint64_t i, uint64_t j, float score) {
+	if (i > j) {
+		std::swap(i, j);
+	}
+	scoreList[i * size - i * (i + 1) / 2 + j - i - 1] = score;
+}
+
+float ScoreMatrix::get(uint64_t i, uint64_t j) const {
+	if (i == j) {
+		return 1.0f;
+	}
+	if (i > j) {
+		std::swap(i, j);
+	}
+	return scoreList[i * size - i * (i + 1) / 2 + j - i - 1];
+}
+
+std::vector<std::string> ScoreMatrix::readHeaderList() const {
+	std::vector<std::string> headerList;
+	headerList.reserve(size);
+	const char *p = base + PREFIX;
+	for (uint64_t i = 0; i < size; i++) {
+		uint32_t len;
+		memcpy(&len, p, 4);
+		headerList.push_back(std::string(p + 4, len));
+		p += 4 + len;
+	}
+	return headerList;
+}
+
+/**
+ * Same as printf("%.8f")
+ */
+static void appendDistance(std::string &row, double d) {
+	char s[32];
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+	auto r = std::to_chars(s, s + sizeof(s), d, std::chars_format::fixed, 8);
+	row.append(s, r.ptr - s);
+#else
+	int n = snprintf(s, sizeof(s), "%.8f", d);
+	row.append(s, n);
+#endif
+}
+
+/**
+ * Each line has the header (without >), a tab, and the space-separated
+ * distances to all sequences. Rows are formatted in parallel in batches.
+ */
+void ScoreMatrix::writePhylip(std::string outFile, int threadNum) const {
+	std::vector<std::string> headerList = readHeaderList();
+
+	// Small buffers would compress poorly; rows are collected first
+	OutputWriter out(outFile, threadNum);
+	std::string *buffer = new std::string(std::to_string(size) + "\n");
+
+	int64_t batch = 16 * threadNum;
+	std::vector<std::string> rowList(batch);
+	for (int64_t first = 0; first < (int64_t) size; first += batch) {
+		int64_t last = std::min(first + batch, (int64_t) size);
+
+#pragma omp parallel for schedule(dynamic) num_threads(threadNum)
+		for (int64_t i = first; i < last; i++) {
+			std::string &row = rowList[i - first];
+			const std::string &header = headerList[i];
+			row.clear();
+			row.reserve(header.size() + 11 * size + 1);
+			if (!header.empty() && header[0] == '>') {
+				row.append(header, 1, std::string::npos);
+			} else {
+				row.append(header);
+			}
+			row.push_back('\t');
+			for (uint64_t j = 0; j < size; j++) {
+				if (j > 0) {
+					row.push_back(' ');
+				}
+				appendDistance(row, 1.0 - get(i, j));
+			}
+			row.push_back('\n');
+		}
+
+		for (int64_t i = first; i < last; i++) {
+			buffer->append(rowList[i - first]);
+			if (buffer->size() >= OutputWriter::BUFFER_SIZE) {
+				out.submit(buffer);
+				buffer = new std::string();
+			}
+		}
+	}
+	out.submit(buffer);
+	out.close();
+}
+
+/**
+ * A 1-D float32 array in the condensed form used by SciPy; a square
+ * matrix is obtained by scipy.spatial.distance.squareform.
+ */
+void ScoreMatrix::writeNpy(std::string outFile) const {
+	uint64_t count = countPairs(size);
+	std::string dict = "{'descr': '<f4', 'fortran_order': False, 'shape': ("
+			+ std::to_string(count) + ",), }";
+	// Magic (6), version (2), and header length (2) precede the dictionary,
+	// which is padded with spaces and ends with a new line
+	size_t headerLen = ((10 + dict.size() + 1 + 63) / 64) * 64 - 10;
+	dict.resize(headerLen - 1, ' ');
+	dict.push_back('\n');
+	uint16_t len = headerLen;
+
+	OutputWriter out(outFile);
+	std::string *header = new std::string("\x93NUMPY\x01\x00", 8);
+	header->append((const char*) &len, 2);
+	header->append(dict);
+	out.submit(header);
+
+	const uint64_t chunk = OutputWriter::BUFFER_SIZE / sizeof(float);
+	for (uint64_t first = 0; first < count; first += chunk) {
+		uint64_t n = std::min(chunk, count - first);
+		std::string *buffer = new std::string(n * sizeof(float), '\0');
+		float *distList = (float*) &(*buffer)[0];
+		for (uint64_t r = 0; r < n; r++) {
+			distList[r] = 1.0f - scoreList[first + r];
+		}
+		out.submit(buffer);
+	}
+	out.close();
+}
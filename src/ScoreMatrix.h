@@ -0,0 +1,84 @@
+/*
+ Identity 2.0 calculates DNA sequence identity scores rapidly without alignment.
+
+ Copyright (C) 2020-2022 Hani Z. Girgis, PhD
+
+ Academic use: Affero General Public License version 1.
+
+ Any restrictions to use for-profit or non-academics: Alternative commercial license is needed.
+
+ This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+ Please contact Dr. Hani Z. Girgis (hzgirgis@buffalo.edu) if you need more information.
+ */
+
+
+/*
+ * ScoreMatrix.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Hani Z. Girgis, PhD
+ *     Purpose: The all-vs-all identity scores as a memory-mapped, packed
+ *     upper-triangular matrix of float32 (the diagonal is not stored).
+ *     Aligner threads write scores straight into their positions. Pairs
+ *     that are not reported keep the score 0. The matrix can be streamed
+ *     to a Phylip distance matrix or to a condensed NumPy distance vector
+ *     (distance = 1 - identity).
+ *
+ *     The file (little-endian) consists of:
+ *     + "IDMATRX" followed by the format version (1 byte)
+ *     + The number of sequences (uint64) and the offset of the scores (uint64)
+ *     + The headers: the length (uint32) and the characters of each header
+ *     + Padding to a page boundary, then the scores of (0, 1), (0, 2), ...,
+ *       (0, n-1), (1, 2), ..., (n-2, n-1)
+ */
+
+#ifndef SRC_SCOREMATRIX_H_
+#define SRC_SCOREMATRIX_H_
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "FastaIndex.h"
+
+class ScoreMatrix {
+private:
+	std::string fileName;
+	int fd;
+	char *base;
+	size_t mapSize;
+	float *scoreList;
+	uint64_t size;
+	bool isWritable;
+
+	void map(size_t, bool);
+	std::vector<std::string> readHeaderList() const;
+
+public:
+	/**
+	 * Create a matrix of the sequences in an index. All scores are 0.
+	 */
+	ScoreMatrix(std::string, const FastaIndex&);
+	/**
+	 * Open a matrix file for reading
+	 */
+	ScoreMatrix(std::string);
+	ScoreMatrix(const ScoreMatrix&) = delete;
+	ScoreMatrix& operator=(const ScoreMatrix&) = delete;
+	virtual ~ScoreMatrix();
+
+	uint64_t getSize() const;
+
+	/**
+	 * Thread safe as long as threads set different pairs
+	 */
+	void set(uint64_t, uint64_t, float);
+	float get(uint64_t, uint64_t) const;
+
+	void writePhylip(std::string, int threadNum = 1) const;
+	void writeNpy(std::string) const;
+};
+
+#endif /* SRC_SCOREMATRIX_H_ */
@@ -45,10 +45,19 @@ std::ostream& operator<<(std::ostream &out, Feature &f) {
 	return out;
 }
 
+/**
+ * The features of the optional stages follow those of the regressor, each
+ * after a line:
+ * prefilter threshold cutoff
+ * coarse k foldNum threshold cutoff
+ */
 Serializer::Serializer(std::vector<Feature*> *featList, double *compList, int k,
-		int histSize, double absError, int64_t maxLength, std::string file) {
+		int histSize, double absError, int64_t maxLength, std::string file,
+		Prefilter *prefilter, CoarseScorer *coarse) {
 
 	canOwnData = false;
+	preList = nullptr;
+	coarseList = nullptr;
 	this->featList = featList;
 	this->compList = compList;
 	this->k = k;
@@ -71,6 +80,23 @@ Serializer::Serializer(std::vector<Feature*> *featList, double *compList, int k,
 	for (Feature *f : *featList) {
 		out << (*f);
 	}
+
+	if (prefilter != nullptr) {
+		out << "prefilter\t" << prefilter->getThreshold() << "\t"
+				<< prefilter->getCutoff() << std::endl;
+		for (Feature *f : *prefilter->getFeatureList()) {
+			out << (*f);
+		}
+	}
+
+	if (coarse != nullptr) {
+		out << "coarse\t" << k - coarse->getFoldNum() << "\t"
+				<< coarse->getFoldNum() << "\t" << coarse->getThreshold()
+				<< "\t" << coarse->getCutoff() << std::endl;
+		for (Feature *f : *coarse->getFeatureList()) {
+			out << (*f);
+		}
+	}
 	out.close();
 }
 
@@ -93,6 +119,46 @@ Serializer::Serializer(std::string file) {
 
 	// Fill feature list
 	featList = new std::vector<Feature*>();
+	readFeatureList(in, featList);
+
+	// Fill the optional stages
+	preList = nullptr;
+	preThreshold = 0.0;
+	preCutoff = 0.0;
+	coarseList = nullptr;
+	coarseK = 0;
+	foldNum = 0;
+	coarseThreshold = 0.0;
+	coarseCutoff = 0.0;
+	while (!in.eof()) {
+		in.clear();
+		std::string section;
+		if (!(in >> section)) {
+			break;
+		}
+		if (section == "prefilter" && preList == nullptr) {
+			in >> preThreshold >> preCutoff;
+			preList = new std::vector<Feature*>();
+			readFeatureList(in, preList);
+		} else if (section == "coarse" && coarseList == nullptr) {
+			in >> coarseK >> foldNum >> coarseThreshold >> coarseCutoff;
+			coarseList = new std::vector<Feature*>();
+			readFeatureList(in, coarseList);
+		} else {
+			std::cerr << "Serializer error: Unexpected section in " << file
+					<< ": " << section << std::endl;
+			throw std::exception();
+		}
+	}
+
+	in.close();
+}
+
+/**
+ * Read features until a line is not a feature
+ */
+void Serializer::readFeatureList(std::istream &in,
+		std::vector<Feature*> *featList) {
 	int compNum;
 	int funIndex;
 	std::string name;
@@ -166,7 +232,6 @@ Serializer::Serializer(std::string file) {
 		featList->push_back(f);
 	}
 
-	in.close();
 }
 
 Serializer::~Serializer() {
@@ -178,6 +243,15 @@ Serializer::~Serializer() {
 		}
 		featList->clear();
 		delete featList;
+
+		for (auto list : { preList, coarseList }) {
+			if (list != nullptr) {
+				for (Feature *fPtr : *list) {
+					delete fPtr;
+				}
+				delete list;
+			}
+		}
 	}
 }
 
@@ -205,3 +279,34 @@ int64_t Serializer::getMaxLength() const {
 	return maxLength;
 }
 
+std::vector<Feature*>* Serializer::getPrefilterList() const {
+	return preList;
+}
+
+double Serializer::getPrefilterThreshold() const {
+	return preThreshold;
+}
+
+double Serializer::getPrefilterCutoff() const {
+	return preCutoff;
+}
+
+std::vector<Feature*>* Serializer::getCoarseList() const {
+	return coarseList;
+}
+
+int Serializer::getCoarseK() const {
+	return coarseK;
+}
+
+int Serializer::getFoldNum() const {
+	return foldNum;
+}
+
+double Serializer::getCoarseThreshold() const {
+	return coarseThreshold;
+}
+
+double Serializer::getCoarseCutoff() const {
+	return coarseCutoff;
+}
@@ -33,6 +33,8 @@
 #include "FeatureSquared.h"
 #include "FeaturePaired.h"
 #include "Parameters.h"
+#include "Prefilter.h"
+#include "CoarseScorer.h"
 
 class Serializer {
 private:
@@ -43,10 +45,28 @@ private:
 	double absError;
 	bool canOwnData;
 	int64_t maxLength;
+	// The features of the classifier that rejects pairs first (see
+	// Prefilter); nullptr if the model has no prefilter
+	std::vector<Feature*> *preList;
+	double preThreshold;
+	double preCutoff;
+	// The features of the model scoring folded histograms first (see
+	// CoarseScorer); nullptr if the model has no such stage
+	std::vector<Feature*> *coarseList;
+	int coarseK;
+	int foldNum;
+	double coarseThreshold;
+	double coarseCutoff;
+
+	static void readFeatureList(std::istream&, std::vector<Feature*>*);
 
 public:
+	/**
+	 * The stages ahead of the regressor are optional
+	 */
 	Serializer(std::vector<Feature*>*, double*, int, int, double, int64_t,
-			std::string);
+			std::string, Prefilter *prefilter = nullptr,
+			CoarseScorer *coarse = nullptr);
 	Serializer(std::string);
 
 	virtual ~Serializer();
@@ -103,6 +123,14 @@ public:
 	int getK() const;
 	double getAbsError() const;
 	int64_t getMaxLength() const;
+	std::vector<Feature*>* getPrefilterList() const;
+	double getPrefilterThreshold() const;
+	double getPrefilterCutoff() const;
+	std::vector<Feature*>* getCoarseList() const;
+	int getCoarseK() const;
+	int getFoldNum() const;
+	double getCoarseThreshold() const;
+	double getCoarseCutoff() const;
 };
 
 #endif /* SRC_SERIALIZER_H_ */
@@ -0,0 +1,85 @@
+/*
+ Identity 2.0 calculates DNA sequence identity scores rapidly without alignment.
+
+ Copyright (C) 2020-2022 Hani Z. Girgis, PhD
+
+ Academic use: Affero General Public License version 1.
+
+ Any restrictions to use for-profit or non-academics: Alternative commercial license is needed.
+
+ This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+ Please contact Dr. Hani Z. Girgis (hzgirgis@buffalo.edu) if you need more information.
+ */
+
+/*
+ * SortedReader.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Hani Z. Girgis, PhD
+ */
+
+#include "SortedReader.h"
+
+#include <algorithm>
+
+SortedReader::SortedReader(std::string fileName, const FastaIndex &indexIn,
+		const std::vector<uint32_t> &orderListIn, int blockSizeIn,
+		size_t first) :
+		index(indexIn), orderList(orderListIn), reader(fileName, blockSizeIn) {
+	blockSize = blockSizeIn;
+	next = std::min(first, orderList.size());
+	end = orderList.size();
+	lastLength = 0;
+}
+
+SortedReader::~SortedReader() {
+}
+
+Block* SortedReader::read() {
+	size_t first = next;
+	size_t last = std::min(first + blockSize, end);
+	std::vector<uint32_t> idList(orderList.begin() + first,
+			orderList.begin() + last);
+	if (!idList.empty()) {
+		lastLength = index.getLength(idList.back());
+	}
+
+	// File order is faster to read and keeps the pairs in the order of the
+	// records within a block
+	std::sort(idList.begin(), idList.end());
+	Block *b = index.fetch(reader, idList);
+	next = last;
+	return b;
+}
+
+bool SortedReader::isStillReading() const {
+	return next < end;
+}
+
+void SortedReader::setThreadNum(int threadNum) {
+	reader.setThreadNum(threadNum);
+}
+
+size_t SortedReader::getNext() const {
+	return next;
+}
+
+int64_t SortedReader::getLastLength() const {
+	return lastLength;
+}
+
+/**
+ * Lengths are compared as the aligners do, so the same pairs are skipped
+ */
+void SortedReader::stopBelow(double ratio, int64_t length) {
+	double maximum = length;
+	auto first = orderList.begin() + next;
+	auto last = std::partition_point(first, orderList.begin() + end,
+			[&](uint32_t id) {
+				double minimum = index.getLength(id);
+				return !(minimum / maximum < ratio);
+			});
+	end = last - orderList.begin();
+}
@@ -0,0 +1,79 @@
+/*
+ Identity 2.0 calculates DNA sequence identity scores rapidly without alignment.
+
+ Copyright (C) 2020-2022 Hani Z. Girgis, PhD
+
+ Academic use: Affero General Public License version 1.
+
+ Any restrictions to use for-profit or non-academics: Alternative commercial license is needed.
+
+ This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+ Please contact Dr. Hani Z. Girgis (hzgirgis@buffalo.edu) if you need more information.
+ */
+
+/*
+ * SortedReader.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Hani Z. Girgis, PhD
+ *     Purpose: Reads the records of a file in blocks, from the longest
+ *     sequence to the shortest one, by random access through its FastaIndex.
+ *     Two sequences whose length ratio is below the threshold are never
+ *     similar; so a block is only aligned versus the next blocks up to the
+ *     first sequence that is too short for its shortest one. The records of
+ *     a block are in file order.
+ */
+
+#ifndef SRC_SORTEDREADER_H_
+#define SRC_SORTEDREADER_H_
+
+#include <string>
+#include <vector>
+#include <atomic>
+#include <cstdint>
+
+#include "FastaReader.h"
+#include "FastaIndex.h"
+
+class SortedReader {
+private:
+	const FastaIndex &index;
+	// The record numbers from the longest sequence to the shortest one
+	const std::vector<uint32_t> &orderList;
+	FastaReader reader;
+	int blockSize;
+
+	// The next record to read and the end of the records to read in the
+	// order list
+	std::atomic<size_t> next;
+	size_t end;
+	// The length of the shortest sequence read so far
+	int64_t lastLength;
+
+public:
+	SortedReader(std::string, const FastaIndex&, const std::vector<uint32_t>&,
+			int, size_t first = 0);
+	SortedReader(const SortedReader&) = delete;
+	SortedReader& operator=(const SortedReader&) = delete;
+	virtual ~SortedReader();
+
+	Block* read();
+	bool isStillReading() const;
+	void setThreadNum(int);
+
+	/**
+	 * The place of the next record in the order list
+	 */
+	size_t getNext() const;
+	int64_t getLastLength() const;
+
+	/**
+	 * Stop before the first sequence whose length divided by the given one
+	 * is below the ratio. Call it before reading.
+	 */
+	void stopBelow(double, int64_t);
+};
+
+#endif /* SRC_SORTEDREADER_H_ */
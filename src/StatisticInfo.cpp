@@ -91,3 +91,51 @@ std::vector<Feature*>* StatisticInfo::getList() {
 int StatisticInfo::getStatNum() {
 	return fList->size();
 }
+
+std::vector<int> StatisticInfo::getCheapIndexList() {
+	std::vector<int> r;
+	int size = fList->size();
+	for (int i = 0; i < size; i++) {
+		switch (fList->at(i)->getFunIndex()) {
+		case Stat::MANHATTAN:
+		case Stat::EUCLIDEAN:
+		case Stat::CHEBYSHEV:
+		case Stat::HAMMING:
+		case Stat::MINKOWSKI:
+		case Stat::KULCZYNSKI_2:
+		case Stat::SIM_RATIO:
+			r.push_back(i);
+			break;
+		default:
+			break;
+		}
+	}
+	return r;
+}
+
+std::vector<int> StatisticInfo::getKeyFreeIndexList() {
+	std::vector<int> r;
+	int size = fList->size();
+	for (int i = 0; i < size; i++) {
+		switch (fList->at(i)->getFunIndex()) {
+		case Stat::SIM_MM:
+		case Stat::D2S_R:
+		case Stat::D2STAR:
+			break;
+		default:
+			r.push_back(i);
+			break;
+		}
+	}
+	return r;
+}
+
+int StatisticInfo::findPosition(int funIndex) {
+	int size = fList->size();
+	for (int i = 0; i < size; i++) {
+		if (fList->at(i)->getFunIndex() == funIndex) {
+			return i;
+		}
+	}
+	return -1;
+}
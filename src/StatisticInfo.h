@@ -43,6 +43,21 @@ public:
 	virtual ~StatisticInfo();
 	std::vector<Feature*>* getList();
 	int getStatNum();
+	/**
+	 * Positions in the list of the statistics that take one pass over the
+	 * histograms without a division or a logarithm per entry
+	 */
+	std::vector<int> getCheapIndexList();
+	/**
+	 * Positions in the list of the statistics that do not read the
+	 * characters of the key of a bin. The others mean nothing on hashed
+	 * histograms, where a bin holds many k-mers.
+	 */
+	std::vector<int> getKeyFreeIndexList();
+	/**
+	 * The position of a statistic in the list (-1 if it is not found)
+	 */
+	int findPosition(int);
 };
 
 #endif /* STATISTICINFO_H_ */
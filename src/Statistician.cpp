@@ -59,10 +59,14 @@ double (Statistician<V>::*Statistician<V>::methodList[Stat::ALL_NUM])() = {
 template<class V>
 Statistician<V>::Statistician(int histogramSizeIn, int kIn, const V *h1In,
 		const V *h2In, const uint64_t *mono1In, const uint64_t *mono2In,
-		const double *backgroundIn, const uint8_t *keyListIn) :
+		const double *backgroundIn, int threadNumIn) :
 		histogramSize(histogramSizeIn), k(kIn), h1(h1In), h2(h2In), mono1(
-				mono1In), mono2(mono2In), background(backgroundIn), keyList(
-				keyListIn) {
+				mono1In), mono2(mono2In), background(backgroundIn), threadNum(
+				threadNumIn) {
+	keyLength = 0;
+	for (int64_t s = 1; s < histogramSize; s *= alphaSize) {
+		keyLength++;
+	}
 
 	// Calculate means
 	mean1 = mean(h1);
@@ -81,18 +85,15 @@ Statistician<V>::Statistician(int histogramSizeIn, int kIn, const V *h1In,
 	uint64_t s2 = sum(h2) + histogramSize;
 	p1 = new double[histogramSize];
 	p2 = new double[histogramSize];
+	// Calculate mean vector element wise
+	mean1And2 = new V[histogramSize];
 
-	for (int i = 0; i < histogramSize; i++) {
+	forEachBin([this, s1, s2](int i) {
 		p1[i] = (h1[i] + 1.0) / s1;
 		p2[i] = (h2[i] + 1.0) / s2;
-	}
-
-	// Calculate mean vector element wise
-	mean1And2 = new V[histogramSize];
-	for (int i = 0; i < histogramSize; i++) {
 		uint64_t m = h1[i] + h2[i];
 		mean1And2[i] = round(m / 2.0);
-	}
+	});
 }
 
 template<class V>
@@ -104,20 +105,17 @@ Statistician<V>::~Statistician() {
 
 template<class V>
 double Statistician<V>::manhattanDistance() {
-	double d = 0.0;
-	for (int i = 0; i < histogramSize; i++) {
-		d += absolute(h1[i] - h2[i]);
-	}
-	return d;
+	return sweep<double>([this](int i) -> double {
+		return absolute(h1[i] - h2[i]);
+	});
 }
 
 template<class V>
 double Statistician<V>::euclideanDistance() {
-	double d = 0.0;
-	for (int i = 0; i < histogramSize; i++) {
+	double d = sweep<double>([this](int i) -> double {
 		double temp = h1[i] - h2[i];
-		d += temp * temp;
-	}
+		return temp * temp;
+	});
 	return sqrt(d);
 }
 
@@ -135,37 +133,28 @@ double Statistician<V>::canberraDistance() {
 
 template<class V>
 double Statistician<V>::chiSquaredDistance() {
-	double d = 0.0;
-	for (int i = 0; i < histogramSize; i++) {
+	return sweep<double>([this](int i) -> double {
 		// Skip row if both entries are zeros.
 		if (h1[i] > 0 || h2[i] > 0) {
 			double diff = h1[i] - h2[i];
-			d += (diff * diff) / (h1[i] + h2[i]);
+			return (diff * diff) / (h1[i] + h2[i]);
 		}
-	}
-	return d;
+		return 0.0;
+	});
 }
 
 template<class V>
 double Statistician<V>::chebyshevDistance() {
-	double d = 0.0;
-	for (int i = 0; i < histogramSize; i++) {
-		V diff = absolute(h1[i] - h2[i]);
-		if (diff > d) {
-			d = diff;
-		}
-	}
-	return d;
+	return sweepMax<double>([this](int i) -> double {
+		return absolute(h1[i] - h2[i]);
+	});
 }
 
 template<class V>
 double Statistician<V>::hammingDistance() {
-	double d = 0.0;
-	for (int i = 0; i < histogramSize; i++) {
-		if (h1[i] != h2[i]) {
-			d++;
-		}
-	}
+	double d = sweep<double>([this](int i) -> double {
+		return h1[i] != h2[i] ? 1.0 : 0.0;
+	});
 	return d / histogramSize;
 }
 
@@ -174,12 +163,10 @@ double Statistician<V>::hammingDistance() {
  */
 template<class V>
 double Statistician<V>::minkowskiDistance() {
-	long long int d = 0.0;
-
-	for (int i = 0; i < histogramSize; i++) {
+	long long int d = sweep<long long int>([this](int i) -> long long int {
 		V z = absolute(h1[i] - h2[i]);
-		d += (z * z * z);
-	}
+		return (z * z * z);
+	});
 
 	return std::cbrt(d);
 }
@@ -189,10 +176,9 @@ double Statistician<V>::minkowskiDistance() {
  */
 template<class V>
 double Statistician<V>::cosineDistanceHelper(const V *v1, const V *v2) {
-	double d = 0.0;
-	for (int i = 0; i < histogramSize; i++) {
-		d += v1[i] * v2[i];
-	}
+	double d = sweep<double>([v1, v2](int i) -> double {
+		return v1[i] * v2[i];
+	});
 
 	double n1 = norm(v1);
 	double n2 = norm(v2);
@@ -225,19 +211,15 @@ double Statistician<V>::cosineDistance() {
 
 template<class V>
 double Statistician<V>::correlationDistance() {
-	// Center h1 around its mean.
+	// Center h1 and h2 around their means.
 	V *n1 = new V[histogramSize];
-	double m1 = round(mean1);
-	for (int i = 0; i < histogramSize; i++) {
-		n1[i] = h1[i] - m1;
-	}
-
-	// Center h2 around its mean.
 	V *n2 = new V[histogramSize];
+	double m1 = round(mean1);
 	double m2 = round(mean2);
-	for (int i = 0; i < histogramSize; i++) {
+	forEachBin([this, n1, n2, m1, m2](int i) {
+		n1[i] = h1[i] - m1;
 		n2[i] = h2[i] - m2;
-	}
+	});
 
 	// Calculate the cosine distance on the centered histograms.
 	double r = cosineDistanceHelper(n1, n2);
@@ -250,12 +232,12 @@ double Statistician<V>::correlationDistance() {
 
 template<class V>
 double Statistician<V>::braycurtisDistance() {
-	double d1 = 0.0;
-	double d2 = 0.0;
-	for (int i = 0; i < histogramSize; i++) {
-		d1 += absolute(h1[i] - h2[i]);
-		d2 += h1[i] + h2[i];
-	}
+	double d1;
+	double d2;
+	sweep([this](int i, double &s1, double &s2) {
+		s1 += absolute(h1[i] - h2[i]);
+		s2 += h1[i] + h2[i];
+	}, d1, d2);
 
 	if (Util::isEqual(d2, 0.0)) {
 		std::cerr << "Error at Bray-curtis distance. ";
@@ -268,32 +250,25 @@ double Statistician<V>::braycurtisDistance() {
 
 template<class V>
 double Statistician<V>::squaredChordDistance() {
-	double d = 0.0;
-	for (int i = 0; i < histogramSize; i++) {
-		d += h1[i] + h2[i] - 2 * sqrt(h1[i] * h2[i]);
-	}
-	return d;
+	return sweep<double>([this](int i) -> double {
+		return h1[i] + h2[i] - 2 * sqrt(h1[i] * h2[i]);
+	});
 }
 
 template<class V>
 double Statistician<V>::hellingerDistance() {
-	// Divide h1 by its mean.
+	// Divide h1 and h2 by their means.
 	double *n1 = new double[histogramSize];
-	for (int i = 0; i < histogramSize; i++) {
-		n1[i] = h1[i] / mean1;
-	}
-
-	// Divide h2 by its mean.
 	double *n2 = new double[histogramSize];
-	for (int i = 0; i < histogramSize; i++) {
+	forEachBin([this, n1, n2](int i) {
+		n1[i] = h1[i] / mean1;
 		n2[i] = h2[i] / mean2;
-	}
+	});
 
 	// Calculate Squared Chord Distance on n1 & n2
-	double d = 0.0;
-	for (int i = 0; i < histogramSize; i++) {
-		d += n1[i] + n2[i] - 2 * sqrt(n1[i] * n2[i]);
-	}
+	double d = sweep<double>([n1, n2](int i) -> double {
+		return n1[i] + n2[i] - 2 * sqrt(n1[i] * n2[i]);
+	});
 
 	delete[] n1;
 	delete[] n2;
@@ -376,11 +351,9 @@ double Statistician<V>::kDivergenceDistance() {
 template<class V>
 double Statistician<V>::jeffreyDivergenceDistance() {
 	// This is a symmetric statistic.
-	double d = 0.0;
-	for (int i = 0; i < histogramSize; i++) {
-		d += (p1[i] - p2[i]) * log(p1[i] / p2[i]);
-	}
-	return d;
+	return sweep<double>([this](int i) -> double {
+		return (p1[i] - p2[i]) * log(p1[i] / p2[i]);
+	});
 }
 
 template<class V>
@@ -542,15 +515,14 @@ double Statistician<V>::rreDistance() {
 
 template<class V>
 double Statistician<V>::intersectionSimilarity() {
-	double d = 0.0;
-	for (int i = 0; i < histogramSize; i++) {
+	return sweep<double>([this](int i) -> double {
 		uint64_t s = h1[i] + h2[i];
 		// Skip when both entries are zeros.
 		if (s != 0) {
-			d += 2.0 * std::min(h1[i], h2[i]) / s;
+			return 2.0 * std::min(h1[i], h2[i]) / s;
 		}
-	}
-	return d;
+		return 0.0;
+	});
 }
 
 /**
@@ -558,16 +530,15 @@ double Statistician<V>::intersectionSimilarity() {
  */
 template<class V>
 double Statistician<V>::kulczynski1Similarity() {
-	double d = 0.0;
 	double delta = 1.0 / histogramSize;
-	for (int i = 0; i < histogramSize; i++) {
+	return sweep<double>([this, delta](int i) -> double {
 		// Skip if both entries are zeros.
 		if (h1[i] > 0 || h2[i] > 0) {
-			d += (delta + std::min(h1[i], h2[i]))
+			return (delta + std::min(h1[i], h2[i]))
 					/ (delta + absolute(h1[i] - h2[i]));
 		}
-	}
-	return d;
+		return 0.0;
+	});
 }
 
 /**
@@ -576,10 +547,9 @@ double Statistician<V>::kulczynski1Similarity() {
  */
 template<class V>
 double Statistician<V>::kulczynski2Similarity() {
-	double d = 0.0;
-	for (int i = 0; i < histogramSize; i++) {
-		d += std::min(h1[i], h2[i]);
-	}
+	double d = sweep<double>([this](int i) -> double {
+		return std::min(h1[i], h2[i]);
+	});
 
 	double mu = histogramSize * (mean1 + mean2) / (2 * mean1 * mean2);
 
@@ -589,10 +559,9 @@ double Statistician<V>::kulczynski2Similarity() {
 template<class V>
 double Statistician<V>::covarianceSimilarityHelper(const V *t1, const V *t2,
 		double m1, double m2) {
-	double d = 0.0;
-	for (int i = 0; i < histogramSize; i++) {
-		d += (t1[i] - m1) * (t2[i] - m2);
-	}
+	double d = sweep<double>([t1, t2, m1, m2](int i) -> double {
+		return (t1[i] - m1) * (t2[i] - m2);
+	});
 	return d / histogramSize;
 }
 
@@ -632,13 +601,13 @@ double Statistician<V>::covarianceRSimilarity() {
  */
 template<class V>
 double Statistician<V>::harmonicMeanSimilarityHelper(const V *t1, const V *t2) {
-	double d = 0.0;
-	for (int i = 0; i < histogramSize; i++) {
+	double d = sweep<double>([t1, t2](int i) -> double {
 		// Skip row if both entries are zeros.
 		if (t1[i] > 0 || t2[i] > 0) {
-			d += (t1[i] * t2[i]) / (t1[i] + t2[i]);
+			return (t1[i] * t2[i]) / (t1[i] + t2[i]);
 		}
-	}
+		return 0.0;
+	});
 	return 2 * d;
 }
 
@@ -670,13 +639,13 @@ double Statistician<V>::harmonicMeanRSimilarity() {
 
 template<class V>
 double Statistician<V>::simRatioSimilarity() {
-	double dot = 0.0;
-	double norm = 0.0;
-	for (int i = 0; i < histogramSize; i++) {
-		dot += h1[i] * h2[i];
+	double dot;
+	double norm;
+	sweep([this](int i, double &s1, double &s2) {
+		s1 += h1[i] * h2[i];
 		V diff = h1[i] - h2[i];
-		norm += diff * diff;
-	}
+		s2 += diff * diff;
+	}, dot, norm);
 	double d = dot + sqrt(norm);
 
 	if (Util::isEqual(d, 0.0)) {
@@ -748,7 +717,9 @@ double Statistician<V>::simMMSimilarity() {
 
 	//const int alphaSize = Parameters::getAlphabetSize();
 
-	for (auto i = 0; i < histogramSize; i += alphaSize) {
+	// Add the terms of the words sharing the prefix of bin i
+	auto add = [this](int i, double &oneUnderOne, double &oneUnderTwo,
+			double &twoUnderOne, double &twoUnderTwo) {
 		uint64_t sum1 = alphaSize, sum2 = alphaSize;
 		for (auto j = 0; j < alphaSize; j++) {
 			sum1 += h1[i + j];
@@ -770,6 +741,18 @@ double Statistician<V>::simMMSimilarity() {
 			// h2 under h2's model
 			twoUnderTwo += h2[i + j] * hani2;
 		}
+	};
+
+	if (threadNum > 1) {
+#pragma omp parallel for schedule(static) num_threads(threadNum) \
+		reduction(+:oneUnderOne, oneUnderTwo, twoUnderOne, twoUnderTwo)
+		for (int i = 0; i < histogramSize; i += alphaSize) {
+			add(i, oneUnderOne, oneUnderTwo, twoUnderOne, twoUnderTwo);
+		}
+	} else {
+		for (auto i = 0; i < histogramSize; i += alphaSize) {
+			add(i, oneUnderOne, oneUnderTwo, twoUnderOne, twoUnderTwo);
+		}
 	}
 
 	uint64_t l1 = sum(h1);
@@ -812,7 +795,6 @@ double Statistician<V>::seuclideanDistance(const double *s) {
  * t1: histogram of the first sequence
  * t2: histogram of the second sequence
  * n: background model, e.g. n[4] = {0.25, 0.25, 0.25, 0.25}
- * keyList: key list in digit format, e.g. getKeysDigitFormat defined in KmerHistogram
  */
 template<class V>
 double Statistician<V>::d2sSimilarityHelper(const V *t1, const V *t2) {
@@ -825,15 +807,10 @@ double Statistician<V>::d2sSimilarityHelper(const V *t1, const V *t2) {
 		throw std::exception();
 	}
 
-	double d2 = 0.0;
-	for (int i = 0; i < histogramSize; i++) {
+	return sweep<double>([this, t1, t2, l1, l2](int i) -> double {
 		// Calculate expected values for a word according to the two sequences.
-		double e1 = l1;
-		double e2 = l2;
-		for (int j = 0; j < k; j++) {
-			e1 *= background[keyList[i * k + j]];
-			e2 *= background[keyList[i * k + j]];
-		}
+		double e1 = multiplyByKey(l1, background, i);
+		double e2 = multiplyByKey(l2, background, i);
 		// Adjust original counts by subtracting the expected values.
 		double a1 = t1[i] - e1;
 		double a2 = t2[i] - e2;
@@ -841,13 +818,10 @@ double Statistician<V>::d2sSimilarityHelper(const V *t1, const V *t2) {
 		double denom = sqrt(a1 * a1 + a2 * a2);
 		// Skip undefined rows when both adjusted counts are zeros.
 		if (!Util::isEqual(denom, 0.0)) {
-			d2 += (a1 * a2) / denom;
-		} else {
-			std::cout << "Skipped a row" << std::endl;
+			return (a1 * a2) / denom;
 		}
-	}
-
-	return d2;
+		return 0.0;
+	});
 }
 
 template<class V>
@@ -897,31 +871,24 @@ double Statistician<V>::d2starSimilarity() {
 		throw std::exception();
 	}
 
-	double d2 = 0.0;
 	double l = sqrt(l1 * l2);
-	for (int i = 0; i < histogramSize; i++) {
-		double e1 = l1;
-		double e2 = l2;
-		double e = l;
-		for (int j = 0; j < k; j++) {
-			// Calculate expected values for a word according to the background model.
-			e1 *= background[keyList[i * k + j]];
-			e2 *= background[keyList[i * k + j]];
-			// Calculate expected values for a word according to the two sequences.
-			e *= p[keyList[i * k + j]];
-		}
+	const double *q = p;
+	return sweep<double>([this, l1, l2, l, q](int i) -> double {
+		// Calculate expected values for a word according to the background model.
+		double e1 = multiplyByKey(l1, background, i);
+		double e2 = multiplyByKey(l2, background, i);
+		// Calculate expected values for a word according to the two sequences.
+		double e = multiplyByKey(l, q, i);
 		// Adjust original counts by subtracting the expected values.
 		double a1 = h1[i] - e1;
 		double a2 = h2[i] - e2;
 
 		// Skip undefined rows when both adjusted counts are zeros.
 		if (!Util::isEqual(e, 0.0)) {
-			d2 += ((a1 * a2) / e);
-		} else {
-			std::cout << "Skipped a row" << std::endl;
+			return ((a1 * a2) / e);
 		}
-	}
-	return d2;
+		return 0.0;
+	});
 }
 //
 //template<class V>
@@ -994,3 +961,8 @@ void Statistician<V>::calculate(const int *s, int size, double *r) {
 		r[i] = (this->*methodList[s[i]])();
 	}
 }
+
+template<class V>
+double Statistician<V>::calculate(int i) {
+	return (this->*methodList[i])();
+}
@@ -98,7 +98,11 @@ private:
 	const uint64_t *mono2; // Monomer histogram of sequence 2
 	// Array representing a background model for C, T, A and ,G, e.g. n[4] = {0.25, 0.25, 0.25, 0.25}.
 	const double *background;
-	const uint8_t *keyList; // key list in digit format, e.g. getKeysDigitFormat defined in KmerHistogram
+	// The number of characters of the key of a bin: k unless the
+	// histogram is hashed or folded
+	int keyLength;
+	// The bins of a large pair are split into ranges over this many threads
+	const int threadNum;
 
 	double mean1; // Mean of kmer histogram 1
 	double mean2; // Mean of kmer histogram 2
@@ -110,10 +114,115 @@ private:
 	static double (Statistician<V>::*methodList[Stat::ALL_NUM])();
 	const int alphaSize = Parameters::getAlphabetSize();
 
+	/**
+	 * Multiply e by the probability of each character of the key of bin i.
+	 * The characters are the digits of i, the most significant first (see
+	 * KmerHistogram::hash); so no table of keys is needed.
+	 */
+	inline double multiplyByKey(double e, const double *prob, uint64_t i) {
+		if (alphaSize == 4) {
+			for (int s = 2 * (keyLength - 1); s >= 0; s -= 2) {
+				e *= prob[(i >> s) & 3];
+			}
+		} else {
+			uint64_t base = 1;
+			for (int j = 1; j < keyLength; j++) {
+				base *= alphaSize;
+			}
+			for (; base > 0; base /= alphaSize) {
+				e *= prob[(i / base) % alphaSize];
+			}
+		}
+		return e;
+	}
+
+	/**
+	 * Sum f(i) over the bins. If there are more threads than one, each one
+	 * sums a range of the bins, and the partial sums are added.
+	 */
+	template<class T, class F>
+	inline T sweep(F f) {
+		T s = 0;
+		if (threadNum > 1) {
+#pragma omp parallel for schedule(static) reduction(+:s) num_threads(threadNum)
+			for (int i = 0; i < histogramSize; i++) {
+				s += f(i);
+			}
+		} else {
+			for (int i = 0; i < histogramSize; i++) {
+				s += f(i);
+			}
+		}
+		return s;
+	}
+
+	/**
+	 * Two sums in one pass: f(i, s1, s2) adds the terms of bin i to s1 and
+	 * s2. The bins are split as they are by sweep.
+	 */
+	template<class F>
+	inline void sweep(F f, double &s1, double &s2) {
+		double a = 0.0;
+		double b = 0.0;
+		if (threadNum > 1) {
+#pragma omp parallel for schedule(static) reduction(+:a, b) num_threads(threadNum)
+			for (int i = 0; i < histogramSize; i++) {
+				f(i, a, b);
+			}
+		} else {
+			for (int i = 0; i < histogramSize; i++) {
+				f(i, a, b);
+			}
+		}
+		s1 = a;
+		s2 = b;
+	}
+
+	/**
+	 * The maximum of f(i) over the bins, and 0 at least. The bins are split
+	 * as they are by sweep.
+	 */
+	template<class T, class F>
+	inline T sweepMax(F f) {
+		T m = 0;
+		if (threadNum > 1) {
+#pragma omp parallel for schedule(static) reduction(max:m) num_threads(threadNum)
+			for (int i = 0; i < histogramSize; i++) {
+				m = std::max<T>(m, f(i));
+			}
+		} else {
+			for (int i = 0; i < histogramSize; i++) {
+				m = std::max<T>(m, f(i));
+			}
+		}
+		return m;
+	}
+
+	/**
+	 * Call f(i) on each bin; the bins are split as they are by sweep
+	 */
+	template<class F>
+	inline void forEachBin(F f) {
+		if (threadNum > 1) {
+#pragma omp parallel for schedule(static) num_threads(threadNum)
+			for (int i = 0; i < histogramSize; i++) {
+				f(i);
+			}
+		} else {
+			for (int i = 0; i < histogramSize; i++) {
+				f(i);
+			}
+		}
+	}
+
 public:
+	/**
+	 * threadNum: The statistics of a pair of large histograms may be
+	 * calculated by more than one thread.
+	 */
 	Statistician(int histogramSizeIn, int kIn, const V *h1In, const V *h2In,
 			const uint64_t *mono1In, const uint64_t *mono2In,
-			const double *backgroundIn, const uint8_t*);
+			const double *backgroundIn, int threadNumIn = 1);
 	virtual ~Statistician();
 
 	/**
@@ -228,24 +337,25 @@ public:
 	void calculate(std::vector<int>& /*in*/, std::vector<double>& /*out*/);
 	void calculate(const int *s/*method index list*/,
 			int size /*size of method index list*/, double *r /*result list*/);
+	/**
+	 * One statistic by its method index
+	 */
+	double calculate(int);
 
 	/**
 	 * Inline methods/functions
 	 */
 	inline double mean(const V *h) {
-		double m = 0.0;
-		for (int i = 0; i < histogramSize; i++) {
-			m += h[i];
-		}
+		double m = sweep<double>([h](int i) -> double {
+			return h[i];
+		});
 		return m / histogramSize;
 	}
 
 	inline uint64_t sum(const V *h) {
-		uint64_t s = 0;
-		for (int i = 0; i < histogramSize; i++) {
-			s += h[i];
-		}
-		return s;
+		return sweep<uint64_t>([h](int i) -> uint64_t {
+			return h[i];
+		});
 	}
 
 	inline uint64_t sum(const uint64_t *h, int size) {
@@ -257,10 +367,9 @@ public:
 	}
 
 	inline double norm(const V *h) {
-		uint64_t n = 0;
-		for (int i = 0; i < histogramSize; i++) {
-			n += h[i] * h[i];
-		}
+		uint64_t n = sweep<uint64_t>([h](int i) -> uint64_t {
+			return h[i] * h[i];
+		});
 
 		if (n < 0.0) {
 			std::cerr << "Vector norm cannot be negative." << std::endl;
@@ -22,22 +22,24 @@
 #include "SynDataGenerator.h"
 
 SynDataGenerator::SynDataGenerator(string fileName, double t, int threadNumIn,
-		std::vector<int> funIndexList) :
-		DataGenerator(fileName) {
+		std::vector<int> funIndexList, bool canFold) :
+		DataGenerator(fileName, Parameters::getBlockSize(), threadNumIn) {
 	threshold = t;
 	this->funIndexList = funIndexList;
 	threadNum = threadNumIn;
+	foldNum = canFold ? CoarseScorer::findFoldNum(histogramSize) : 0;
 	fillCompositionList();
 	generateData();
 }
 
 SynDataGenerator::SynDataGenerator(string dbName, string qryName, double t,
-		int threadNumIn, std::vector<int> funIndexList) :
-		DataGenerator(dbName, qryName, t) {
+		int threadNumIn, std::vector<int> funIndexList, bool canFold) :
+		DataGenerator(dbName, qryName, t, threadNumIn) {
 
 	threshold = t;
 	this->funIndexList = funIndexList;
 	threadNum = threadNumIn;
+	foldNum = canFold ? CoarseScorer::findFoldNum(histogramSize) : 0;
 	fillCompositionList();
 	generateData();
 }
@@ -51,6 +53,10 @@ SynDataGenerator::~SynDataGenerator() {
 		delete lTable;
 	}
 
+	if (cTable != nullptr) {
+		delete cTable;
+	}
+
 	delete[] compositionList;
 }
 
@@ -61,8 +67,10 @@ SynDataGenerator::~SynDataGenerator() {
 void SynDataGenerator::clearData() {
 	delete fTable;
 	delete lTable;
+	delete cTable;
 	fTable = nullptr;
 	lTable = nullptr;
+	cTable = nullptr;
 }
 
 void SynDataGenerator::fillCompositionList() {
@@ -166,11 +174,8 @@ void SynDataGenerator::generateDataHelper() {
 	}
 
 	// Generate mutated sequences from each sequence
-	KmerHistogram<uint64_t, V> kTable(k);
+	KmerHistogram<uint64_t, V> kTable(k, histogramSize);
 	KmerHistogram<uint64_t, uint64_t> monoTable(1);
-	// uint8_t keyList[histogramSize * k];
-	uint8_t *keyList = new uint8_t[histogramSize * k]; // Will be deleted at the end of this method
-	kTable.getKeysDigitFormat(keyList);
 	const int statNum =
 			funIndexList.empty() ?
 					StatisticInfo::getInstance()->getStatNum() :
@@ -181,6 +186,13 @@ void SynDataGenerator::generateDataHelper() {
 	fTable = new Matrix(rowNum, statNum);
 	lTable = new Matrix(rowNum, 1);
 
+	// The folded histograms
+	int coarseK = k - foldNum;
+	int coarseSize = histogramSize / std::pow(4, foldNum);
+	if (foldNum > 0) {
+		cTable = new Matrix(rowNum, statNum);
+	}
+
 	if (!canGenerateNegatives) {
 		copyNum *= 2;
 	}
@@ -196,7 +208,9 @@ void SynDataGenerator::generateDataHelper() {
 #pragma omp parallel for schedule(static) num_threads(threadNum)
 	for (int i = 0; i < actual; i++) {
 		// Set up a mutator
-		Mutator mutator(block->at(i).second, maxBlockSize, i, minBlockSize);
+		auto &record = block->at(i);
+		Mutator mutator(record.second, maxBlockSize, i, minBlockSize,
+				&record.segmentList);
 		if (isSingle) {
 			mutator.enableSinglePoint();
 		}
@@ -210,8 +224,21 @@ void SynDataGenerator::generateDataHelper() {
 			mutator.enableInverstion();
 		}
 
-		V *h1 = kTable.build(block->at(i).second);
-		uint64_t *mono1 = monoTable.build(block->at(i).second);
+		V *h1 = kTable.build(record.second, record.segmentList);
+		uint64_t *mono1 = monoTable.build(record.second, record.segmentList);
+
+		// Reused by all mutated copies of this sequence
+		string mSequence;
+		SegmentList mSegmentList;
+		V *h2 = new V[histogramSize];
+		uint64_t *mono2 = new uint64_t[monoTable.getMaxTableSize()];
+		V *c1 = nullptr;
+		V *c2 = nullptr;
+		if (foldNum > 0) {
+			c1 = new V[coarseSize];
+			c2 = new V[coarseSize];
+			kTable.fold(h1, foldNum, c1);
+		}
 
 		// Iterate over different mutation rates
 		// Balance around threshold
@@ -222,58 +249,65 @@ void SynDataGenerator::generateDataHelper() {
 			//			if (i % 2500 == 0) {
 			//				mutRate = 0.0;
 			//			}
-			auto pPstv = mutator.mutateSequence(mutRate);
-			V *h2 = kTable.build(pPstv.first);
-			uint64_t *mono2 = monoTable.build(pPstv.first);
-
-			Statistician<V> s(histogramSize, k, h1, h2, mono1, mono2,
-					compositionList, keyList);
-			vector<double> statList;
-			statList.reserve(statNum);
-			if (funIndexList.empty()) {
-				s.calculateAll(statList);
-			} else {
-				s.calculate(funIndexList, statList);
-			}
+			double identity = mutator.mutateSequence(mutRate, mSequence);
+			mSegmentList.clear();
+			Util::findSegments(&mSequence, mSegmentList);
+			kTable.build(&mSequence, mSegmentList, h2);
+			monoTable.build(&mSequence, mSegmentList, mono2);
+
 			int r = canGenerateNegatives ?
 					2 * i * copyNum + j : i * copyNum + j;
-
-			fTable->setRow(r, statList);
-			lTable->at(r, 0) = pPstv.second;
-
-			delete pPstv.first;
-			delete[] h2;
-			delete[] mono2;
+			fillRow(fTable, r, histogramSize, k, h1, h2, mono1, mono2);
+			if (foldNum > 0) {
+				kTable.fold(h2, foldNum, c2);
+				fillRow(cTable, r, coarseSize, coarseK, c1, c2, mono1, mono2);
+			}
+			lTable->at(r, 0) = identity;
 		}
 		// Generate negative examples (identity score below the threshold)
 		if (canGenerateNegatives) {
 			for (int j = 0; j < copyNum; j++) {
-				auto pNgtv = mutator.mutateSequence(
-						ngtvRateList[(i * copyNum + j) % ngtvRateSize]);
-				V *h2 = kTable.build(pNgtv.first);
-				uint64_t *mono2 = monoTable.build(pNgtv.first);
-
-				Statistician<V> s(histogramSize, k, h1, h2, mono1, mono2,
-						compositionList, keyList);
-				vector<double> statList;
-				statList.reserve(statNum);
-				if (funIndexList.empty()) {
-					s.calculateAll(statList);
-				} else {
-					s.calculate(funIndexList, statList);
-				}
-				int r = 2 * i * copyNum + j + copyNum;
-				fTable->setRow(r, statList);
-				lTable->at(r, 0) = pNgtv.second;
+				double identity = mutator.mutateSequence(
+						ngtvRateList[(i * copyNum + j) % ngtvRateSize],
+						mSequence);
+				mSegmentList.clear();
+				Util::findSegments(&mSequence, mSegmentList);
+				kTable.build(&mSequence, mSegmentList, h2);
+				monoTable.build(&mSequence, mSegmentList, mono2);
 
-				delete pNgtv.first;
-				delete[] h2;
-				delete[] mono2;
+				int r = 2 * i * copyNum + j + copyNum;
+				fillRow(fTable, r, histogramSize, k, h1, h2, mono1, mono2);
+				if (foldNum > 0) {
+					kTable.fold(h2, foldNum, c2);
+					fillRow(cTable, r, coarseSize, coarseK, c1, c2, mono1,
+							mono2);
+				}
+				lTable->at(r, 0) = identity;
 			}
 		}
 
 		delete[] h1;
 		delete[] mono1;
+		delete[] h2;
+		delete[] mono2;
+		delete[] c1;
+		delete[] c2;
+	}
+}
+
+/**
+ * Calculate the statistics of a pair of histograms into a row of a table
+ */
+template<class V>
+void SynDataGenerator::fillRow(Matrix *table, int r, int size, int kmer,
+		V *h1, V *h2, uint64_t *mono1, uint64_t *mono2) {
+	Statistician<V> s(size, kmer, h1, h2, mono1, mono2, compositionList);
+	vector<double> statList;
+	statList.reserve(table->getNumCol());
+	if (funIndexList.empty()) {
+		s.calculateAll(statList);
+	} else {
+		s.calculate(funIndexList, statList);
 	}
-	delete[] keyList;
+	table->setRow(r, statList);
 }
@@ -29,6 +29,7 @@
 #include "Mutator.h"
 #include "DataGenerator.h"
 #include "StatisticInfo.h"
+#include "CoarseScorer.h"
 
 class SynDataGenerator: public DataGenerator {
 private:
@@ -38,13 +39,20 @@ private:
 
 	template<class V>
 	void generateDataHelper();
+	template<class V>
+	void fillRow(Matrix*, int, int, int, V*, V*, uint64_t*, uint64_t*);
 	void fillCompositionList();
 
 public:
+	/**
+	 * canFold: Calculate the statistics of the folded histograms too
+	 * (see CoarseScorer)
+	 */
 	SynDataGenerator(std::string, double, int, std::vector<int> funIndexList =
-			std::vector<int>());
+			std::vector<int>(), bool canFold = false);
 	SynDataGenerator(std::string, std::string, double, int,
-			std::vector<int> funIndexList = std::vector<int>());
+			std::vector<int> funIndexList = std::vector<int>(), bool canFold =
+					false);
 	virtual ~SynDataGenerator();
 	virtual void generateData();
 	virtual void clearData();
@@ -0,0 +1,268 @@
+/*
+ Identity 2.0 calculates DNA sequence identity scores rapidly without alignment.
+
+ Copyright (C) 2020-2022 Hani Z. Girgis, PhD
+
+ Academic use: Affero General Public License version 1.
+
+ Any restrictions to use for-profit or non-academics: Alternative commercial license is needed.
+
+ This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+ Please contact Dr. Hani Z. Girgis (hzgirgis@buffalo.edu) if you need more information.
+ */
+
+/*
+ * ThreadTuner.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Hani Z. Girgis, PhD
+ */
+
+#include "ThreadTuner.h"
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <set>
+#include <cmath>
+#include <thread>
+#include <algorithm>
+#include <sched.h>
+
+ThreadTuner::ThreadTuner(std::vector<int> candidateListIn, int trialNumIn) {
+	// Remove invalid and repeated candidates but keep the order
+	for (int c : candidateListIn) {
+		if (c > 0
+				&& std::find(candidateList.begin(), candidateList.end(), c)
+						== candidateList.end()) {
+			candidateList.push_back(c);
+		}
+	}
+
+	if (candidateList.empty()) {
+		std::cerr << "ThreadTuner error: No valid thread number is provided.";
+		std::cerr << std::endl;
+		throw std::exception();
+	}
+
+	trialNum = trialNumIn < 1 ? 1 : trialNumIn;
+	rateList = std::vector<double>(candidateList.size(), 0.0);
+	countList = std::vector<int>(candidateList.size(), 0);
+	current = 0;
+	isSettled = candidateList.size() == 1;
+}
+
+ThreadTuner::~ThreadTuner() {
+}
+
+int ThreadTuner::next() const {
+	return candidateList[current];
+}
+
+void ThreadTuner::start() {
+	startTime = std::chrono::steady_clock::now();
+}
+
+void ThreadTuner::stop(uint64_t pairNum) {
+	if (isSettled) {
+		return;
+	}
+
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now()
+			- startTime;
+	double seconds = elapsed.count();
+	// Too short to be measured reliably
+	if (seconds <= 0.0 || pairNum == 0) {
+		return;
+	}
+
+	double rate = pairNum / seconds;
+	if (rate > rateList[current]) {
+		rateList[current] = rate;
+	}
+	countList[current]++;
+
+	if (countList[current] >= trialNum) {
+		current++;
+		if (current == (int) candidateList.size()) {
+			settle();
+		}
+	}
+}
+
+void ThreadTuner::settle() {
+	int size = candidateList.size();
+	int best = 0;
+	for (int i = 1; i < size; i++) {
+		if (rateList[i] > rateList[best]) {
+			best = i;
+		}
+	}
+	current = best;
+	isSettled = true;
+
+	std::cout << "Threads for aligning: " << candidateList[best] << " (";
+	for (int i = 0; i < size; i++) {
+		std::cout << candidateList[i] << ": " << std::round(rateList[i])
+				<< (i + 1 < size ? ", " : "");
+	}
+	std::cout << " pairs/second)" << std::endl;
+}
+
+bool ThreadTuner::getIsSettled() const {
+	return isSettled;
+}
+
+/**
+ * The parent of a cgroup path, e.g. /a for /a/b; the root is its own parent
+ */
+static std::string findParent(const std::string &path) {
+	size_t i = path.find_last_of('/');
+	return i == std::string::npos || i == 0 ? "/" : path.substr(0, i);
+}
+
+/**
+ * Reads the CPU quota of the cgroup, e.g. 2.5 CPUs. A quota set on an
+ * ancestor limits the process too; so the hierarchy is walked up to the
+ * root, and the smallest quota is returned.
+ * Returns a non-positive number if there is no quota.
+ */
+static double readCgroupQuota() {
+	// Find the cgroup paths of this process: the cgroup v2 line starts with
+	// 0::, a cgroup v1 line lists the cpu controller, e.g. 4:cpu,cpuacct:/a
+	std::string path("");
+	std::string v1Path("");
+	bool isV2 = false;
+	std::ifstream self("/proc/self/cgroup");
+	std::string line;
+	while (std::getline(self, line)) {
+		if (line.rfind("0::", 0) == 0) {
+			path = line.substr(3);
+			isV2 = true;
+		} else {
+			size_t first = line.find(':');
+			size_t second = line.find(':', first + 1);
+			if (first != std::string::npos && second != std::string::npos) {
+				std::string controllerList = "," + line.substr(first + 1,
+						second - first - 1) + ",";
+				if (controllerList.find(",cpu,") != std::string::npos) {
+					v1Path = line.substr(second + 1);
+				}
+			}
+		}
+	}
+
+	double smallest = -1.0;
+	auto keep = [&smallest](double quota) {
+		if (quota > 0.0 && (smallest <= 0.0 || quota < smallest)) {
+			smallest = quota;
+		}
+	};
+
+	// cgroup v2: "max 100000" or "200000 100000"
+	if (isV2) {
+		for (std::string p = path;; p = findParent(p)) {
+			std::ifstream in("/sys/fs/cgroup" + (p == "/" ? "" : p)
+					+ "/cpu.max");
+			std::string quota;
+			double period = 0.0;
+			if ((in >> quota >> period) && quota != "max" && period > 0.0) {
+				keep(std::stod(quota) / period);
+			}
+			if (p == "/" || p.empty()) {
+				break;
+			}
+		}
+		if (smallest > 0.0) {
+			return smallest;
+		}
+	}
+
+	// cgroup v1
+	std::vector<std::string> v1List { "/sys/fs/cgroup/cpu",
+			"/sys/fs/cgroup/cpu,cpuacct" };
+	for (auto &dir : v1List) {
+		for (std::string p = v1Path.empty() ? "/" : v1Path;; p = findParent(
+				p)) {
+			std::string d = dir + (p == "/" ? "" : p);
+			std::ifstream qIn(d + "/cpu.cfs_quota_us");
+			std::ifstream pIn(d + "/cpu.cfs_period_us");
+			double quota = 0.0;
+			double period = 0.0;
+			if ((qIn >> quota) && (pIn >> period) && period > 0.0) {
+				keep(quota / period);
+			}
+			if (p == "/") {
+				break;
+			}
+		}
+		if (smallest > 0.0) {
+			return smallest;
+		}
+	}
+
+	return smallest;
+}
+
+int ThreadTuner::countAvailableCores() {
+	int n = 0;
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+		n = CPU_COUNT(&set);
+	}
+	if (n <= 0) {
+		n = std::thread::hardware_concurrency();
+	}
+
+	double quota = readCgroupQuota();
+	if (quota > 0.0) {
+		int q = std::ceil(quota);
+		if (q < n) {
+			n = q;
+		}
+	}
+
+	return n < 1 ? 1 : n;
+}
+
+int ThreadTuner::countPhysicalCores() {
+	int available = countAvailableCores();
+
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	if (sched_getaffinity(0, sizeof(set), &set) != 0) {
+		return available;
+	}
+
+	std::set<std::pair<int, int>> coreSet;
+	for (int c = 0; c < CPU_SETSIZE; c++) {
+		if (!CPU_ISSET(c, &set)) {
+			continue;
+		}
+		std::string dir = "/sys/devices/system/cpu/cpu" + std::to_string(c)
+				+ "/topology/";
+		std::ifstream packageIn(dir + "physical_package_id");
+		std::ifstream coreIn(dir + "core_id");
+		int package = -1;
+		int core = -1;
+		if (!(packageIn >> package) || !(coreIn >> core)) {
+			// Topology is unknown, e.g. restricted /sys
+			return available;
+		}
+		coreSet.insert(std::make_pair(package, core));
+	}
+
+	int n = coreSet.size();
+	if (n < 1 || n > available) {
+		n = available;
+	}
+	return n;
+}
+
+int ThreadTuner::findInnerThreadNum(int64_t unitNum, int64_t unitSize,
+		int64_t minSize, int threadNum) {
+	return unitNum < threadNum && unitSize >= minSize ? threadNum : 1;
+}
@@ -0,0 +1,96 @@
+/*
+ Identity 2.0 calculates DNA sequence identity scores rapidly without alignment.
+
+ Copyright (C) 2020-2022 Hani Z. Girgis, PhD
+
+ Academic use: Affero General Public License version 1.
+
+ Any restrictions to use for-profit or non-academics: Alternative commercial license is needed.
+
+ This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+ Please contact Dr. Hani Z. Girgis (hzgirgis@buffalo.edu) if you need more information.
+ */
+
+/*
+ * ThreadTuner.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Hani Z. Girgis, PhD
+ *     Purpose: Detects the CPUs available to the process and selects the
+ *     number of aligner threads by measuring throughput (pairs per second)
+ *     on the first blocks.
+ */
+
+#ifndef SRC_THREADTUNER_H_
+#define SRC_THREADTUNER_H_
+
+#include <vector>
+#include <chrono>
+#include <cstdint>
+
+class ThreadTuner {
+private:
+	// Thread numbers to try; the first one is the default guess
+	std::vector<int> candidateList;
+	// Best pairs per second observed for each candidate
+	std::vector<double> rateList;
+	// Number of measurements recorded for each candidate
+	std::vector<int> countList;
+	// Number of measurements required per candidate
+	int trialNum;
+	// Index of the candidate being measured
+	int current;
+	bool isSettled;
+	std::chrono::steady_clock::time_point startTime;
+
+	void settle();
+
+public:
+	// A pair of histograms of this many bins at least, or a sequence of
+	// this many characters at least, is large enough to be split over the
+	// threads
+	static const int SPLIT_BIN_NUM = 1 << 18;
+	static const int SPLIT_LENGTH = 1 << 20;
+
+	ThreadTuner(std::vector<int>, int trialNum = 1);
+	virtual ~ThreadTuner();
+
+	/**
+	 * The number of threads to be used next.
+	 * This is the best candidate once tuning is settled.
+	 */
+	int next() const;
+
+	/**
+	 * Start and stop measuring one unit of work done with next() threads.
+	 */
+	void start();
+	void stop(uint64_t pairNum);
+
+	bool getIsSettled() const;
+
+	/**
+	 * Logical CPUs the process may run on, taking the affinity mask and
+	 * the cgroup (v1 or v2) CPU quota into account.
+	 */
+	static int countAvailableCores();
+
+	/**
+	 * Physical cores among the available logical CPUs (hyperthreads sharing
+	 * a core are counted once).
+	 */
+	static int countPhysicalCores();
+
+	/**
+	 * The number of threads working on one unit, e.g. a pair or a sequence.
+	 * Units are processed in parallel, one per thread, unless they are
+	 * fewer than the threads and each one is as large as the minimum size;
+	 * then they are processed one after another, each by all threads.
+	 */
+	static int findInnerThreadNum(int64_t unitNum, int64_t unitSize,
+			int64_t minSize, int threadNum);
+};
+
+#endif /* SRC_THREADTUNER_H_ */
@@ -0,0 +1,87 @@
+/*
+ Identity 2.0 calculates DNA sequence identity scores rapidly without alignment.
+
+ Copyright (C) 2020-2022 Hani Z. Girgis, PhD
+
+ Academic use: Affero General Public License version 1.
+
+ Any restrictions to use for-profit or non-academics: Alternative commercial license is needed.
+
+ This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+ Please contact Dr. Hani Z. Girgis (hzgirgis@buffalo.edu) if you need more information.
+ */
+
+
+/*
+ * TopHits.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Hani Z. Girgis, PhD
+ */
+
+#include "TopHits.h"
+
+#include <algorithm>
+
+/**
+ * True if the first hit is better than the second one
+ */
+static bool isBetter(const Hit &a, const Hit &b) {
+	return a.score > b.score || (a.score == b.score && a.id < b.id);
+}
+
+TopHits::TopHits(int kIn, int queryNum) {
+	k = kIn;
+	heapList.resize(queryNum);
+}
+
+TopHits::~TopHits() {
+}
+
+double TopHits::getBound(int q) const {
+	const std::vector<Hit> &heap = heapList[q];
+	return (int) heap.size() < k ? -1.0 : heap.front().score;
+}
+
+/**
+ * The front of the heap is the worst hit
+ */
+void TopHits::push(std::vector<Hit> &heap, const Hit &hit) {
+	if ((int) heap.size() < k) {
+		heap.push_back(hit);
+		std::push_heap(heap.begin(), heap.end(), isBetter);
+	} else if (isBetter(hit, heap.front())) {
+		std::pop_heap(heap.begin(), heap.end(), isBetter);
+		heap.back() = hit;
+		std::push_heap(heap.begin(), heap.end(), isBetter);
+	}
+}
+
+void TopHits::add(int q, double score, uint32_t id, const std::string &info) {
+	std::vector<Hit> &heap = heapList[q];
+	if ((int) heap.size() < k || score >= heap.front().score) {
+		push(heap, Hit { score, id, info });
+	}
+}
+
+void TopHits::merge(const TopHits &other) {
+	for (size_t q = 0; q < heapList.size(); q++) {
+		for (const Hit &hit : other.heapList[q]) {
+			push(heapList[q], hit);
+		}
+	}
+}
+
+void TopHits::write(PairWriter &writer, const Block &block) {
+	for (size_t q = 0; q < heapList.size(); q++) {
+		std::vector<Hit> &heap = heapList[q];
+		std::sort(heap.begin(), heap.end(), isBetter);
+		for (const Hit &hit : heap) {
+			writer.write(*block[q].first, block[q].id, hit.info, hit.id,
+					hit.score);
+		}
+		heap.clear();
+	}
+}
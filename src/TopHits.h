@@ -0,0 +1,79 @@
+/*
+ Identity 2.0 calculates DNA sequence identity scores rapidly without alignment.
+
+ Copyright (C) 2020-2022 Hani Z. Girgis, PhD
+
+ Academic use: Affero General Public License version 1.
+
+ Any restrictions to use for-profit or non-academics: Alternative commercial license is needed.
+
+ This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+ Please contact Dr. Hani Z. Girgis (hzgirgis@buffalo.edu) if you need more information.
+ */
+
+
+/*
+ * TopHits.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Hani Z. Girgis, PhD
+ *     Purpose: Keeps the K best database hits of each query in a block of
+ *     queries. Each query has a bounded min-heap; its top is the K-th best
+ *     hit, whose score is the bound a new hit must reach. An aligner thread
+ *     owns one instance; the instances are merged when the block is done.
+ *     Equal scores are ordered by the database id; so the result does not
+ *     depend on how database blocks are distributed among threads.
+ */
+
+#ifndef SRC_TOPHITS_H_
+#define SRC_TOPHITS_H_
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "PairWriter.h"
+#include "FastaReader.h"
+
+struct Hit {
+	double score;
+	uint32_t id;
+	std::string info;
+};
+
+class TopHits {
+private:
+	int k;
+	std::vector<std::vector<Hit> > heapList;
+
+	void push(std::vector<Hit>&, const Hit&);
+
+public:
+	TopHits(int, int);
+	virtual ~TopHits();
+
+	/**
+	 * The minimum score a new hit of a query needs, or -1 if the query
+	 * has fewer than K hits
+	 */
+	double getBound(int) const;
+
+	/**
+	 * Add a hit of a query; it is kept if it is among the best K so far
+	 */
+	void add(int, double, uint32_t, const std::string&);
+
+	/**
+	 * Add the hits of another instance built on the same queries
+	 */
+	void merge(const TopHits&);
+
+	/**
+	 * Write the hits of each query of the block (best first)
+	 */
+	void write(PairWriter&, const Block&);
+};
+
+#endif /* SRC_TOPHITS_H_ */
@@ -28,8 +28,14 @@
 #include <fstream>
 #include <vector>
 #include <algorithm>
+#include <string>
+#include <utility>
 #include "Parameters.h"
 
+// Valid segments, which do not include N or X, of a sequence.
+// Segment coordinates are inclusive [s,e].
+typedef std::vector<std::pair<int, int> > SegmentList;
+
 class Util {
 public:
 	static inline bool isEqual(double d1, double d2) {
@@ -40,18 +46,6 @@ public:
 		return r;
 	}
 
-	static inline uint8_t* makeKeyList(int histSize, int k) {
-		uint8_t *keyList = new uint8_t[histSize * k];
-		int alphaSize = Parameters::getAlphabetSize();
-		for (int c = k - 1; c >= 0; c--) {
-			for (int r = 0; r < histSize; r++) {
-				keyList[(r * k) + k - 1 - c] = (r
-						/ ((uint64_t) pow(alphaSize, c))) % alphaSize;
-			}
-		}
-		return keyList;
-	}
-
 	static inline bool doesFileExist(std::string fileName) {
 		std::ifstream in(fileName);
 		bool r = false;
@@ -85,6 +79,29 @@ public:
 		return sqrt(sum / v.size());
 	}
 
+	/**
+	 * Find the maximal runs of symbols other than the unknown one
+	 */
+	static inline void findSegments(const std::string *sequence,
+			SegmentList &segmentList) {
+		char unknown = Parameters::getUnknown();
+		const char *array = sequence->c_str();
+		int len = sequence->size();
+		int start = -1;
+		for (int i = 0; i < len; i++) {
+			bool isUnknown = array[i] == unknown;
+			if (!isUnknown && start == -1) {
+				start = i;
+			} else if (isUnknown && start != -1) {
+				segmentList.push_back(std::make_pair(start, i - 1));
+				start = -1;
+			}
+		}
+		if (start != -1) {
+			segmentList.push_back(std::make_pair(start, len - 1));
+		}
+	}
+
 	template<class V>
 	static bool isAllZeros(V *hist, int histSize) {
 		bool r = true;
@@ -23,28 +23,25 @@
 
 ClusterInfo::ClusterInfo(int id) {
 	memberList = new std::vector<info>();
-	repInfo = nullptr;
+	repInfo = 0;
 	repId = 0.0;
 	repIndex = 0;
 	identifier = id;
 }
 
 ClusterInfo::~ClusterInfo() {
-	for (auto p : *memberList) {
-		delete p.headerPtr;
-	}
 	delete memberList;
 }
 
 /*
- * member: the info of a sequence assigned to this cluster
+ * member: the id of a sequence assigned to this cluster
  * idC: the identity score of the member with the mean of the cluster
  * idN: the identity score of the member with the mean of the closest cluster
  * membership: member (M), extended (E), outside (O)
  */
-void ClusterInfo::addMember(std::string *memberInfo, double idC, double idN,
+void ClusterInfo::addMember(uint32_t memberInfo, double idC, double idN,
 		int membership) {
-	memberList->push_back( { memberInfo, idC, idN, membership });
+	memberList->push_back( { idC, idN, memberInfo, membership });
 	if (idC > repId) {
 		repId = idC;
 		repInfo = memberInfo;
@@ -74,17 +71,17 @@ void ClusterInfo::updateScoreWithNeighbor(double *list, int size) {
 	}
 }
 
-std::vector<std::string*> ClusterInfo::getMemberList() {
+std::vector<uint32_t> ClusterInfo::getMemberList() {
 	int size = memberList->size();
-	std::vector<std::string*> v(size, nullptr);
+	std::vector<uint32_t> v(size, 0);
 	for (int i = 0; i < size; i++) {
-		v[i] = memberList->at(i).headerPtr;
+		v[i] = memberList->at(i).id;
 	}
 	return v;
 }
 
-std::string* ClusterInfo::getCenter() {
-	return memberList->at(repIndex).headerPtr;
+uint32_t ClusterInfo::getCenter() {
+	return memberList->at(repIndex).id;
 }
 
 int ClusterInfo::getRepIndex() {
@@ -96,7 +93,10 @@ int ClusterInfo::getRepIndex() {
 	return repIndex;
 }
 
-std::string ClusterInfo::toString() {
+/**
+ * Headers are resolved by the ids of the members
+ */
+std::string ClusterInfo::toString(const HeaderArena &headers) {
 	std::ostringstream os;
 	int l = memberList->size();
 	for (int j = 0; j < l; j++) {
@@ -104,7 +104,7 @@ std::string ClusterInfo::toString() {
 		char rounded[7];
 		sprintf(rounded, "%.4f", p.scoreWithCenter);
 
-		os << identifier << "\t" << *p.headerPtr << "\t"
+		os << identifier << "\t" << headers.get(p.id) << "\t"
 				<< std::string(rounded);
 		if (j == repIndex) {
 			// This is the center
@@ -27,11 +27,13 @@
 #include <iostream>
 
 #include "ClusteringUtil.h"
+#include "../HeaderArena.h"
 
+// The header is referred to by the id of the sequence
 typedef struct {
-	std::string *headerPtr;
 	double scoreWithCenter;
 	double scoreWithNeighbor;
+	uint32_t id;
 	int membership;
 } info;
 
@@ -39,7 +41,7 @@ class ClusterInfo {
 private:
 	// Member list
 	std::vector<info> *memberList;
-	std::string *repInfo;
+	uint32_t repInfo;
 	double repId; // Identity score of the representative center with the mean
 	int repIndex;
 	int identifier;
@@ -47,18 +49,18 @@ private:
 public:
 	ClusterInfo(int id = 0);
 	virtual ~ClusterInfo();
-	void addMember(std::string*, double, double idN, int membership);
+	void addMember(uint32_t, double, double idN, int membership);
 	void updateScoreWithCenter(double*, int);
 	void updateScoreWithNeighbor(double*, int);
 	int getRepIndex();
-	std::string toString();
+	std::string toString(const HeaderArena&);
 
 	int getSize();
 	double silhoutte();
 	double intra();
 	double daviesBouldin();
-	std::vector<std::string*> getMemberList();
-	std::string* getCenter();
+	std::vector<uint32_t> getMemberList();
+	uint32_t getCenter();
 	void setIdentifier(int);
 	int getIdentifier();
 };
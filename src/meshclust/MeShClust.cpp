@@ -28,9 +28,11 @@
 #include "MeanShiftLarge.h"
 #include "../Util.h"
 #include "../FastaReader.h"
+#include "../FastaIndex.h"
 #include "../IdentityCalculator.h"
 #include "../IdentityCalculator1.h"
 #include "../Parameters.h"
+#include "../ThreadTuner.h"
 
 const char *agplv1 =
 		R"(AFFERO GENERAL PUBLIC LICENSE
@@ -110,35 +112,6 @@ TERMS AND CONDITIONS FOR COPYING, DISTRIBUTION AND MODIFICATION
     11. BECAUSE THE PROGRAM IS LICENSED FREE OF CHARGE, THERE IS NO WARRANTY FOR THE PROGRAM, TO THE EXTENT PERMITTED BY APPLICABLE LAW. EXCEPT WHEN OTHERWISE STATED IN WRITING THE COPYRIGHT HOLDERS AND/OR OTHER PARTIES PROVIDE THE PROGRAM "AS IS" WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. THE ENTIRE RISK AS TO THE QUALITY AND PERFORMANCE OF THE PROGRAM IS WITH YOU. SHOULD THE PROGRAM PROVE DEFECTIVE, YOU ASSUME THE COST OF ALL NECESSARY SERVICING, REPAIR OR CORRECTION.
     12. IN NO EVENT UNLESS REQUIRED BY APPLICABLE LAW OR AGREED TO IN WRITING WILL ANY COPYRIGHT HOLDER, OR ANY OTHER PARTY WHO MAY MODIFY AND/OR REDISTRIBUTE THE PROGRAM AS PERMITTED ABOVE, BE LIABLE TO YOU FOR DAMAGES, INCLUDING ANY GENERAL, SPECIAL, INCIDENTAL OR CONSEQUENTIAL DAMAGES ARISING OUT OF THE USE OR INABILITY TO USE THE PROGRAM (INCLUDING BUT NOT LIMITED TO LOSS OF DATA OR DATA BEING RENDERED INACCURATE OR LOSSES SUSTAINED BY YOU OR THIRD PARTIES OR A FAILURE OF THE PROGRAM TO OPERATE WITH ANY OTHER PROGRAMS), EVEN IF SUCH HOLDER OR OTHER PARTY HAS BEEN ADVISED OF THE POSSIBILITY OF SUCH DAMAGES.)";
 
-// https://stackoverflow.com/questions/13808714/accessing-individual-characters-in-a-file-inefficient-c
-unsigned int countSequences(string fileName) {
-
-	FILE *infile = fopen(fileName.c_str(), "r");
-
-	char buffer[4096 * 1024];
-	int size;
-	unsigned int count = 0;
-
-	int first = 0;
-	int second = 1;
-
-	for (int i = 0; i < size; i++) {
-		if (buffer[i] == '>') {
-			++count;
-		}
-	}
-
-	while (0 < (size = fread(buffer, 1, sizeof(buffer), infile))) {
-		for (int i = 0; i < size; i++)
-			if (buffer[i] == '>')
-				++count;
-	}
-
-	fclose(infile);
-
-	return count;
-}
-
 double twoMeansAndDeviations(vector<double> &l, vector<double> &r, double f) {
 	// Precondition
 	if (r.size() != 4) {
@@ -294,7 +267,7 @@ vector<double> guessBandwidthOneTime(Block *block, int cores,
 	auto tup = identity.unpackBlock(block, cores);
 	V **kHistList = std::get<0>(tup);
 	uint64_t **monoHistList = std::get<1>(tup);
-	std::string **infoList = std::get<2>(tup);
+	uint32_t *idList = std::get<2>(tup);
 	int *lenList = std::get<3>(tup);
 
 	Matrix a = identity.score(kHistList, monoHistList, size, cores, lenList);
@@ -337,7 +310,8 @@ vector<double> guessBandwidthOneTime(Block *block, int cores,
 template<class V>
 double guessBandwidthHelper(string dbFile, int cores, DataGenerator *g) {
 	// Count sequences
-	unsigned int seqCount = countSequences(dbFile);
+	FastaIndex index(dbFile, cores);
+	uint64_t seqCount = index.getCount();
 
 	double ratio = (double) Parameters::getMsBandwidthBlock() / seqCount;
 	double sigmas = 0.0; // < 5%
@@ -360,6 +334,7 @@ double guessBandwidthHelper(string dbFile, int cores, DataGenerator *g) {
 	vector<double> guessList;
 
 	FastaReader reader(dbFile, Parameters::getMsBandwidthBlock());
+	reader.setThreadNum(cores);
 
 	if (ratio < 1.0) {
 		for (int i = 0;
@@ -546,8 +521,9 @@ int main(int argc, char *argv[]) {
 	if (argc == 1 || (argc == 2 && argv[1][1] == 'h')) {
 		std::cout << "List of parameters:" << std::endl;
 		// Required parameters
-		std::cout << "\t-d: Required. Database file in FASTA format."
+		std::cout << "\t-d: Required. Database file in FASTA or FASTQ format. It may be"
 				<< std::endl;
+		std::cout << "\t    compressed by gzip or bgzip." << std::endl;
 		std::cout
 				<< "\t-o: Required. Output file. Each line has 3 tab-separated fields (>header1    >header2    score)."
 				<< std::endl;
@@ -580,7 +556,10 @@ int main(int argc, char *argv[]) {
 				<< "\t    which supports 2 hyperthreads. Set this parameter to 4 if you are using the search mode or"
 				<< std::endl;
 		std::cout
-				<< "\t    to 8 if you are using the all-versus-all mode. By default, all hyperthreads are used."
+				<< "\t    to 8 if you are using the all-versus-all mode. By default, all hyperthreads available to"
+				<< std::endl;
+		std::cout
+				<< "\t    the program are used (container CPU quotas are respected)."
 				<< std::endl;
 
 		std::cout
@@ -697,7 +676,7 @@ int main(int argc, char *argv[]) {
 	char evaluate = 'n';
 	char license = 'n';
 	char all = 'n';
-	int cores = std::thread::hardware_concurrency();
+	int cores = ThreadTuner::countAvailableCores();
 	double threshold = 0.0;
 	bool isThresholdProvided = false;
 	int blockSize = 0;
@@ -22,13 +22,13 @@
 
 template<class V>
 MeanShift<V>::MeanShift(
-		std::tuple<V**, uint64_t**, std::string**, int*, int> tup,
+		std::tuple<V**, uint64_t**, uint32_t*, int*, int> tup,
 		IdentityCalculator<V> &id, int t, double th) :
 		identity(id), threadNum(t), threshold(th) {
 
 	kHistList = std::get < 0 > (tup);
 	monoHistList = std::get < 1 > (tup);
-	infoList = std::get < 2 > (tup);
+	idList = std::get < 2 > (tup);
 	lenList = std::get < 3 > (tup);
 	size = std::get < 4 > (tup);
 	isDataCleared = false;
@@ -47,12 +47,12 @@ MeanShift<V>::MeanShift(Block *block, IdentityCalculator<V> &id, int t,
 template<class V>
 void MeanShift<V>::clearData() {
 	identity.freeBlock(
-			std::make_tuple(kHistList, monoHistList, infoList, lenList), size,
+			std::make_tuple(kHistList, monoHistList, idList, lenList), size,
 			threadNum);
 
 	kHistList = nullptr;
 	monoHistList = nullptr;
-	infoList = nullptr;
+	idList = nullptr;
 	lenList = nullptr;
 
 	isDataCleared = true;
@@ -64,7 +64,7 @@ MeanShift<V>::~MeanShift() {
 		clearData();
 	}
 
-	if (kHistList != nullptr || monoHistList != nullptr || infoList != nullptr
+	if (kHistList != nullptr || monoHistList != nullptr || idList != nullptr
 			|| lenList != nullptr) {
 		cerr << "~MeanShift(): Data is not cleared!" << endl;
 	}
@@ -87,7 +87,7 @@ void MeanShift<V>::initData(Block *block) {
 	auto tup = identity.unpackBlock(block, threadNum);
 	kHistList = std::get < 0 > (tup);
 	monoHistList = std::get < 1 > (tup);
-	infoList = std::get < 2 > (tup);
+	idList = std::get < 2 > (tup);
 	lenList = std::get < 3 > (tup);
 
 	isDataCleared = false;
@@ -527,7 +527,7 @@ void MeanShift<V>::removeEmpty() {
  *
  */
 template<class V>
-std::tuple<V**, uint64_t**, std::string**, int*, int> MeanShift<V>::findUnassignedData() {
+std::tuple<V**, uint64_t**, uint32_t*, int*, int> MeanShift<V>::findUnassignedData() {
 	if (assignList == nullptr) {
 		std::cerr << "The assignment list is null. ";
 		std::cerr << "Please run the mean shift first." << std::endl;
@@ -550,7 +550,7 @@ std::tuple<V**, uint64_t**, std::string**, int*, int> MeanShift<V>::findUnassign
 
 	V **kHistListU = new V*[unassignedCount];
 	uint64_t **monoHistListU = new uint64_t*[unassignedCount];
-	std::string **infoListU = new std::string*[unassignedCount];
+	uint32_t *idListU = new uint32_t[unassignedCount];
 	int *lenListU = new int[unassignedCount];
 
 #pragma omp parallel for schedule(static) num_threads(threadNum)
@@ -567,12 +567,12 @@ std::tuple<V**, uint64_t**, std::string**, int*, int> MeanShift<V>::findUnassign
 				monoHist);
 		monoHistListU[i] = monoHist;
 
-		infoListU[i] = new string(*infoList[j]);
+		idListU[i] = idList[j];
 
 		lenListU[i] = lenList[j];
 	}
 
-	return std::make_tuple(kHistListU, monoHistListU, infoListU, lenListU,
+	return std::make_tuple(kHistListU, monoHistListU, idListU, lenListU,
 			unassignedCount);
 }
 
@@ -31,8 +31,8 @@
 #include "../Parameters.h"
 #include "../IdentityCalculator.h"
 #include "../Matrix.h"
+#include "../FastaReader.h"
 
-typedef std::vector<std::pair<std::string*, std::string*> > Block;
 
 template<class V>
 class MeanShift {
@@ -47,7 +47,7 @@ private:
 	int size;
 	V **kHistList;
 	uint64_t **monoHistList;
-	std::string **infoList;
+	uint32_t *idList;
 	int *lenList;
 
 	int *assignList = nullptr;
@@ -72,7 +72,7 @@ private:
 public:
 	MeanShift(Block*, IdentityCalculator<V>&, int, double threshold);
 
-	MeanShift(std::tuple<V**, uint64_t**, std::string**, int*, int>,
+	MeanShift(std::tuple<V**, uint64_t**, uint32_t*, int*, int>,
 			IdentityCalculator<V>&, int, double threshold);
 
 	virtual ~MeanShift();
@@ -83,7 +83,7 @@ public:
 	void removeEmpty();
 	void updateReferenceData(Block*);
 	void addClusters(const vector<Cluster<V>*> *oldClusterList);
-	std::tuple<V**, uint64_t**, std::string**, int*, int> findUnassignedData();
+	std::tuple<V**, uint64_t**, uint32_t*, int*, int> findUnassignedData();
 	void shift();
 	//void merge();
 	void mergeGreedy();
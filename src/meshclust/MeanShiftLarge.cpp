@@ -41,6 +41,7 @@ template<class V>
 void MeanShiftLarge<V>::clusterReservoir() {
 	std::cout << std::endl << "Clustering ... " << std::endl;
 	FastaReader reader(dbFile, blockSize);
+	reader.setThreadNum(threadNum);
 	auto block = reader.read();
 	seqNum += block->size();
 
@@ -205,6 +206,7 @@ void MeanShiftLarge<V>::assign() {
 
 	// Work on the original file
 	FastaReader reader(dbFile, vBlockSize);
+	reader.setThreadNum(threadNum);
 
 	auto clusterList = ms->getClusterList();
 	int clusterNum = clusterList->size();
@@ -221,16 +223,23 @@ void MeanShiftLarge<V>::assign() {
 	// Holds singles
 	vector<ClusterInfo*> singleList;
 
+	// Each header is stored once; clusters keep sequence ids only
+	HeaderArena headers;
+
 	int dataSize = 0;
 	while (reader.isStillReading()) {
 		Block *block = reader.read();
 		int blockSize = block->size();
 		dataSize += blockSize;
+		for (auto &record : *block) {
+			headers.add(record.id, *record.first);
+		}
+
 		double *res[clusterNum];
 		auto tup = identity.unpackBlock(block, threadNum);
 		auto kHistList = std::get < 0 > (tup);
 		auto monoHistList = std::get < 1 > (tup);
-		auto infoList = std::get < 2 > (tup);
+		auto idList = std::get < 2 > (tup);
 		auto lenList = std::get < 3 > (tup);
 
 		for (int i = 0; i < clusterNum; i++) {
@@ -291,13 +300,13 @@ void MeanShiftLarge<V>::assign() {
 		for (int i = 0; i < blockSize; i++) {
 			int index = assignment[i].index;
 			if (index >= 0) {
-				clusterInfoList[index]->addMember(infoList[i],
+				clusterInfoList[index]->addMember(idList[i],
 						assignment[i].scoreWithCenter,
 						assignment[i].scoreWithNeighbor,
 						assignment[i].membership);
 			} else {
 				auto clusterInfo = new ClusterInfo(++identifier);
-				clusterInfo->addMember(infoList[i],
+				clusterInfo->addMember(idList[i],
 						assignment[i].scoreWithCenter,
 						assignment[i].scoreWithNeighbor,
 						assignment[i].membership);
@@ -315,13 +324,11 @@ void MeanShiftLarge<V>::assign() {
 		for (int i = 0; i < blockSize; i++) {
 			delete[] kHistList[i];
 			delete[] monoHistList[i];
-			// Do not delete the info (header) because it is still is use.
-			// It will be deleted in ClusterInfo
 		}
 
 		delete[] kHistList;
 		delete[] monoHistList;
-		delete[] infoList;
+		delete[] idList;
 		delete[] lenList;
 
 		if ((assignCounter * Parameters::getMsPrintBlock()) <= dataSize) {
@@ -356,12 +363,12 @@ void MeanShiftLarge<V>::assign() {
 	// Write out results
 	ofstream out(outFile);
 	for (int i = 0; i < newSize; i++) {
-		out << clusterInfoList[i]->toString() << endl;
+		out << clusterInfoList[i]->toString(headers) << endl;
 	}
 
 	int singleCount = singleList.size();
 	for (int j = 0; j < singleCount; j++) {
-		out << singleList.at(j)->toString() << endl;
+		out << singleList.at(j)->toString(headers) << endl;
 		delete singleList.at(j);
 	}
 	out.close();
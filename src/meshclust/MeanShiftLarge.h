@@ -33,6 +33,7 @@
 #include "ClusteringUtil.h"
 #include "../Matrix.h"
 #include "../FastaReader.h"
+#include "../HeaderArena.h"
 #include "../IdentityCalculator.h"
 
 template<class V>
@@ -27,7 +27,7 @@ Reservoir<V>::Reservoir() {
 
 template<class V>
 Reservoir<V>::~Reservoir() {
-	if (!kHistList.empty() || !monoHistList.empty() || !infoList.empty()
+	if (!kHistList.empty() || !monoHistList.empty() || !idList.empty()
 			|| !lenList.empty()) {
 		cerr << "Warning: The reservoir is destroyed, but it is not empty!";
 		cerr << endl;
@@ -36,17 +36,17 @@ Reservoir<V>::~Reservoir() {
 
 template<class V>
 void Reservoir<V>::add(
-		std::tuple<V**, uint64_t**, std::string**, int*, int> t) {
+		std::tuple<V**, uint64_t**, uint32_t*, int*, int> t) {
 	V **l1 = get < 0 > (t);
 	uint64_t **l2 = get < 1 > (t);
-	std::string **l3 = get < 2 > (t);
+	uint32_t *l3 = get < 2 > (t);
 	int *l4 = get < 3 > (t);
 	int blockSize = get < 4 > (t);
 
 	for (int i = 0; i < blockSize; i++) {
 		kHistList.push_back(l1[i]);
 		monoHistList.push_back(l2[i]);
-		infoList.push_back(l3[i]);
+		idList.push_back(l3[i]);
 		lenList.push_back(l4[i]);
 	}
 
@@ -57,7 +57,7 @@ void Reservoir<V>::add(
 }
 
 template<class V>
-std::tuple<V**, uint64_t**, std::string**, int*, int> Reservoir<V>::remove(
+std::tuple<V**, uint64_t**, uint32_t*, int*, int> Reservoir<V>::remove(
 		int blockSize) {
 
 	shuffle();
@@ -67,19 +67,19 @@ std::tuple<V**, uint64_t**, std::string**, int*, int> Reservoir<V>::remove(
 	}
 	V **l1 = new V*[blockSize];
 	uint64_t **l2 = new uint64_t*[blockSize];
-	std::string **l3 = new std::string*[blockSize];
+	uint32_t *l3 = new uint32_t[blockSize];
 	int *l4 = new int[blockSize];
 
 	for (int i = 0; i < blockSize; i++) {
 		l1[i] = kHistList[i];
 		l2[i] = monoHistList[i];
-		l3[i] = infoList[i];
+		l3[i] = idList[i];
 		l4[i] = lenList[i];
 	}
 
 	kHistList.erase(kHistList.begin(), kHistList.begin() + blockSize);
 	monoHistList.erase(monoHistList.begin(), monoHistList.begin() + blockSize);
-	infoList.erase(infoList.begin(), infoList.begin() + blockSize);
+	idList.erase(idList.begin(), idList.begin() + blockSize);
 	lenList.erase(lenList.begin(), lenList.begin() + blockSize);
 
 	return std::make_tuple(l1, l2, l3, l4, blockSize);
@@ -103,25 +103,25 @@ void Reservoir<V>::shuffle() {
 	// Make new vectors
 	std::vector<V*> kHistListShuffled(s, 0);
 	std::vector<uint64_t*> monoHistListShuffled(s, 0);
-	std::vector<std::string*> infoListShuffled(s, nullptr);
+	std::vector<uint32_t> idListShuffled(s, 0);
 	std::vector<int> lenListShuffled(s, 0);
 
 	// Copy items according to the shuffled indexes
 	for (int i = 0; i < s; i++) {
 		kHistListShuffled[i] = kHistList[indexList[i]];
 		monoHistListShuffled[i] = monoHistList[indexList[i]];
-		infoListShuffled[i] = infoList[indexList[i]];
+		idListShuffled[i] = idList[indexList[i]];
 		lenListShuffled[i] = lenList[indexList[i]];
 	}
 
 	// Copy the shuffled vectors to the old ones
 	kHistList.clear();
 	monoHistList.clear();
-	infoList.clear();
+	idList.clear();
 	lenList.clear();
 	kHistList = kHistListShuffled;
 	monoHistList = monoHistListShuffled;
-	infoList = infoListShuffled;
+	idList = idListShuffled;
 	lenList = lenListShuffled;
 }
 
@@ -32,15 +32,15 @@ class Reservoir {
 private:
 	std::vector<V*> kHistList;
 	std::vector<uint64_t*> monoHistList;
-	std::vector<std::string*> infoList;
+	std::vector<uint32_t> idList;
 	std::vector<int> lenList;
 	int seed;
 
 public:
 	Reservoir();
 	virtual ~Reservoir();
-	void add(std::tuple<V**, uint64_t**, std::string**, int*, int>);
-	std::tuple<V**, uint64_t**, std::string**, int*, int> remove(int);
+	void add(std::tuple<V**, uint64_t**, uint32_t*, int*, int>);
+	std::tuple<V**, uint64_t**, uint32_t*, int*, int> remove(int);
 	int size();
 	void shuffle();
 };